@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Admision.h"
+#include "Bitacora.h"
+#include "Reloj.h"
+#include "Franjas.h"
+
+void admision_iniciar(Admision* a, Parques* parques, TablaClientes* clientes, Traza* traza){
+    a->parques = parques;
+    a->clientes = clientes;
+    a->traza = traza;
+    atomic_init(&a->sin_parque, 0);
+}
+
+// Hora simulada en horas, como la da reloj_horas
+static float horas(int64_t ms){
+    return (float)((double)ms / MS_POR_HORA);
+}
+
+int admision_valida(int hora, int personas, float momento, Parque* parque){
+    return !(hora > parque->cierre || personas <= 0 || personas > parque->agenda.capacidad || momento >= parque->cierre);
+}
+
+// Resultado según la hora pedida y el inicio asignado (en minutos, -1 sin cupo)
+static Resultado clasificar_resultado(int hora, float momento, int asignado){
+    // Caso hora pasada (extemporánea)
+    if(hora < momento){
+        return (asignado > hora * 60) ? RES_REPROGRAMADO_EXTEMPORANEO : RES_DENEGADO_EXTEMPORANEO;
+    }
+    // Horario válido
+    if(asignado == hora * 60) return RES_CONFIRMADO;
+    if(asignado > hora * 60) return RES_REPROGRAMADO;
+    return RES_DENEGADO_CAPACIDAD;
+}
+
+// Contador del resultado: [confirmadas, reprogramadas, denegadas]
+static int tipo_resultado(Resultado resultado){
+    return (resultado == RES_CONFIRMADO) ? 0 :
+           (resultado == RES_REPROGRAMADO || resultado == RES_REPROGRAMADO_EXTEMPORANEO) ? 1 : 2;
+}
+
+int admision_registro(Admision* a, const CabeceraMarco* cab, const char* nombre, int64_t ms, int descriptor){
+    if(a->traza != NULL) traza_anotar(a->traza, ms, *cab, nombre, cab->largo_nombre);
+    return clientes_registrar(a->clientes, cab->agente, descriptor);
+}
+
+int admision_solicitud(Admision* a, const CabeceraMarco* cab, const char* nombre, int64_t ms,
+                       CabeceraMarco* respuesta){
+    Parque* parque = parques_buscar(a->parques, cab->parque);   // NULL: no existe, se deniega
+    int hora = cab->hora;
+    int personas = cab->personas;
+    Resultado resultado = RES_DENEGADO_RANGO;
+    int asignado = -1;                  // Inicio asignado, en minutos desde las 0:00
+
+    if(a->traza != NULL) traza_anotar(a->traza, ms, *cab, nombre, cab->largo_nombre);
+
+    // Anotar la petición recibida (la escribe el hilo de la bitácora)
+    bitacora_anotar(EV_PETICION, cab->agente, personas, hora, 0, 0, nombre, cab->largo_nombre);
+
+    // Una sola hora para toda la decisión
+    float momento = horas(ms);
+    if(parque != NULL && admision_valida(hora, personas, momento, parque)){
+        // Intentar asignar espacio (la agenda toma su propio cerrojo)
+        asignado = agenda_asignar(&parque->agenda, hora, momento, personas, nombre, cab->largo_nombre);
+        resultado = clasificar_resultado(hora, momento, asignado);
+    }
+
+    // Contadores sin cerrojo: [confirmadas, reprogramadas, denegadas]
+    int tipo = tipo_resultado(resultado);
+    if(parque == NULL){
+        atomic_fetch_add_explicit(&a->sin_parque, 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(&parque->estadisticas[tipo], 1, memory_order_relaxed);
+        if(tipo == 2 && parque->con_diario){                    // Las admitidas las anota la agenda
+            diario_anotar_denegadas(&parque->diario, 1);
+        }
+    }
+    bitacora_anotar(EV_RESPUESTA, cab->agente, resultado, asignado >= 0 ? asignado / 60 : 0,
+                    asignado >= 0 ? asignado % 60 : 0, 0, nombre, cab->largo_nombre);
+
+    *respuesta = (CabeceraMarco){ .tipo = MSG_RESPUESTA, .resultado = resultado, .agente = cab->agente,
+                                  .hora = asignado >= 0 ? asignado / 60 : 0,
+                                  .minuto = asignado >= 0 ? asignado % 60 : 0, .personas = personas,
+                                  .secuencia = cab->secuencia };
+
+    // Contador del agente y su descriptor en una sola búsqueda
+    return clientes_anotar(a->clientes, cab->agente, tipo);
+}
+
+int admision_lote(Admision* a, const CabeceraMarco* cab, const char* carga, int64_t ms,
+                  CabeceraMarco* respuesta, ResultadoLote resultados[]){
+    Parque* parque = parques_buscar(a->parques, cab->parque);
+    SolicitudLote solicitudes[MAX_LOTE];
+    const char* nombres[MAX_LOTE];
+    int cantidad = 0, posicion = 0, estado;
+
+    while(cantidad < MAX_LOTE &&
+          (estado = lote_siguiente(carga, cab->largo_nombre, &posicion, &solicitudes[cantidad], &nombres[cantidad])) == 1){
+        cantidad++;
+    }
+    if(a->traza != NULL) traza_anotar(a->traza, ms, *cab, carga, cab->largo_nombre);
+
+    // Un lote mal armado se deniega entero: las secuencias van seguidas desde
+    // la de la cabecera, así el agente libera las que anunció y no las espera
+    int valido = estado != -1 && cantidad == cab->personas;
+    if(!valido){
+        fprintf(stderr, "Lote inválido del cliente %u, denegado\n", cab->agente);
+        cantidad = cab->personas < 0 ? 0 : cab->personas > MAX_LOTE ? MAX_LOTE : cab->personas;
+    }
+
+    // Una sola hora para todo el lote
+    float momento = horas(ms);
+
+    // Solo las válidas pasan por la agenda
+    PedidoAgenda pedidos[MAX_LOTE];
+    int validos = 0;
+    for(int k=0; valido && parque != NULL && k<cantidad; k++){
+        if(admision_valida(solicitudes[k].hora, solicitudes[k].personas, momento, parque)){
+            pedidos[validos++] = (PedidoAgenda){ solicitudes[k].hora, solicitudes[k].personas,
+                                                 nombres[k], solicitudes[k].largo_nombre, -1 };
+        }
+    }
+    if(validos > 0) agenda_asignar_lote(&parque->agenda, pedidos, validos, momento);
+
+    int sumas[3] = {0, 0, 0};
+    for(int k=0, v=0; k<cantidad; k++){
+        Resultado resultado = RES_DENEGADO_RANGO;
+        int asignado = -1;
+        if(valido && parque != NULL &&
+           admision_valida(solicitudes[k].hora, solicitudes[k].personas, momento, parque)){
+            asignado = pedidos[v++].asignado;
+            resultado = clasificar_resultado(solicitudes[k].hora, momento, asignado);
+        }
+        sumas[tipo_resultado(resultado)]++;
+        bitacora_anotar(EV_RESPUESTA, cab->agente, resultado, asignado >= 0 ? asignado / 60 : 0,
+                        asignado >= 0 ? asignado % 60 : 0, 0, valido ? nombres[k] : NULL,
+                        valido ? solicitudes[k].largo_nombre : 0);
+        resultados[k] = (ResultadoLote){ .secuencia = valido ? solicitudes[k].secuencia : cab->secuencia + k,
+                                         .resultado = resultado,
+                                         .hora = asignado >= 0 ? asignado / 60 : 0,
+                                         .minuto = asignado >= 0 ? asignado % 60 : 0 };
+    }
+
+    bitacora_anotar(EV_LOTE, cab->agente, cantidad, sumas[0], sumas[1], sumas[2], NULL, 0);
+
+    if(parque == NULL){
+        atomic_fetch_add_explicit(&a->sin_parque, sumas[2], memory_order_relaxed);
+    } else {
+        for(int tipo=0; tipo<3; tipo++){
+            if(sumas[tipo] > 0) atomic_fetch_add_explicit(&parque->estadisticas[tipo], sumas[tipo], memory_order_relaxed);
+        }
+        if(sumas[2] > 0 && parque->con_diario){                 // Todas las denegadas en un registro
+            diario_anotar_denegadas(&parque->diario, sumas[2]);
+        }
+    }
+
+    // Una sola respuesta para todo el lote
+    *respuesta = (CabeceraMarco){ .tipo = MSG_RESPUESTA_LOTE, .agente = cab->agente, .personas = cantidad,
+                                  .secuencia = cab->secuencia };
+    return clientes_sumar(a->clientes, cab->agente, sumas);
+}
+
+int admision_cierre(Admision* a, uint32_t agente, int64_t ms, Cliente* cliente){
+    if(!clientes_eliminar(a->clientes, agente, cliente)) return 0;
+    if(a->traza != NULL){
+        CabeceraMarco cierre = { .tipo = MSG_CIERRE, .agente = agente };
+        traza_anotar(a->traza, ms, cierre, NULL, 0);
+    }
+    bitacora_anotar(EV_CIERRE, agente, cliente->solicitudes[0], cliente->solicitudes[1], cliente->solicitudes[2], 0,
+                    NULL, 0);
+    return 1;
+}
+
+static int mcd(int a, int b){
+    while(b != 0){
+        int resto = a % b;
+        a = b;
+        b = resto;
+    }
+    return a;
+}
+
+int admision_paso(const Parques* parques){
+    int paso = 0;
+    for(int i=0; i<parques->cantidad; i++) paso = mcd(parques->lista[i].agenda.minutos, paso);
+    return paso;
+}
+
+// Anota entradas y salidas al llegar a la franja de la instantánea.
+// Trabaja sobre la copia, así que no bloquea las reservas mientras imprime.
+// Las cifras son los deltas de la franja, guardados al reservar.
+static void informar_franja(Instantanea* inst, int total_horas){
+    int posicion = inst->posicion;
+
+    if(posicion != total_horas){
+        bitacora_anotar(EV_INGRESOS, 0, inst->ingresos, 0, 0, 0, NULL, 0);
+    }
+    if(posicion != 0){
+        bitacora_anotar(EV_SALIDAS, 0, inst->egresos, 0, 0, 0, NULL, 0);
+    }
+
+    // Mostrar grupos que entran/salen (listas por franja, sin cruzar nombres)
+    if(posicion != total_horas){
+        bitacora_anotar(EV_GRUPOS_INGRESAN, 0, 0, 0, 0, 0, NULL, 0);
+        for(int i=0; i<inst->num_ingresan; i++){
+            bitacora_anotar(EV_GRUPO_INGRESA, 0, 0, 0, 0, 0, inst->ingresan[i], strlen(inst->ingresan[i]));
+        }
+    }
+    if(posicion != 0){
+        bitacora_anotar(EV_GRUPOS_SALEN, 0, 0, 0, 0, 0, NULL, 0);
+        for(int i=0; i<inst->num_salen; i++){
+            bitacora_anotar(EV_GRUPO_SALE, 0, 0, 0, 0, 0, inst->salen[i], strlen(inst->salen[i]));
+        }
+    }
+    bitacora_anotar(EV_FIN_FRANJA, 0, 0, 0, 0, 0, NULL, 0);
+}
+
+void admision_tic(Admision* a, int minuto){
+    Parques* parques = a->parques;
+    if(a->traza != NULL) traza_tic(a->traza, minuto * 60000LL);
+    bitacora_anotar(EV_TIEMPO, 0, minuto / 60, minuto % 60, 0, 0, NULL, 0);
+
+    // Cálculo de entradas y salidas por franja (lógica de ocupación de cada parque)
+    for(int i=0; i<parques->cantidad; i++){
+        Agenda* agenda = &parques->lista[i].agenda;
+        int desde_apertura = minuto - agenda->apertura * 60;
+        int posicion = desde_apertura / agenda->minutos;
+        if(desde_apertura < 0 || desde_apertura % agenda->minutos != 0 || posicion > agenda->franjas) continue;
+
+        Instantanea inst;
+        if(agenda_instantanea(agenda, posicion, &inst) == 0){
+            if(parques->cantidad > 1) bitacora_anotar(EV_PARQUE, 0, parques->lista[i].id, 0, 0, 0, NULL, 0);
+            informar_franja(&inst, agenda->franjas);
+            instantanea_liberar(&inst);
+        }
+    }
+}
+
+void admision_totales(Admision* a, int totales[3]){
+    totales[0] = totales[1] = 0;
+    totales[2] = atomic_load(&a->sin_parque);
+    for(int i=0; i<a->parques->cantidad; i++){
+        for(int t=0; t<3; t++) totales[t] += atomic_load(&a->parques->lista[i].estadisticas[t]);
+    }
+}
+
+// Lista las franjas cuya ocupación es 'valor'
+static void listar_franjas(Agenda* agenda, const int ocupacion[], int valor){
+    for(int i=franjas_siguiente(ocupacion, agenda->franjas, 0, valor); i != -1;
+        i=franjas_siguiente(ocupacion, agenda->franjas, i + 1, valor)){
+        int minuto = agenda_minuto(agenda, i);
+        printf("   └─ Franja horaria %d:%02d → %d visitantes\n", minuto / 60, minuto % 60, valor);
+    }
+}
+
+// Franjas de mayor y menor ocupación de un parque, y cómo se reparte
+// la ocupación del día
+static void informar_ocupacion(Agenda* agenda){
+    // Copia de la ocupación para el informe (en el heap: con franjas de un
+    // minuto pueden ser muchas)
+    int horas = agenda->franjas;
+    int* ocupacion = malloc(horas * sizeof(int));
+    if(ocupacion == NULL){
+        printf("📊 Sin memoria para el informe de ocupación\n");
+        return;
+    }
+    for(int i=0; i<horas; i++){
+        ocupacion[i] = atomic_load_explicit(&agenda->ocupacion[i], memory_order_relaxed);
+    }
+
+    // Mínimo y máximo en una sola pasada vectorial
+    int minimo, maximo;
+    franjas_extremos(ocupacion, horas, &minimo, &maximo);
+
+    printf("📊 PERIODOS DE MAXIMA OCUPACION:\n");
+    listar_franjas(agenda, ocupacion, maximo);
+    printf("\n📉 PERIODOS DE MINIMA OCUPACION:\n");
+    listar_franjas(agenda, ocupacion, minimo);
+
+    // Franjas por cuarto de la capacidad
+    int cuenta[4];
+    long suma = franjas_histograma(ocupacion, horas, agenda->capacidad, 4, cuenta);
+    printf("\n📶 DISTRIBUCION DE LA OCUPACION (media %.1f visitantes, %.1f %% de la capacidad):\n",
+           (double)suma / horas, 100.0 * suma / horas / agenda->capacidad);
+    for(int c=0; c<4; c++){
+        printf("   └─ %3d-%3d %%: %d franjas\n", 25 * c, 25 * (c + 1), cuenta[c]);
+    }
+    free(ocupacion);
+}
+
+static void informar_solicitudes(const char* titulo, int confirmadas, int reprogramadas, int denegadas){
+    printf("\n📋 %s:\n", titulo);
+    printf("   ✓ Aprobadas en horario solicitado: %d\n", confirmadas);
+    printf("   ↻ Reprogramadas a otro horario: %d\n", reprogramadas);
+    printf("   ✗ Rechazadas definitivamente: %d\n", denegadas);
+}
+
+void admision_informe(Admision* a){
+    Parques* parques = a->parques;
+
+    printf("\n╔════════════════════════════════════════╗\n");
+    printf("║     INFORME FINAL DE OPERACIONES      ║\n");
+    printf("╚════════════════════════════════════════╝\n\n");
+
+    for(int i=0; i<parques->cantidad; i++){
+        Parque* parque = &parques->lista[i];
+        if(parques->cantidad > 1){
+            printf("%s🏞  PARQUE %d (%d:00 a %d:00, capacidad %d, franjas de %d min)\n\n", i > 0 ? "\n" : "",
+                   parque->id, parque->apertura, parque->cierre, parque->agenda.capacidad, parque->agenda.minutos);
+        }
+        informar_ocupacion(&parque->agenda);
+        if(parques->cantidad > 1){
+            informar_solicitudes("SOLICITUDES DEL PARQUE", atomic_load(&parque->estadisticas[0]),
+                                 atomic_load(&parque->estadisticas[1]), atomic_load(&parque->estadisticas[2]));
+            printf("\n────────────────────────────────────────\n");
+        }
+    }
+
+    // Resumen de estadísticas de solicitudes
+    int totales[3];
+    admision_totales(a, totales);
+    informar_solicitudes(parques->cantidad > 1 ? "RESUMEN DE SOLICITUDES DE TODOS LOS PARQUES" :
+                         "RESUMEN DE SOLICITUDES PROCESADAS", totales[0], totales[1], totales[2]);
+    int sin_parque = atomic_load(&a->sin_parque);
+    if(sin_parque > 0) printf("     (%d de ellas a parques que no existen)\n", sin_parque);
+    printf("\n════════════════════════════════════════\n");
+}
@@ -0,0 +1,67 @@
+#ifndef ADMISION_H
+#define ADMISION_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "Protocolo.h"
+#include "Parques.h"
+#include "Clientes.h"
+#include "Traza.h"
+
+// Núcleo de admisión del controlador, sin tubos, hilos ni reloj real.
+// Decide solicitudes y lotes contra la agenda de cada parque, lleva los
+// contadores (del parque, del agente y el diario), anota la bitácora e
+// informa las franjas y el cierre del día. Cada decisión recibe la hora
+// simulada en ms, así que con la misma secuencia de marcos y horas da
+// siempre lo mismo. Lo usan el controlador en línea (que además lee los
+// tubos y envía las respuestas) y ./repeticion, que corre una traza tan
+// rápido como da el procesador.
+// Si 'traza' no es NULL, cada marco decidido se graba ahí con su hora.
+
+typedef struct {
+    Parques* parques;             // Agenda, horario y contadores de cada parque
+    TablaClientes* clientes;      // Agentes registrados (ID -> descriptor y contadores)
+    Traza* traza;                 // Grabación (NULL: sin grabar)
+    _Atomic int sin_parque;       // Denegadas por pedir a un parque que no existe
+} Admision;
+
+void admision_iniciar(Admision* a, Parques* parques, TablaClientes* clientes, Traza* traza);
+
+// Validaciones previas a buscar cupo: 1 si la solicitud puede asignarse
+int admision_valida(int hora, int personas, float momento, Parque* parque);
+
+// Registra al agente de 'cab' con su descriptor de respuestas. Devuelve lo
+// mismo que clientes_registrar (el descriptor anterior, -1 o -2).
+int admision_registro(Admision* a, const CabeceraMarco* cab, const char* nombre, int64_t ms, int descriptor);
+
+// Decide una solicitud (MSG_SOLICITUD) en 'ms' y arma la respuesta.
+// Devuelve el descriptor del agente, o -1 si no está registrado.
+int admision_solicitud(Admision* a, const CabeceraMarco* cab, const char* nombre, int64_t ms,
+                       CabeceraMarco* respuesta);
+
+// Decide un lote (MSG_LOTE) en 'ms': todas sus solicitudes en orden bajo un
+// solo cerrojo de la agenda. Arma la respuesta y un resultado por solicitud.
+// Un lote inválido (o de un parque desconocido) también se responde, todo
+// denegado. Devuelve el descriptor del agente, o -1 si no está registrado.
+int admision_lote(Admision* a, const CabeceraMarco* cab, const char* carga, int64_t ms,
+                  CabeceraMarco* respuesta, ResultadoLote resultados[]);
+
+// Quita al agente (cuando ya no queda nada suyo por decidir). Devuelve 1 y
+// copia sus datos en 'cliente' si estaba registrado.
+int admision_cierre(Admision* a, uint32_t agente, int64_t ms, Cliente* cliente);
+
+// Minutos entre bordes del reloj: el divisor común de las franjas de todos los parques
+int admision_paso(const Parques* parques);
+
+// Informa el borde del reloj en 'minuto': la hora y, de cada parque al que
+// le empieza una franja, quién entra y quién sale
+void admision_tic(Admision* a, int minuto);
+
+// Contadores de todos los parques: [confirmadas, reprogramadas, denegadas]
+// (las solicitudes a parques inexistentes cuentan como denegadas)
+void admision_totales(Admision* a, int totales[3]);
+
+// Informe final por stdout: ocupación y solicitudes de cada parque y el total
+void admision_informe(Admision* a);
+
+#endif
@@ -0,0 +1,377 @@
+#include <stdlib.h>
+#include <string.h>
+#include "Agenda.h"
+#include "Metricas.h"
+#include "Diario.h"
+
+#define TAM_BLOQUE_ARENA (256 * 1024)
+
+// Bytes de 'n' enteros redondeados a líneas enteras
+static size_t en_lineas(int n){
+    return ((size_t)n * sizeof(int) + LINEA_CACHE - 1) / LINEA_CACHE * LINEA_CACHE;
+}
+
+int agenda_crear(Agenda* ag, int apertura, int minutos, int franjas, int capacidad, int visita){
+    memset(ag, 0, sizeof(*ag));
+    ag->apertura = apertura;
+    ag->minutos = minutos;
+    ag->franjas = franjas;
+    ag->capacidad = capacidad;
+    ag->visita = visita;
+    ag->via_rapida = 1;
+
+    // Arreglos por franja: ocupación | ingresos | egresos | libre del índice
+    size_t tam = en_lineas(franjas), tam_egresos = en_lineas(franjas + 1);
+    char* tabla = aligned_alloc(LINEA_CACHE, 3 * tam + tam_egresos);
+    if(tabla == NULL) return -1;
+    memset(tabla, 0, 3 * tam + tam_egresos);
+    ag->tabla = tabla;
+    ag->ocupacion = (_Atomic int*)tabla;
+    ag->ingresos = (int*)(tabla + tam);
+    ag->egresos = (int*)(tabla + 2 * tam);
+    if(indice_crear_en(&ag->indice, franjas, visita, capacidad, (int*)(tabla + 2 * tam + tam_egresos)) == -1){
+        free(tabla);
+        return -1;
+    }
+    arena_crear(&ag->arena, TAM_BLOQUE_ARENA);
+
+    // La memoria crece con las reservas, no con la capacidad del parque
+    ag->ingresan = calloc(franjas, sizeof(VectorIndices));
+    ag->salen = calloc(franjas + 1, sizeof(VectorIndices));
+    if(ag->ingresan == NULL || ag->salen == NULL || nombres_crear(&ag->nombres, &ag->arena) == -1){
+        agenda_destruir(ag);
+        return -1;
+    }
+
+    pthread_mutex_init(&ag->bloqueo, NULL);
+    return 0;
+}
+
+void agenda_destruir(Agenda* ag){
+    for(Pendiente* p = atomic_exchange(&ag->pendientes, NULL); p != NULL; ){
+        Pendiente* siguiente = p->siguiente;
+        free(p);
+        p = siguiente;
+    }
+    for(int i=0; ag->ingresan != NULL && i<ag->franjas; i++) free(ag->ingresan[i].datos);
+    for(int i=0; ag->salen != NULL && i<=ag->franjas; i++) free(ag->salen[i].datos);
+    free(ag->ingresan);
+    free(ag->salen);
+    free(ag->bloques);
+    nombres_destruir(&ag->nombres);
+    arena_destruir(&ag->arena);
+    indice_destruir(&ag->indice);
+    free(ag->tabla);
+    ag->tabla = NULL;
+    ag->ingresan = NULL;
+    ag->salen = NULL;
+    ag->bloques = NULL;
+    ag->ingresos = NULL;
+    ag->egresos = NULL;
+    ag->ocupacion = NULL;
+}
+
+// Deja lugar para un índice más. 0 si ok, -1 sin memoria.
+static int vector_asegurar(VectorIndices* v){
+    if(v->cantidad < v->capacidad) return 0;
+    int capacidad = v->capacidad ? v->capacidad * 2 : 4;
+    int* datos = realloc(v->datos, capacidad * sizeof(int));
+    if(datos == NULL) return -1;
+    v->datos = datos;
+    v->capacidad = capacidad;
+    return 0;
+}
+
+// Deja lugar para un registro más (un bloque nuevo cada RESERVAS_POR_BLOQUE)
+static int reserva_asegurar(Agenda* ag){
+    if(ag->num_reservas % RESERVAS_POR_BLOQUE != 0) return 0;
+
+    int bloque = ag->num_reservas / RESERVAS_POR_BLOQUE;
+    if((bloque & (bloque - 1)) == 0){           // Potencia de 2: duplicar la tabla de bloques
+        Reserva** bloques = realloc(ag->bloques, (bloque ? bloque * 2 : 1) * sizeof(Reserva*));
+        if(bloques == NULL) return -1;
+        ag->bloques = bloques;
+    }
+    ag->bloques[bloque] = arena_reservar(&ag->arena, RESERVAS_POR_BLOQUE * sizeof(Reserva));
+    return ag->bloques[bloque] == NULL ? -1 : 0;
+}
+
+int agenda_franja(const Agenda* ag, float momento){
+    float franja = (momento - ag->apertura) * 60 / ag->minutos;
+    int entera = (int)franja;
+    return (entera > franja) ? entera - 1 : entera;     // Redondeo hacia abajo
+}
+
+// Devuelve 'cantidad' personas a las franjas [desde, hasta)
+static void desocupar(Agenda* ag, int desde, int hasta, int cantidad){
+    for(int j=desde; j<hasta; j++) atomic_fetch_sub_explicit(&ag->ocupacion[j], cantidad, memory_order_relaxed);
+}
+
+// Suma 'cantidad' a la ocupación de la ventana que empieza en 'i', franja
+// por franja con CAS; si alguna no tiene lugar deshace lo sumado.
+// 0 si entró, -1 si no.
+static int ocupar(Agenda* ag, int i, int cantidad){
+    int fin = i + ag->visita;
+    for(int j=i; j<fin; j++){
+        int actual = atomic_load_explicit(&ag->ocupacion[j], memory_order_relaxed);
+        do {
+            if(actual + cantidad > ag->capacidad){
+                desocupar(ag, i, j, cantidad);
+                return -1;
+            }
+        } while(!atomic_compare_exchange_weak_explicit(&ag->ocupacion[j], &actual, actual + cantidad,
+                                                       memory_order_relaxed, memory_order_relaxed));
+    }
+    return 0;
+}
+
+// Agrega el registro de la reserva en la franja 'i' y sus deltas (con el
+// cerrojo tomado; el cupo y el índice van aparte). 0 si ok, -1 sin memoria.
+static int anotar_bloqueado(Agenda* ag, int i, int cantidad, int nombre){
+    // Reservar toda la memoria antes de tocar nada
+    int fin = i + ag->visita;
+    if(reserva_asegurar(ag) == -1 || vector_asegurar(&ag->ingresan[i]) == -1 || vector_asegurar(&ag->salen[fin]) == -1){
+        return -1;
+    }
+
+    int indice = ag->num_reservas++;
+    *agenda_reserva(ag, indice) = (Reserva){ nombre, i, cantidad };
+    ag->ingresan[i].datos[ag->ingresan[i].cantidad++] = indice;
+    ag->salen[fin].datos[ag->salen[fin].cantidad++] = indice;
+
+    ag->ingresos[i] += cantidad;            // Deltas de la franja de entrada y de salida
+    ag->egresos[fin] += cantidad;
+    return 0;
+}
+
+// Pasa las reservas de la vía rápida a registros, índice y diario, en
+// orden de llegada (con el cerrojo tomado). Su cupo ya está en 'ocupacion';
+// el índice se descuenta en tandas, recalculando una vez por tanda.
+// Devuelve cuántas pasó.
+static int aplicar_bloqueado(Agenda* ag){
+    if(atomic_load_explicit(&ag->pendientes, memory_order_relaxed) == NULL) return 0;
+    Pendiente* pila = atomic_exchange_explicit(&ag->pendientes, NULL, memory_order_acquire);
+
+    // La pila tiene la última arriba: darla vuelta
+    Pendiente* lista = NULL;
+    while(pila != NULL){
+        Pendiente* siguiente = pila->siguiente;
+        pila->siguiente = lista;
+        lista = pila;
+        pila = siguiente;
+    }
+
+    int desde[PENDIENTES_MAXIMO], delta[PENDIENTES_MAXIMO];
+    int tanda = 0, total = 0;
+    while(lista != NULL){
+        Pendiente* p = lista;
+        lista = p->siguiente;
+
+        // Sin memoria para el registro el lugar sigue siendo del grupo:
+        // queda en el cupo, el índice y el diario
+        int nombre = nombres_internar(&ag->nombres, p->familia, p->largo, p->hash);
+        if(nombre != -1) anotar_bloqueado(ag, p->inicio, p->personas, nombre);
+        if(ag->diario != NULL){
+            diario_anotar_reserva(ag->diario, p->confirmada ? 0 : 1, p->inicio, p->personas, p->familia, p->largo, p->hash);
+        }
+
+        desde[tanda] = p->inicio;
+        delta[tanda] = -p->personas;
+        if(++tanda == PENDIENTES_MAXIMO){
+            indice_sumar_varios(&ag->indice, desde, delta, tanda);
+            tanda = 0;
+        }
+        free(p);
+        total++;
+    }
+    indice_sumar_varios(&ag->indice, desde, delta, tanda);
+    atomic_fetch_sub_explicit(&ag->num_pendientes, total, memory_order_relaxed);
+    return total;
+}
+
+// Busca y registra la ventana (con el cerrojo tomado). Devuelve la franja de ingreso o -1.
+// 'pedida' es la franja que cuenta como confirmada (-1 si la hora ya pasó).
+static int asignar_bloqueado(Agenda* ag, int posicion, int pedida, int cantidad, const char* familia,
+                             int largo_familia, uint32_t hash){
+    aplicar_bloqueado(ag);
+
+    // Buscar la primera ventana de 'visita' franjas con espacio. Si la vía
+    // rápida la llenó mientras tanto (el índice todavía no lo sabe), pasar
+    // sus reservas al índice y volver a buscar. Si no hay nada apilado, la
+    // vía rápida todavía no la apiló (o está deshaciendo una que no entró):
+    // con el cerrojo tomado no se la espera, esa ventana cuenta como llena.
+    int i, desde = posicion;
+    while((i = indice_buscar(&ag->indice, desde, cantidad)) != -1 && ocupar(ag, i, cantidad) == -1){
+        if(aplicar_bloqueado(ag) == 0) desde = i + 1;
+    }
+    if(i == -1) return -1;  // No hay cupo
+
+    int nombre = nombres_internar(&ag->nombres, familia, largo_familia, hash);
+    if(nombre == -1 || anotar_bloqueado(ag, i, cantidad, nombre) == -1){
+        desocupar(ag, i, i + ag->visita, cantidad);
+        return -1;
+    }
+    indice_sumar(&ag->indice, i, -cantidad);   // Descontar cupo de la ventana
+
+    // Al diario dentro del mismo cerrojo: una instantánea (que lo toma)
+    // nunca ve una reserva que el diario todavía no tiene
+    if(ag->diario != NULL){
+        diario_anotar_reserva(ag->diario, i == pedida ? 0 : 1, i, cantidad, familia, largo_familia, hash);
+    }
+    return i;
+}
+
+// Toma el cerrojo de reservas y anota cuánto hubo que esperarlo. Sin
+// competencia no se lee el reloj: la espera se anota como 0.
+static void tomar_cerrojo(Agenda* ag){
+    if(pthread_mutex_trylock(&ag->bloqueo) == 0){
+        metricas_anotar(ETAPA_CERROJO, 0);
+        return;
+    }
+    uint64_t antes = metricas_ahora();
+    pthread_mutex_lock(&ag->bloqueo);
+    metricas_anotar(ETAPA_CERROJO, metricas_ahora() - antes);
+}
+
+// Vía rápida (el cerrojo está ocupado): toma la ventana pedida sin
+// esperarlo y la apila para registrarla después. 0 si la tomó, -1 si hay
+// que esperar el cerrojo.
+static int asignar_rapido(Agenda* ag, int posicion, int pedida, int cantidad, const char* familia,
+                          int largo_familia, uint32_t hash){
+    if(posicion < 0 || posicion + ag->visita > ag->franjas || ocupar(ag, posicion, cantidad) == -1) return -1;
+
+    Pendiente* p = malloc(sizeof(Pendiente) + largo_familia);
+    if(p == NULL){
+        desocupar(ag, posicion, posicion + ag->visita, cantidad);
+        return -1;
+    }
+    p->inicio = posicion;
+    p->personas = cantidad;
+    p->confirmada = posicion == pedida;
+    p->hash = hash;
+    p->largo = largo_familia;
+    memcpy(p->familia, familia, largo_familia);
+
+    p->siguiente = atomic_load_explicit(&ag->pendientes, memory_order_relaxed);
+    while(!atomic_compare_exchange_weak_explicit(&ag->pendientes, &p->siguiente, p,
+                                                 memory_order_release, memory_order_relaxed));
+    metricas_sin_cerrojo();                     // No esperó: no es un 0 de espera_cerrojo
+
+    // Con muchas apiladas, las registra quien consiga el cerrojo sin esperar
+    if(atomic_fetch_add_explicit(&ag->num_pendientes, 1, memory_order_relaxed) + 1 >= PENDIENTES_MAXIMO &&
+       pthread_mutex_trylock(&ag->bloqueo) == 0){
+        aplicar_bloqueado(ag);
+        pthread_mutex_unlock(&ag->bloqueo);
+    }
+    return 0;
+}
+
+int agenda_asignar(Agenda* ag, int solicitada, float momento, int cantidad,
+                   const char* familia, int largo_familia){
+
+    int posicion = agenda_franja_desde(ag, solicitada, momento);
+    int pedida = agenda_franja_pedida(ag, solicitada, momento);
+
+    // El hash del nombre se calcula antes de tomar el cerrojo
+    uint32_t hash = nombres_hash(familia, largo_familia);
+
+    // Con el cerrojo libre se reserva por el camino de siempre; si está
+    // ocupado y la ventana pedida tiene cupo, se toma sin esperarlo
+    if(pthread_mutex_trylock(&ag->bloqueo) == 0){
+        metricas_anotar(ETAPA_CERROJO, 0);
+    } else if(ag->via_rapida && asignar_rapido(ag, posicion, pedida, cantidad, familia, largo_familia, hash) == 0){
+        return agenda_minuto(ag, posicion);
+    } else {
+        tomar_cerrojo(ag);
+    }
+    int i = asignar_bloqueado(ag, posicion, pedida, cantidad, familia, largo_familia, hash);
+    pthread_mutex_unlock(&ag->bloqueo);
+
+    return i == -1 ? -1 : agenda_minuto(ag, i);    // Devolver inicio asignado
+}
+
+void agenda_asignar_lote(Agenda* ag, PedidoAgenda pedidos[], int cantidad, float momento){
+    // Posiciones y hashes fuera del cerrojo
+    uint32_t hashes[cantidad > 0 ? cantidad : 1];
+    for(int k=0; k<cantidad; k++){
+        hashes[k] = nombres_hash(pedidos[k].familia, pedidos[k].largo_familia);
+        pedidos[k].asignado = agenda_franja_desde(ag, pedidos[k].solicitada, momento);
+    }
+
+    // Un solo cerrojo para todo el lote, en orden
+    tomar_cerrojo(ag);
+    for(int k=0; k<cantidad; k++){
+        pedidos[k].asignado = asignar_bloqueado(ag, pedidos[k].asignado,
+                                                agenda_franja_pedida(ag, pedidos[k].solicitada, momento),
+                                                pedidos[k].cantidad, pedidos[k].familia,
+                                                pedidos[k].largo_familia, hashes[k]);
+    }
+    pthread_mutex_unlock(&ag->bloqueo);
+
+    for(int k=0; k<cantidad; k++){
+        if(pedidos[k].asignado != -1) pedidos[k].asignado = agenda_minuto(ag, pedidos[k].asignado);
+    }
+}
+
+void agenda_aplicar(Agenda* ag){
+    pthread_mutex_lock(&ag->bloqueo);
+    aplicar_bloqueado(ag);
+    pthread_mutex_unlock(&ag->bloqueo);
+}
+
+int agenda_restaurar(Agenda* ag, int franja, int personas, int nombre){
+    if(franja < 0 || franja + ag->visita > ag->franjas || personas <= 0 ||
+       nombre < 0 || nombre >= ag->nombres.cantidad){
+        return -1;
+    }
+    if(anotar_bloqueado(ag, franja, personas, nombre) == -1) return -1;
+    indice_sumar(&ag->indice, franja, -personas);
+    for(int j=franja; j<franja+ag->visita; j++){
+        atomic_fetch_add_explicit(&ag->ocupacion[j], personas, memory_order_relaxed);
+    }
+    return 0;
+}
+
+// Copia los nombres de las reservas de 'v' (bajo el cerrojo)
+static const char** copiar_nombres(Agenda* ag, VectorIndices* v){
+    const char** textos = malloc((v->cantidad > 0 ? v->cantidad : 1) * sizeof(char*));
+    if(textos == NULL) return NULL;
+    for(int k=0; k<v->cantidad; k++){
+        textos[k] = nombres_texto(&ag->nombres, agenda_reserva(ag, v->datos[k])->nombre);
+    }
+    return textos;
+}
+
+int agenda_instantanea(Agenda* ag, int posicion, Instantanea* inst){
+    memset(inst, 0, sizeof(*inst));
+    inst->posicion = posicion;
+
+    pthread_mutex_lock(&ag->bloqueo);
+    aplicar_bloqueado(ag);
+
+    if(posicion > 0){
+        inst->salen = copiar_nombres(ag, &ag->salen[posicion]);
+        inst->num_salen = ag->salen[posicion].cantidad;
+        inst->egresos = ag->egresos[posicion];
+    }
+    if(posicion < ag->franjas){
+        inst->ingresan = copiar_nombres(ag, &ag->ingresan[posicion]);
+        inst->num_ingresan = ag->ingresan[posicion].cantidad;
+        inst->ingresos = ag->ingresos[posicion];
+    }
+
+    pthread_mutex_unlock(&ag->bloqueo);
+
+    if((posicion > 0 && inst->salen == NULL) || (posicion < ag->franjas && inst->ingresan == NULL)){
+        instantanea_liberar(inst);
+        return -1;
+    }
+    return 0;
+}
+
+void instantanea_liberar(Instantanea* inst){
+    free(inst->ingresan);
+    free(inst->salen);
+    inst->ingresan = NULL;
+    inst->salen = NULL;
+}
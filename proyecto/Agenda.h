@@ -0,0 +1,162 @@
+#ifndef AGENDA_H
+#define AGENDA_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "Indice.h"
+#include "Arena.h"
+#include "Nombres.h"
+
+#define RESERVAS_POR_BLOQUE 4096
+#define PENDIENTES_MAXIMO 256     // Reservas de la vía rápida que se juntan antes de registrarlas
+#define LINEA_CACHE 64
+
+// Una reserva aceptada. Los registros se reservan por bloques en la arena
+// y se identifican por su posición (índice) en orden de llegada.
+typedef struct {
+    int nombre;                   // ID del grupo en la tabla de nombres
+    int inicio;                   // Franja de ingreso
+    int personas;
+} Reserva;
+
+// Lista compacta de índices de reserva (crece al doble)
+typedef struct {
+    int* datos;
+    int cantidad;
+    int capacidad;
+} VectorIndices;
+
+// Reserva tomada por la vía rápida que todavía no está en los registros
+typedef struct Pendiente {
+    struct Pendiente* siguiente;
+    int inicio;                   // Franja de ingreso
+    int personas;
+    int confirmada;               // 1 si es la franja pedida (para el diario)
+    uint32_t hash;
+    int largo;
+    char familia[];
+} Pendiente;
+
+// Estado de ocupación del parque, con su propio cerrojo. El día se divide
+// en franjas de 'minutos' minutos (60 = una franja por hora); las visitas
+// duran 'visita' franjas.
+// El cupo lo manda 'ocupacion': cada reserva suma sus personas a las
+// franjas de la ventana con CAS, franja por franja, y deshace lo sumado si
+// alguna no tiene lugar. Así, si el cerrojo está ocupado y la ventana
+// pedida tiene cupo, la reserva se decide sin esperarlo (vía rápida) y
+// queda en 'pendientes'; quien toma el cerrojo la pasa a registros, índice
+// y diario, en tanda.
+// Si la ventana pedida no tiene lugar, se busca la primera con cupo bajo
+// 'bloqueo', como siempre. El índice puede atrasarse respecto de
+// 'ocupacion' (solo por pendientes), así que sobreestima el cupo: la
+// ventana que da se confirma con el mismo CAS.
+// El reloj copia una instantánea de la franja bajo el cerrojo e imprime fuera.
+// Los números por franja (ocupación, ingresos, egresos y el cupo libre del
+// índice) viven en 'tabla': un solo bloque alineado, un arreglo por campo
+// y cada arreglo desde su propia línea, así un recorrido de un campo (el
+// informe, la búsqueda de la ventana) lee solo líneas de ese campo.
+// Los campos de la agenda van en tres grupos de líneas: lo que no cambia
+// después de crearla (lo lee cada reserva), lo que se escribe con el
+// cerrojo (el reloj lo toma en cada instantánea) y la pila de la vía
+// rápida (la escribe cualquier trabajador). Así tomar el cerrojo o apilar
+// no invalida la línea que las reservas leen sin él.
+typedef struct {
+    int apertura;                 // Hora de la primera franja
+    int minutos;                  // Minutos por franja (divide a 60)
+    int franjas;                  // Nº de franjas (un día o más)
+    int capacidad;                // Capacidad del parque
+    int visita;                   // Franjas que dura cada visita
+    int via_rapida;               // 1: con el cerrojo ocupado, reservar sin él si la ventana pedida tiene cupo
+    _Atomic int* ocupacion;       // Personas por franja (el cupo real)
+    int* ingresos;                // Personas que ingresan por franja
+    int* egresos;                 // Personas que salen por franja (0..franjas)
+    void* tabla;                  // Bloque con los arreglos por franja (e 'indice.libre')
+    struct Diario* diario;        // Si no es NULL, cada reserva se anota ahí
+
+    _Alignas(LINEA_CACHE) pthread_mutex_t bloqueo;  // Protege índice, ingresos y registros
+    IndiceCapacidad indice;       // Cupo libre por ventana de visita
+    Arena arena;                  // Registros de reserva y textos de nombres
+    Nombres nombres;              // Cada nombre de grupo guardado una vez
+    Reserva** bloques;            // Bloques de RESERVAS_POR_BLOQUE registros
+    int num_reservas;
+    VectorIndices* ingresan;      // Por franja: reservas que empiezan ahí
+    VectorIndices* salen;         // Por franja (0..franjas): reservas que terminan ahí
+
+    _Alignas(LINEA_CACHE) _Atomic(Pendiente*) pendientes;  // Pila de la vía rápida
+    _Atomic int num_pendientes;
+} Agenda;
+
+// Una solicitud de un lote para agenda_asignar_lote
+typedef struct {
+    int solicitada;               // Hora pedida
+    int cantidad;                 // Personas
+    const char* familia;
+    int largo_familia;
+    int asignado;                 // Salida: inicio en minutos desde las 0:00, o -1
+} PedidoAgenda;
+
+// Copia de lo que el reloj necesita para informar la franja 'posicion'
+typedef struct {
+    int posicion;
+    int ingresos;                 // Personas que entran en posicion
+    int egresos;                  // Personas que salen en posicion
+    const char** ingresan;        // Grupos que entran en posicion
+    int num_ingresan;
+    const char** salen;           // Grupos que salen en posicion
+    int num_salen;
+} Instantanea;
+
+// 0 si ok, -1 sin memoria
+int agenda_crear(Agenda* ag, int apertura, int minutos, int franjas, int capacidad, int visita);
+void agenda_destruir(Agenda* ag);
+
+// Reserva la primera ventana con cupo desde la hora solicitada (o desde la
+// franja siguiente a 'momento', en horas, si ya pasó). Devuelve el inicio
+// asignado en minutos desde las 0:00, o -1 si no hay cupo.
+int agenda_asignar(Agenda* ag, int solicitada, float momento, int cantidad,
+                   const char* familia, int largo_familia);
+
+// Igual que agenda_asignar para cada pedido, en orden, tomando el cerrojo una
+// sola vez para todo el lote. El resultado queda en pedidos[k].asignado.
+void agenda_asignar_lote(Agenda* ag, PedidoAgenda pedidos[], int cantidad, float momento);
+
+// Vuelve a registrar una reserva ya decidida (al recuperar el diario), sin
+// buscar ni verificar cupo. 'nombre' es un ID ya internado. 0 si ok, -1 si
+// los datos no caben en la agenda o sin memoria.
+int agenda_restaurar(Agenda* ag, int franja, int personas, int nombre);
+
+// Minuto del día en que empieza la franja 'posicion'
+static inline int agenda_minuto(const Agenda* ag, int posicion){
+    return ag->apertura * 60 + posicion * ag->minutos;
+}
+
+// Franja que contiene 'momento' (en horas); negativa antes de la apertura
+int agenda_franja(const Agenda* ag, float momento);
+
+// Franja desde la que se busca: la pedida, o la siguiente a 'momento' si ya pasó
+static inline int agenda_franja_desde(const Agenda* ag, int solicitada, float momento){
+    return (solicitada < momento) ? agenda_franja(ag, momento) + 1
+                                  : (solicitada - ag->apertura) * 60 / ag->minutos;
+}
+
+// Franja que cuenta como confirmada: la pedida, o ninguna si ya pasó
+static inline int agenda_franja_pedida(const Agenda* ag, int solicitada, float momento){
+    return (solicitada < momento) ? -1 : (solicitada - ag->apertura) * 60 / ag->minutos;
+}
+
+// Pasa a los registros las reservas de la vía rápida (toma el cerrojo).
+// Llamarla antes de leer registros, ingresos o el índice sin instantánea.
+void agenda_aplicar(Agenda* ag);
+
+// Registro 'indice' (llamar con el cerrojo tomado si hay reservas en curso)
+static inline Reserva* agenda_reserva(Agenda* ag, int indice){
+    return &ag->bloques[indice / RESERVAS_POR_BLOQUE][indice % RESERVAS_POR_BLOQUE];
+}
+
+// Copia personas y grupos que entran/salen en 'posicion' bajo el cerrojo
+// (con las reservas de la vía rápida ya registradas).
+// Los textos viven en la arena hasta agenda_destruir. 0 si ok, -1 sin memoria.
+int agenda_instantanea(Agenda* ag, int posicion, Instantanea* inst);
+void instantanea_liberar(Instantanea* inst);
+
+#endif
@@ -0,0 +1,45 @@
+#include <stdlib.h>
+#include "Arena.h"
+
+struct BloqueArena {
+    BloqueArena* anterior;
+    size_t usados;
+    size_t tam;
+    char datos[];
+};
+
+void arena_crear(Arena* arena, size_t tam_bloque){
+    arena->actual = NULL;
+    arena->tam_bloque = tam_bloque;
+    arena->total = 0;
+}
+
+void arena_destruir(Arena* arena){
+    while(arena->actual != NULL){
+        BloqueArena* anterior = arena->actual->anterior;
+        free(arena->actual);
+        arena->actual = anterior;
+    }
+    arena->total = 0;
+}
+
+void* arena_reservar(Arena* arena, size_t bytes){
+    bytes = (bytes + 7) & ~(size_t)7;
+
+    BloqueArena* bloque = arena->actual;
+    if(bloque == NULL || bloque->tam - bloque->usados < bytes){
+        // Un pedido más grande que un bloque recibe un bloque a su medida
+        size_t tam = bytes > arena->tam_bloque ? bytes : arena->tam_bloque;
+        bloque = malloc(sizeof(BloqueArena) + tam);
+        if(bloque == NULL) return NULL;
+        bloque->anterior = arena->actual;
+        bloque->usados = 0;
+        bloque->tam = tam;
+        arena->actual = bloque;
+        arena->total += sizeof(BloqueArena) + tam;
+    }
+
+    void* puntero = bloque->datos + bloque->usados;
+    bloque->usados += bytes;
+    return puntero;
+}
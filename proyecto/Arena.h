@@ -0,0 +1,25 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Reserva de memoria por bloques ("bump allocator"): cada pedido avanza un
+// puntero dentro del bloque actual y, al llenarse, se encadena otro. No hay
+// liberación individual; todo se devuelve junto en arena_destruir. Lo que
+// se reserva nunca se mueve, así que los punteros siguen válidos.
+
+typedef struct BloqueArena BloqueArena;
+
+typedef struct {
+    BloqueArena* actual;          // Bloque donde se reserva (lista hacia atrás)
+    size_t tam_bloque;            // Tamaño de cada bloque nuevo
+    size_t total;                 // Bytes pedidos al sistema (para medir)
+} Arena;
+
+void arena_crear(Arena* arena, size_t tam_bloque);
+void arena_destruir(Arena* arena);
+
+// 'bytes' alineados a 8. NULL sin memoria.
+void* arena_reservar(Arena* arena, size_t bytes);
+
+#endif
@@ -0,0 +1,1277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <sys/stat.h>
+#include <math.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "Indice.h"
+#include "Agenda.h"
+#include "Reloj.h"
+#include "Lector.h"
+#include "Protocolo.h"
+#include "Compartida.h"
+#include "Metricas.h"
+#include "Diario.h"
+#include "Plan.h"
+#include "Franjas.h"
+
+// Microbenchmarks de las estructuras del controlador.
+// Uso: ./benchmark <prueba> [parámetros]
+//   indice [franjas] [solicitudes] [visita]   Árbol de segmentos vs búsqueda lineal
+//   contencion [hilos] [solicitudes/hilo]     Reservas concurrentes mientras el reloj informa
+//   memoria [reservas] [distintos] [capacidad] Memoria de los registros de reserva
+//   reloj [horas] [seg/hora] [días virtuales]  Error al detectar cada hora
+//   csv [líneas]                               Lectura de archivos de solicitudes
+//   transporte [mensajes] [ventana]            FIFOs vs memoria compartida (ida y vuelta)
+//   metricas [solicitudes] [us/solicitud]      Costo de la instrumentación por solicitud
+//   diario [reservas] [distintos] [prefijo]    Costo del diario y tiempo de recuperación
+//   plan [solicitudes] [hilos] [intentos]      Plan fuera de línea vs voraz, por cantidad de hilos
+//   simd [franjas] [visita]                    Operaciones sobre franjas: bucles vs escalar/SSE2/AVX2
+//   cache [solicitudes] [minutos]              Fallos de caché de admisión e informes, de 1 a 30 días
+
+static double segundos_ahora(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// Búsqueda lineal original de asignar_espacio, generalizada a 'largo' franjas
+static int buscar_lineal(int ocupacion[], int franjas, int desde, int largo, int personas, int capacidad){
+    for(int i=desde; i+largo<=franjas; i++){
+        int cabe = 1;
+        for(int j=i; j<i+largo; j++){
+            if(ocupacion[j] + personas > capacidad){
+                cabe = 0;
+                break;
+            }
+        }
+        if(cabe) return i;
+    }
+    return -1;
+}
+
+static int prueba_indice(int argc, char* argv[]){
+    int franjas = argc > 2 ? atoi(argv[2]) : 43200;       // 30 días en franjas de 1 minuto
+    int solicitudes = argc > 3 ? atoi(argv[3]) : 20000;
+    int largo = argc > 4 ? atoi(argv[4]) : 120;           // Visita de 2 horas
+    int capacidad = 500;
+
+    // Misma secuencia de solicitudes para ambos métodos. Las horas pedidas se
+    // concentran en el primer 10% del horizonte: las franjas populares se
+    // llenan y cada solicitud nueva tiene que buscar cada vez más lejos
+    int* desde = malloc(solicitudes * sizeof(int));
+    int* personas = malloc(solicitudes * sizeof(int));
+    srand(42);
+    for(int i=0; i<solicitudes; i++){
+        desde[i] = rand() % (franjas / 10 + 1);
+        personas[i] = 1 + rand() % 10;
+    }
+
+    int* ocupacion = calloc(franjas, sizeof(int));
+    int* resultado_lineal = malloc(solicitudes * sizeof(int));
+    double t0 = segundos_ahora();
+    for(int i=0; i<solicitudes; i++){
+        int p = buscar_lineal(ocupacion, franjas, desde[i], largo, personas[i], capacidad);
+        if(p != -1){
+            for(int j=p; j<p+largo; j++) ocupacion[j] += personas[i];
+        }
+        resultado_lineal[i] = p;
+    }
+    double lineal = segundos_ahora() - t0;
+
+    IndiceCapacidad indice;
+    if(indice_crear(&indice, franjas, largo, capacidad) == -1){
+        printf("Sin memoria\n");
+        return 1;
+    }
+    int diferencias = 0, asignadas = 0;
+    t0 = segundos_ahora();
+    for(int i=0; i<solicitudes; i++){
+        int p = indice_buscar(&indice, desde[i], personas[i]);
+        if(p != -1){
+            indice_sumar(&indice, p, -personas[i]);
+            asignadas++;
+        }
+        diferencias += (p != resultado_lineal[i]);
+    }
+    double arbol = segundos_ahora() - t0;
+
+    printf("franjas=%d solicitudes=%d visita=%d asignadas=%d diferencias=%d\n",
+           franjas, solicitudes, largo, asignadas, diferencias);
+    printf("lineal: %10.1f ns/solicitud\n", lineal * 1e9 / solicitudes);
+    printf("indice: %10.1f ns/solicitud (x%.1f)\n", arbol * 1e9 / solicitudes, lineal / arbol);
+
+    indice_destruir(&indice);
+    free(desde); free(personas); free(ocupacion); free(resultado_lineal);
+    return diferencias != 0;
+}
+
+// ---- contencion ----
+
+typedef struct {
+    Agenda* agenda;
+    int solicitudes;
+    int semilla;
+    double* latencias;          // Segundos por reserva
+} HiloAgente;
+
+typedef struct {
+    Agenda* agenda;
+    int global;                 // 1: imprime con el cerrojo tomado (como antes)
+    volatile int activo;
+    int informes;
+} HiloReloj;
+
+static void* reservar(void* parametros){
+    HiloAgente* h = parametros;
+    unsigned int semilla = h->semilla;
+    char nombre[32];
+    for(int i=0; i<h->solicitudes; i++){
+        int largo = snprintf(nombre, sizeof(nombre), "G%d_%d", h->semilla, i);
+        int hora = h->agenda->apertura + rand_r(&semilla) % h->agenda->franjas;
+        double t0 = segundos_ahora();
+        agenda_asignar(h->agenda, hora, h->agenda->apertura, 1 + rand_r(&semilla) % 4, nombre, largo);
+        h->latencias[i] = segundos_ahora() - t0;
+    }
+    return NULL;
+}
+
+// Mismo trabajo que informar_franja: listar los grupos que entran y salen
+static void listar_franja(FILE* salida, const char** ingresan, int ni, const char** salen, int ns){
+    for(int i=0; i<ni; i++) fprintf(salida, "   * Grupo %s (ingreso confirmado)\n", ingresan[i]);
+    for(int i=0; i<ns; i++) fprintf(salida, "   * Grupo %s (salida registrada)\n", salen[i]);
+}
+
+// Igual que listar_franja pero leyendo la agenda directamente (cerrojo tomado)
+static void listar_franja_agenda(FILE* salida, Agenda* ag, int posicion){
+    VectorIndices* ingresan = &ag->ingresan[posicion];
+    VectorIndices* salen = &ag->salen[posicion];
+    for(int i=0; i<ingresan->cantidad; i++){
+        fprintf(salida, "   * Grupo %s (ingreso confirmado)\n",
+                nombres_texto(&ag->nombres, agenda_reserva(ag, ingresan->datos[i])->nombre));
+    }
+    for(int i=0; i<salen->cantidad; i++){
+        fprintf(salida, "   * Grupo %s (salida registrada)\n",
+                nombres_texto(&ag->nombres, agenda_reserva(ag, salen->datos[i])->nombre));
+    }
+}
+
+static void* informar(void* parametros){
+    HiloReloj* h = parametros;
+    Agenda* ag = h->agenda;
+    FILE* nulo = fopen("/dev/null", "w");
+    for(int posicion = 1; h->activo; posicion = 1 + posicion % (ag->franjas - 1)){
+        if(h->global){
+            pthread_mutex_lock(&ag->bloqueo);
+            listar_franja_agenda(nulo, ag, posicion);
+            pthread_mutex_unlock(&ag->bloqueo);
+        } else {
+            Instantanea inst;
+            if(agenda_instantanea(ag, posicion, &inst) == 0){
+                listar_franja(nulo, inst.ingresan, inst.num_ingresan, inst.salen, inst.num_salen);
+                instantanea_liberar(&inst);
+            }
+        }
+        h->informes++;
+        usleep(1000);           // Un "tic" del reloj por milisegundo
+    }
+    fclose(nulo);
+    return NULL;
+}
+
+static int comparar_double(const void* a, const void* b){
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// 1 si la ocupación de cada franja coincide con los registros, el índice y la capacidad
+static int cupo_consistente(Agenda* ag){
+    agenda_aplicar(ag);
+    int suma[ag->franjas];
+    memset(suma, 0, sizeof(suma));
+    for(int k=0; k<ag->num_reservas; k++){
+        Reserva* r = agenda_reserva(ag, k);
+        for(int j=r->inicio; j<r->inicio+ag->visita; j++) suma[j] += r->personas;
+    }
+    for(int j=0; j<ag->franjas; j++){
+        int ocupadas = atomic_load(&ag->ocupacion[j]);
+        if(ocupadas != suma[j] || ocupadas > ag->capacidad || indice_libre(&ag->indice, j) != ag->capacidad - ocupadas){
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int medir_contencion(int global, int rapida, int hilos, int solicitudes){
+    Agenda agenda;
+    agenda_crear(&agenda, 7, 60, 12, 20000, 2);
+    agenda.via_rapida = rapida;
+
+    HiloReloj reloj = { &agenda, global, 1, 0 };
+    pthread_t hilo_reloj;
+    pthread_create(&hilo_reloj, NULL, informar, &reloj);
+
+    pthread_t ids[hilos];
+    HiloAgente agentes[hilos];
+    double* latencias = malloc((size_t)hilos * solicitudes * sizeof(double));
+    double t0 = segundos_ahora();
+    for(int i=0; i<hilos; i++){
+        agentes[i] = (HiloAgente){ &agenda, solicitudes, i + 1, latencias + (size_t)i * solicitudes };
+        pthread_create(&ids[i], NULL, reservar, &agentes[i]);
+    }
+    for(int i=0; i<hilos; i++) pthread_join(ids[i], NULL);
+    double total = segundos_ahora() - t0;
+    reloj.activo = 0;
+    pthread_join(hilo_reloj, NULL);
+
+    size_t n = (size_t)hilos * solicitudes;
+    qsort(latencias, n, sizeof(double), comparar_double);
+    int consistente = cupo_consistente(&agenda);
+    printf("%-12s %10.0f reservas/s  p50 %7.1f us  p99 %9.1f us  max %9.1f us  informes %d  asignadas %d%s\n",
+           global ? "global" : rapida ? "via rapida" : "instantanea", n / total,
+           latencias[n/2] * 1e6, latencias[n*99/100] * 1e6, latencias[n-1] * 1e6, reloj.informes,
+           agenda.num_reservas, consistente ? "" : "  CUPO INCONSISTENTE");
+
+    free(latencias);
+    agenda_destruir(&agenda);
+    return consistente;
+}
+
+static int prueba_contencion(int argc, char* argv[]){
+    int hilos = argc > 2 ? atoi(argv[2]) : 8;
+    int solicitudes = argc > 3 ? atoi(argv[3]) : 20000;
+    printf("hilos=%d solicitudes/hilo=%d capacidad=20000 franjas=12\n", hilos, solicitudes);
+    int consistente = medir_contencion(1, 0, hilos, solicitudes);
+    consistente &= medir_contencion(0, 0, hilos, solicitudes);
+    consistente &= medir_contencion(0, 1, hilos, solicitudes);
+    return consistente ? 0 : 1;
+}
+
+// ---- memoria ----
+
+// Bytes en uso según malloc: montículo más bloques grandes servidos con mmap
+static size_t memoria_en_uso(){
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+// Esquema anterior: 'capacidad' punteros por franja y un strndup por reserva,
+// el mismo puntero guardado en cada franja de la visita
+static size_t medir_antes(int franjas, int capacidad, int visita, int reservas, int distintos){
+    char** copias = malloc(reservas * sizeof(char*));   // Para liberar al final (no se mide)
+    int num_copias = 0;
+
+    size_t base = memoria_en_uso();
+    char*** registros = malloc(franjas * sizeof(char**));
+    int* contadores = calloc(franjas, sizeof(int));
+    int* ocupacion = calloc(franjas, sizeof(int));
+    for(int i=0; i<franjas; i++) registros[i] = malloc(capacidad * sizeof(char*));
+
+    char nombre[32];
+    srand(7);
+    for(int r=0; r<reservas; r++){
+        int largo = snprintf(nombre, sizeof(nombre), "Familia%d", rand() % distintos);
+        int p = buscar_lineal(ocupacion, franjas, rand() % (franjas - visita + 1), visita, 1, capacidad);
+        if(p == -1) continue;
+        char* duplicado = strndup(nombre, largo);
+        copias[num_copias++] = duplicado;
+        for(int j=p; j<p+visita; j++){
+            ocupacion[j]++;
+            registros[j][contadores[j]++] = duplicado;
+        }
+    }
+    size_t usado = memoria_en_uso() - base;
+
+    for(int i=0; i<num_copias; i++) free(copias[i]);
+    for(int i=0; i<franjas; i++) free(registros[i]);
+    free(registros); free(contadores); free(ocupacion); free(copias);
+    return usado;
+}
+
+static size_t medir_agenda(int franjas, int capacidad, int visita, int reservas, int distintos, int* asignadas){
+    size_t base = memoria_en_uso();
+    Agenda agenda;
+    agenda_crear(&agenda, 0, 60, franjas, capacidad, visita);
+
+    char nombre[32];
+    srand(7);
+    for(int r=0; r<reservas; r++){
+        int largo = snprintf(nombre, sizeof(nombre), "Familia%d", rand() % distintos);
+        agenda_asignar(&agenda, rand() % (franjas - visita + 1), 0, 1, nombre, largo);
+    }
+    agenda_aplicar(&agenda);
+    size_t usado = memoria_en_uso() - base;
+    *asignadas = agenda.num_reservas;
+    agenda_destruir(&agenda);
+    return usado;
+}
+
+static int prueba_memoria(int argc, char* argv[]){
+    int reservas = argc > 2 ? atoi(argv[2]) : 1000000;
+    int distintos = argc > 3 ? atoi(argv[3]) : 50000;
+    int franjas = 12, visita = 2;
+    // Por defecto, capacidad justa para que entren todas las reservas de 1 persona
+    int capacidad = argc > 4 ? atoi(argv[4]) : (int)((long)reservas * visita / (franjas - visita + 1)) + 1;
+
+    int asignadas;
+    size_t antes = medir_antes(franjas, capacidad, visita, reservas, distintos);
+    size_t despues = medir_agenda(franjas, capacidad, visita, reservas, distintos, &asignadas);
+
+    printf("reservas=%d asignadas=%d nombres distintos=%d franjas=%d capacidad=%d\n",
+           reservas, asignadas, distintos, franjas, capacidad);
+    printf("antes:   %8.1f MB  (%5.1f bytes/reserva)\n", antes / 1e6, (double)antes / reservas);
+    printf("despues: %8.1f MB  (%5.1f bytes/reserva)\n", despues / 1e6, (double)despues / asignadas);
+    return 0;
+}
+
+// ---- reloj ----
+
+// Bucle anterior: time() (resolución 1 s) cada 100 ms. Devuelve el error
+// medio y máximo (ms reales, en valor absoluto) con que se detecta cada
+// cambio de hora: time() trunca el segundo, así que puede adelantarse o atrasarse.
+static void medir_sondeo(int horas, double segundos_por_hora, double* medio, double* maximo){
+    time_t inicio;
+    time(&inicio);
+    double origen = segundos_ahora();
+    float anterior = 0;
+    int detectadas = 0;
+    *medio = *maximo = 0;
+    while(detectadas < horas){
+        time_t actual;
+        time(&actual);
+        float ahora = difftime(actual, inicio) / segundos_por_hora;
+        if((int)ahora != (int)anterior){
+            // Distancia al borde real de la hora detectada
+            double retraso = fabs(segundos_ahora() - origen - (int)ahora * segundos_por_hora) * 1e3;
+            anterior = ahora;
+            detectadas++;
+            *medio += retraso;
+            if(retraso > *maximo) *maximo = retraso;
+        }
+        usleep(100000);
+    }
+    *medio /= horas;
+}
+
+// Reloj nuevo: timerfd armado para el borde exacto de cada hora
+static void medir_temporizador(int horas, double segundos_por_hora, double* medio, double* maximo){
+    Reloj reloj;
+    reloj_iniciar(&reloj, 0, segundos_por_hora, 0);
+    *medio = *maximo = 0;
+    for(int h=1; h<=horas; h++){
+        reloj_esperar_hasta(&reloj, h * MS_POR_HORA);
+        double borde = reloj.inicio_ns / 1e9 + h * segundos_por_hora;
+        double retraso = (segundos_ahora() - borde) * 1e3;
+        *medio += retraso;
+        if(retraso > *maximo) *maximo = retraso;
+    }
+    *medio /= horas;
+    reloj_destruir(&reloj);
+}
+
+typedef struct {
+    Reloj* reloj;
+    int franjas;
+    int informes;
+} HiloVirtual;
+
+static void* esperar_franjas(void* parametros){
+    HiloVirtual* h = parametros;
+    for(int i=1; i<=h->franjas; i++){
+        reloj_esperar_hasta(h->reloj, i * 60000LL);
+        h->informes++;
+    }
+    return NULL;
+}
+
+static int prueba_reloj(int argc, char* argv[]){
+    int horas = argc > 2 ? atoi(argv[2]) : 4;
+    double segundos_por_hora = argc > 3 ? atof(argv[3]) : 1.0;
+    int dias = argc > 4 ? atoi(argv[4]) : 30;
+
+    double medio, maximo;
+    printf("horas=%d seg/hora=%.2f\n", horas, segundos_por_hora);
+    medir_sondeo(horas, segundos_por_hora, &medio, &maximo);
+    printf("sondeo 100 ms + time(): error medio %8.3f ms  max %8.3f ms\n", medio, maximo);
+    medir_temporizador(horas, segundos_por_hora, &medio, &maximo);
+    printf("timerfd monotónico:     error medio %8.3f ms  max %8.3f ms\n", medio, maximo);
+
+    // Tiempo virtual: un hilo espera cada franja de 1 minuto y otro avanza el reloj
+    Reloj reloj;
+    reloj_iniciar(&reloj, 0, 1.0, 1);
+    HiloVirtual espera = { &reloj, dias * 24 * 60, 0 };
+    pthread_t hilo;
+    double t0 = segundos_ahora();
+    pthread_create(&hilo, NULL, esperar_franjas, &espera);
+    for(int i=1; i<=espera.franjas; i++) reloj_avanzar(&reloj, i * 60000LL);
+    pthread_join(hilo, NULL);
+    printf("virtual: %d días en franjas de 1 min (%d bordes) en %.1f ms\n",
+           dias, espera.informes, (segundos_ahora() - t0) * 1e3);
+    reloj_destruir(&reloj);
+    return 0;
+}
+
+// ---- csv ----
+
+// Lectura anterior del agente: fgets a 50 bytes, strcpy y strtok/atoi
+static long leer_con_strtok(const char* ruta, long* suma){
+    FILE* archivo = fopen(ruta, "r");
+    char registro[50];
+    long registros = 0;
+    while(fgets(registro, sizeof(registro), archivo)){
+        char temporal[50];
+        strcpy(temporal, registro);
+        char* nombre = strtok(temporal, ",");
+        int hora = atoi(strtok(NULL, ","));
+        int personas = atoi(strtok(NULL, ","));
+        *suma += strlen(nombre) + hora + personas;
+        registros++;
+    }
+    fclose(archivo);
+    return registros;
+}
+
+static long leer_con_lector(const char* ruta, long* suma){
+    LectorCsv lector;
+    RegistroCsv registro;
+    long registros = 0;
+    int estado;
+    lector_abrir(&lector, ruta);
+    while((estado = lector_siguiente(&lector, &registro)) != 0){
+        if(estado == -1) continue;
+        *suma += registro.largo + registro.hora + registro.personas;
+        registros++;
+    }
+    lector_cerrar(&lector);
+    return registros;
+}
+
+static int prueba_csv(int argc, char* argv[]){
+    long lineas = argc > 2 ? atol(argv[2]) : 10000000;
+
+    // Archivo temporal con apellidos y números como los de solicitudes_*.csv
+    char ruta[] = "/tmp/benchmark_csvXXXXXX";
+    int fd = mkstemp(ruta);
+    FILE* archivo = fdopen(fd, "w");
+    const char* apellidos[] = {"Martinez", "Gonzalez", "Rodriguez", "Silva", "Torres", "Hernandez"};
+    srand(11);
+    for(long i=0; i<lineas; i++){
+        fprintf(archivo, "%s%d,%d,%d\n", apellidos[rand() % 6], rand() % 100000, 7 + rand() % 12, 1 + rand() % 20);
+    }
+    fclose(archivo);
+    struct stat info;
+    stat(ruta, &info);
+
+    long suma_anterior = 0, suma_lector = 0;
+    leer_con_lector(ruta, &suma_lector);                // Calentar la caché de páginas
+    suma_lector = 0;
+
+    double t0 = segundos_ahora();
+    long anterior = leer_con_strtok(ruta, &suma_anterior);
+    double t_anterior = segundos_ahora() - t0;
+
+    t0 = segundos_ahora();
+    long nuevo = leer_con_lector(ruta, &suma_lector);
+    double t_lector = segundos_ahora() - t0;
+    unlink(ruta);
+
+    printf("lineas=%ld tamaño=%.1f MB\n", lineas, info.st_size / 1e6);
+    printf("fgets+strtok: %6.2f M registros/s  (%7.1f MB/s)\n", anterior / t_anterior / 1e6, info.st_size / t_anterior / 1e6);
+    printf("mmap+lector:  %6.2f M registros/s  (%7.1f MB/s)  x%.1f\n", nuevo / t_lector / 1e6,
+           info.st_size / t_lector / 1e6, t_anterior / t_lector);
+    return (anterior != nuevo || suma_anterior != suma_lector);
+}
+
+// ---- transporte ----
+
+// Un extremo agente de la prueba, por FIFOs o por memoria compartida
+typedef struct {
+    int desc_envio, desc_recibo;  // FIFOs (bloqueantes)
+    Compartida* compartida;       // NULL: FIFOs
+    int anillo;
+    Decodificador entrada;
+} CanalPrueba;
+
+static void canal_enviar(CanalPrueba* k, uint32_t secuencia){
+    CabeceraMarco cab = { .tipo = MSG_SOLICITUD, .agente = 1, .hora = 9, .personas = 4, .secuencia = secuencia };
+    if(k->compartida == NULL){
+        marco_enviar(k->desc_envio, cab, "Benchmark", 9);
+        return;
+    }
+    while(compartida_enviar(k->compartida, cab, "Benchmark", 9) == -1){
+        compartida_esperar_respuestas(k->compartida, k->anillo, 1);
+    }
+}
+
+// Bloquea hasta recibir al menos una respuesta; devuelve cuántas llegaron
+static int canal_recibir(CanalPrueba* k){
+    CabeceraMarco cab;
+    const char* nombre;
+    int recibidas = 0;
+    while(1){
+        while(decodificador_siguiente(&k->entrada, &cab, &nombre) == 1) recibidas++;
+        if(recibidas > 0) return recibidas;
+        if(k->compartida == NULL){
+            if(decodificador_leer(&k->entrada, k->desc_recibo) <= 0) return 0;
+        } else if(compartida_leer(k->compartida, k->anillo, &k->entrada) == -1){
+            compartida_esperar_respuestas(k->compartida, k->anillo, -1);
+        }
+    }
+}
+
+// Proceso hijo: hace de controlador y devuelve cada solicitud como respuesta
+static void eco_fifo(const char* peticiones, const char* respuestas){
+    static Decodificador entrada;
+    int fd_entrada = open(peticiones, O_RDONLY);
+    int fd_salida = open(respuestas, O_WRONLY);
+    CabeceraMarco cab;
+    const char* nombre;
+    decodificador_iniciar(&entrada);
+    while(decodificador_leer(&entrada, fd_entrada) > 0){
+        while(decodificador_siguiente(&entrada, &cab, &nombre) == 1){
+            if(cab.tipo == MSG_CIERRE) _exit(0);
+            cab.tipo = MSG_RESPUESTA;
+            marco_enviar(fd_salida, cab, nombre, cab.largo_nombre);
+        }
+    }
+    _exit(0);
+}
+
+static void eco_compartida(Compartida* c, int anillo){
+    CabeceraMarco cab;
+    const char* nombre;
+    while(1){
+        while(compartida_tomar(c, &cab, &nombre) == 1){
+            if(cab.tipo == MSG_CIERRE) _exit(0);
+            cab.tipo = MSG_RESPUESTA;
+            char marco[PIPE_BUF];
+            int total = marco_codificar(marco, sizeof(marco), cab, nombre, cab.largo_nombre);
+            compartida_soltar(c);
+            // La ventana entra en el anillo: como el eco por FIFO, esperar si se llenó
+            for(int escritos = 0, n; escritos < total; escritos += n > 0 ? n : 0){
+                n = compartida_escribir(c, anillo, cab.agente, marco + escritos, total - escritos);
+                if(n == -1 && errno != EAGAIN) break;
+            }
+        }
+        compartida_esperar_peticiones(c);
+    }
+}
+
+// Ida y vuelta de a una (latencia) y con 'ventana' en vuelo (mensajes/s)
+static void medir_canal(const char* titulo, CanalPrueba* k, int mensajes, int ventana){
+    double* rtt = malloc(mensajes * sizeof(double));
+    for(int i=0; i<mensajes; i++){
+        double t0 = segundos_ahora();
+        canal_enviar(k, i + 1);
+        canal_recibir(k);
+        rtt[i] = (segundos_ahora() - t0) * 1e6;
+    }
+    qsort(rtt, mensajes, sizeof(double), comparar_double);
+
+    double t0 = segundos_ahora();
+    int enviadas = 0, recibidas = 0;
+    while(recibidas < mensajes){
+        while(enviadas < mensajes && enviadas - recibidas < ventana) canal_enviar(k, ++enviadas);
+        recibidas += canal_recibir(k);
+    }
+    double total = segundos_ahora() - t0;
+
+    printf("%-10s ida y vuelta p50=%6.1f us  p99=%6.1f us  |  ventana %d: %8.0f mensajes/s\n",
+           titulo, rtt[mensajes / 2], rtt[(int)(mensajes * 0.99)], ventana, mensajes / total);
+    free(rtt);
+
+    CabeceraMarco cierre = { .tipo = MSG_CIERRE, .agente = 1 };
+    if(k->compartida == NULL) marco_enviar(k->desc_envio, cierre, NULL, 0);
+    else compartida_enviar(k->compartida, cierre, NULL, 0);
+}
+
+static int prueba_transporte(int argc, char* argv[]){
+    int mensajes = argc > 2 ? atoi(argv[2]) : 100000;
+    int ventana = argc > 3 ? atoi(argv[3]) : 64;     // 64 marcos de ~33 bytes: no llena el FIFO
+    static CanalPrueba canal;
+
+    // FIFOs: uno de ida y uno de vuelta, como el pipe principal y pipe<ID>
+    char peticiones[64], respuestas[64];
+    snprintf(peticiones, sizeof(peticiones), "/tmp/benchmark_ida%d", getpid());
+    snprintf(respuestas, sizeof(respuestas), "/tmp/benchmark_vuelta%d", getpid());
+    mkfifo(peticiones, 0666);
+    mkfifo(respuestas, 0666);
+    pid_t hijo = fork();
+    if(hijo == 0) eco_fifo(peticiones, respuestas);
+    canal.desc_envio = open(peticiones, O_WRONLY);
+    canal.desc_recibo = open(respuestas, O_RDONLY);
+    canal.compartida = NULL;
+    decodificador_iniciar(&canal.entrada);
+    medir_canal("fifo", &canal, mensajes, ventana);
+    waitpid(hijo, NULL, 0);
+    close(canal.desc_envio);
+    close(canal.desc_recibo);
+    unlink(peticiones);
+    unlink(respuestas);
+
+    // Memoria compartida: anillo de peticiones + anillo de respuestas propio
+    char nombre[64];
+    snprintf(nombre, sizeof(nombre), "/benchmark_shm%d", getpid());
+    canal.compartida = compartida_crear(nombre);
+    if(canal.compartida == NULL){
+        perror("compartida_crear");
+        return 1;
+    }
+    canal.anillo = compartida_conectar(canal.compartida, 1);
+    decodificador_iniciar(&canal.entrada);
+    hijo = fork();
+    if(hijo == 0) eco_compartida(canal.compartida, canal.anillo);
+    medir_canal("shm", &canal, mensajes, ventana);
+    waitpid(hijo, NULL, 0);
+    compartida_destruir(canal.compartida, nombre);
+    return 0;
+}
+
+// ---- metricas ----
+
+// Solo las marcas que el controlador pone en cada solicitud (decodificar,
+// cerrojo sin competencia, admisión y respuesta), sin el trabajo que miden:
+// el trabajo real varía mucho más de una corrida a otra que lo que cuestan.
+// modo 0: hilo sin registrar; 1: muestreo, como el controlador; 2: medir todas.
+static double medir_instrumentacion(int solicitudes, int modo){
+    double t0 = segundos_ahora();
+    for(int i=0; i<solicitudes; i++){
+        if(modo == 2){
+            uint64_t antes = metricas_ahora();
+            metricas_anotar(ETAPA_DECODIFICAR, metricas_ahora() - antes);
+            antes = metricas_ahora();
+            metricas_anotar(ETAPA_CERROJO, 0);
+            uint64_t decidido = metricas_ahora();
+            metricas_anotar(ETAPA_ADMISION, decidido - antes);
+            metricas_anotar(ETAPA_RESPUESTA, metricas_ahora() - decidido);
+        } else {
+            // Un solo sorteo por solicitud (en el controlador cada etapa va en su hilo)
+            uint64_t decodificado = metricas_etapa(ETAPA_DECODIFICAR, metricas_medir());
+            metricas_anotar(ETAPA_CERROJO, 0);
+            metricas_etapa(ETAPA_RESPUESTA, metricas_etapa(ETAPA_ADMISION, decodificado));
+        }
+        __asm__ volatile("" ::: "memory");              // Que no se junten las iteraciones
+    }
+    return segundos_ahora() - t0;
+}
+
+static int prueba_metricas(int argc, char* argv[]){
+    int solicitudes = argc > 2 ? atoi(argv[2]) : 2000000;
+    double us_solicitud = argc > 3 ? atof(argv[3]) : 3.0;   // CPU del controlador por solicitud (make bench)
+    static Metricas metricas;
+    metricas_crear(&metricas, 5 * 2);                   // Un registro por ronda y modo medido
+
+    // Lo mejor de 5 rondas, alternando los modos
+    double mejor[3] = { 1e9, 1e9, 1e9 };
+    for(int ronda=0; ronda<5; ronda++){
+        for(int modo=0; modo<3; modo++){
+            metricas_hilo = NULL;
+            if(modo > 0) metricas_registrar(&metricas, "benchmark");
+            double t = medir_instrumentacion(solicitudes, modo);
+            if(t < mejor[modo]) mejor[modo] = t;
+        }
+    }
+    metricas_hilo = NULL;
+
+    const char* nombres[3] = { "sin registrar", "muestreo 1/32", "medir todas" };
+    printf("solicitudes=%d  referencia: %.2f us de CPU del controlador por solicitud\n", solicitudes, us_solicitud);
+    for(int modo=0; modo<3; modo++){
+        double ns = mejor[modo] / solicitudes * 1e9;
+        printf("%-14s %7.2f ns/solicitud (%5.2f %% de la solicitud)\n", nombres[modo], ns, ns / (us_solicitud * 10));
+    }
+    metricas_imprimir(&metricas, stdout);
+    metricas_destruir(&metricas);
+    return 0;
+}
+
+// ---- diario ----
+
+// Reservas de 1 a 8 personas en franjas al azar (la misma secuencia siempre).
+// Devuelve los segundos que tardó.
+static double reservar_al_azar(Agenda* ag, int reservas, int distintos){
+    char nombre[32];
+    srand(11);
+    double t0 = segundos_ahora();
+    for(int r=0; r<reservas; r++){
+        int largo = snprintf(nombre, sizeof(nombre), "Familia%d", rand() % distintos);
+        int hora = 7 + rand() % 10;
+        agenda_asignar(ag, hora, 0, 1 + rand() % 8, nombre, largo);
+    }
+    return segundos_ahora() - t0;
+}
+
+// 1 si las dos agendas tienen las mismas reservas y la misma ocupación
+static int agendas_iguales(Agenda* a, Agenda* b){
+    if(a->num_reservas != b->num_reservas || a->nombres.cantidad != b->nombres.cantidad) return 0;
+    for(int i=0; i<a->franjas; i++){
+        if(a->ingresos[i] != b->ingresos[i] || a->egresos[i] != b->egresos[i] ||
+           atomic_load(&a->ocupacion[i]) != atomic_load(&b->ocupacion[i]) ||
+           indice_libre(&a->indice, i) != indice_libre(&b->indice, i)){
+            return 0;
+        }
+    }
+    for(int k=0; k<a->num_reservas; k++){
+        Reserva* x = agenda_reserva(a, k);
+        Reserva* y = agenda_reserva(b, k);
+        if(x->inicio != y->inicio || x->personas != y->personas ||
+           nombres_largo(&a->nombres, x->nombre) != nombres_largo(&b->nombres, y->nombre) ||
+           memcmp(nombres_texto(&a->nombres, x->nombre), nombres_texto(&b->nombres, y->nombre),
+                  nombres_largo(&a->nombres, x->nombre)) != 0){
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int prueba_diario(int argc, char* argv[]){
+    int reservas = argc > 2 ? atoi(argv[2]) : 10000000;
+    int distintos = argc > 3 ? atoi(argv[3]) : 100000;
+    const char* prefijo = argc > 4 ? argv[4] : "/tmp/benchmark_diario";
+    // Día de 7 a 19 en franjas de 15 minutos, visitas de 2 horas; todo cabe
+    int franjas = 48, visita = 8, capacidad = 1 << 30;
+
+    // Lo mejor de 5 rondas, alternando sin y con diario. Con diario se mide
+    // hasta que la última tanda está en disco; la última ronda deja los
+    // archivos, como una caída justo después de esa tanda.
+    double sin_diario = 1e9, con_diario = 1e9;
+    Agenda original;
+    Diario diario;
+    Recuperacion rec;
+    for(int ronda=0; ronda<5; ronda++){
+        Agenda agenda;
+        agenda_crear(&agenda, 7, 15, franjas, capacidad, visita);
+        double t = reservar_al_azar(&agenda, reservas, distintos);
+        if(t < sin_diario) sin_diario = t;
+        agenda_destruir(&agenda);
+
+        agenda_crear(&original, 7, 15, franjas, capacidad, visita);
+        if(diario_abrir(&diario, prefijo, &original, &rec) == -1) return 1;
+        double t0 = segundos_ahora();
+        reservar_al_azar(&original, reservas, distintos);
+        diario_cerrar(&diario, ronda < 4);
+        t = segundos_ahora() - t0;
+        if(t < con_diario) con_diario = t;
+        if(ronda < 4) agenda_destruir(&original);
+    }
+
+    // Recuperación sobre una agenda vacía
+    Agenda recuperada;
+    agenda_crear(&recuperada, 7, 15, franjas, capacidad, visita);
+    double t0 = segundos_ahora();
+    if(diario_abrir(&diario, prefijo, &recuperada, &rec) == -1) return 1;
+    double apertura = segundos_ahora() - t0;
+    int iguales = agendas_iguales(&original, &recuperada);
+    diario_cerrar(&diario, 1);
+
+    printf("reservas=%d asignadas=%d nombres distintos=%d\n", reservas, original.num_reservas, distintos);
+    printf("sin diario:  %7.3f s  %7.1f ns/reserva\n", sin_diario, sin_diario / reservas * 1e9);
+    printf("con diario:  %7.3f s  %7.1f ns/reserva  (+%.1f %%)\n", con_diario, con_diario / reservas * 1e9,
+           (con_diario / sin_diario - 1) * 100);
+    printf("recuperación: %d de la instantánea + %ld del diario en %.3f s (%.3f s con la instantánea nueva)\n",
+           rec.reservas_instantanea, rec.registros_diario, rec.segundos, apertura);
+    printf("agenda recuperada %s\n", iguales ? "idéntica" : "DISTINTA");
+    agenda_destruir(&original);
+    agenda_destruir(&recuperada);
+    return iguales ? 0 : 1;
+}
+
+// 1 si el plan respeta el cupo de cada franja y ningún grupo entra antes de lo posible
+static int plan_factible(const ProblemaPlan* p, const SolucionPlan* s){
+    int ocupacion[p->franjas];
+    memset(ocupacion, 0, sizeof(ocupacion));
+    long grupos = 0, personas = 0;
+    for(int i=0; i<p->cantidad; i++){
+        int inicio = s->inicio[i];
+        if(inicio < 0) continue;
+        if(inicio < p->pedidos[i].desde || inicio + p->visita > p->franjas) return 0;
+        for(int f=inicio; f<inicio+p->visita; f++) ocupacion[f] += p->pedidos[i].personas;
+        grupos++;
+        personas += p->pedidos[i].personas;
+    }
+    for(int f=0; f<p->franjas; f++){
+        if(ocupacion[f] > p->capacidad) return 0;
+    }
+    return grupos == s->grupos && personas == s->personas;
+}
+
+static int prueba_plan(int argc, char* argv[]){
+    int solicitudes = argc > 2 ? atoi(argv[2]) : 20000;
+    int max_hilos = argc > 3 ? atoi(argv[3]) : 4;
+    long intentos = argc > 4 ? atol(argv[4]) : 20000;
+    // Día de 7 a 19 en franjas de 15 minutos, visitas de 2 horas. Demanda
+    // de unas 3 veces la capacidad, con horas al mediodía; 1 de cada 8
+    // grupos es grande (10 a 60 % de la capacidad) y el resto chico (hasta
+    // el 2 %), como un día de preventa con excursiones.
+    int franjas = 48, visita = 8, rondas = 16;
+    int capacidad = solicitudes * visita / franjas / 3 * 100 / 6;
+    if(capacidad < 100) capacidad = 100;
+
+    Agenda agenda;
+    ProblemaPlan problema;
+    agenda_crear(&agenda, 7, 15, franjas, capacidad, visita);
+    plan_crear(&problema, franjas, visita, capacidad, OBJETIVO_PERSONAS);
+    PedidoAgenda* pedidos = malloc(solicitudes * sizeof(PedidoAgenda));
+    srand(5);
+    for(int k=0; k<solicitudes; k++){
+        int hora = 7 + (rand() % 6 + rand() % 6);
+        int personas = (rand() % 8 == 0) ? capacidad / 10 + rand() % (capacidad / 2) : 1 + rand() % (capacidad / 50);
+        pedidos[k] = (PedidoAgenda){ hora, personas, "Plan", 4, -1 };
+        plan_agregar(&problema, (PedidoPlan){ agenda_franja_desde(&agenda, hora, 7), agenda_franja_pedida(&agenda, hora, 7),
+                                              personas });
+    }
+
+    // El voraz del plan tiene que dar lo mismo que la agenda en línea
+    SolucionPlan voraz;
+    solucion_crear(&voraz, &problema);
+    plan_voraz(&problema, &voraz);
+    agenda_asignar_lote(&agenda, pedidos, solicitudes, 7);
+    int iguales = 1;
+    for(int k=0; k<solicitudes; k++){
+        int esperado = pedidos[k].asignado < 0 ? -1 : (pedidos[k].asignado - 7 * 60) / 15;
+        if(esperado != voraz.inicio[k]) iguales = 0;
+    }
+    long cota = plan_cota(&problema);
+    printf("solicitudes=%d capacidad=%d franjas=%d visita=%d; voraz %s a la agenda en línea\n",
+           solicitudes, capacidad, franjas, visita, iguales ? "idéntico" : "DISTINTO");
+    printf("%-8s %10s %10s %12s %10s %9s\n", "hilos", "personas", "grupos", "confirmadas", "% cota", "segundos");
+    printf("%-8s %10ld %10ld %12ld %9.1f%% %9s\n", "voraz", voraz.personas, voraz.grupos, voraz.confirmadas,
+           100.0 * voraz.personas / cota, "-");
+
+    int factibles = 1;
+    for(int hilos=1; hilos<=max_hilos; hilos*=2){
+        SolucionPlan plan;
+        solucion_crear(&plan, &problema);
+        memcpy(plan.inicio, voraz.inicio, solicitudes * sizeof(int));
+        plan.grupos = voraz.grupos;
+        plan.personas = voraz.personas;
+        plan.confirmadas = voraz.confirmadas;
+        double t0 = segundos_ahora();
+        plan_mejorar(&problema, &plan, hilos, rondas, intentos, 1);
+        double t = segundos_ahora() - t0;
+        if(!plan_factible(&problema, &plan)) factibles = 0;
+        char etiqueta[16];
+        snprintf(etiqueta, sizeof(etiqueta), "%d", hilos);
+        printf("%-8s %10ld %10ld %12ld %9.1f%% %9.2f\n", etiqueta, plan.personas, plan.grupos, plan.confirmadas,
+               100.0 * plan.personas / cota, t);
+        solucion_destruir(&plan);
+    }
+    printf("cota superior: %ld personas; planes %s\n", cota, factibles ? "factibles" : "CON EXCESOS");
+
+    solucion_destruir(&voraz);
+    plan_destruir(&problema);
+    agenda_destruir(&agenda);
+    free(pedidos);
+    return iguales && factibles ? 0 : 1;
+}
+
+// ---- simd ----
+
+// Los bucles que usaban el informe, la búsqueda lineal y el índice antes
+// de Franjas.h, como referencia
+
+static void extremos_bucle(const int* v, int n, int* minimo, int* maximo){
+    int mayor = 0;
+    for(int i=0; i<n; i++){
+        if(v[i] > mayor) mayor = v[i];
+    }
+    int menor = mayor;
+    for(int i=0; i<n; i++){
+        if(v[i] < menor) menor = v[i];
+    }
+    *minimo = menor;
+    *maximo = mayor;
+}
+
+static int cupo_bucle(const int* libre, int desde, int largo, int personas){
+    for(int j=desde; j<desde+largo; j++){
+        if(libre[j] < personas) return 0;
+    }
+    return 1;
+}
+
+static long histograma_bucle(const int* v, int n, int capacidad, int cubetas, int cuenta[]){
+    long suma = 0;
+    for(int c=0; c<cubetas; c++) cuenta[c] = 0;
+    for(int i=0; i<n; i++){
+        long c = (long)v[i] * cubetas / capacidad;
+        cuenta[c < cubetas ? c : cubetas - 1]++;
+        suma += v[i];
+    }
+    return suma;
+}
+
+// Lo que hacía indice_sumar: sumar franja por franja y el mínimo de cada
+// ventana con una cola monótona. 'salida' recibe n - largo + 1 mínimos.
+static void reserva_bucle(int* libre, int desde, int largo, int delta, int primera, int n, int* cola, int* salida){
+    for(int i=desde; i<desde+largo; i++) libre[i] += delta;
+    int frente = 0, fondo = 0;
+    for(int q=primera; q<primera+n; q++){
+        while(fondo > frente && libre[cola[fondo-1]] >= libre[q]) fondo--;
+        cola[fondo++] = q;
+        int inicio = q - largo + 1;
+        if(inicio < primera) continue;
+        while(cola[frente] < inicio) frente++;
+        salida[inicio - primera] = libre[cola[frente]];
+    }
+}
+
+// Lo mismo con las operaciones de Franjas.h (como indice_sumar ahora)
+static void reserva_franjas(int* libre, int desde, int largo, int delta, int primera, int n, int* tramo, int* salida){
+    franjas_sumar(libre + desde, largo, delta);
+    memcpy(tramo, libre + primera, n * sizeof(int));
+    franjas_minimos(tramo, n, largo);
+    memcpy(salida, tramo, (n - largo + 1) * sizeof(int));
+}
+
+typedef struct {
+    int* ocupacion;               // Personas por franja (0 .. capacidad)
+    int* libre;                   // capacidad - ocupacion
+    int franjas, visita, capacidad;
+    int* inicios;                 // Ventanas al azar para cupo y reserva
+    int* pedidas;
+    int consultas;
+    int* trabajo;                 // 3 * visita
+    int* salida;
+} DatosSimd;
+
+// Informe: mínimo, máximo y franjas que los alcanzan
+static long correr_informe(DatosSimd* d, int con_franjas){
+    int minimo, maximo;
+    long suma = 0;
+    if(con_franjas){
+        franjas_extremos(d->ocupacion, d->franjas, &minimo, &maximo);
+        for(int i=franjas_siguiente(d->ocupacion, d->franjas, 0, maximo); i != -1;
+            i=franjas_siguiente(d->ocupacion, d->franjas, i + 1, maximo)) suma += i;
+        for(int i=franjas_siguiente(d->ocupacion, d->franjas, 0, minimo); i != -1;
+            i=franjas_siguiente(d->ocupacion, d->franjas, i + 1, minimo)) suma += i;
+    } else {
+        extremos_bucle(d->ocupacion, d->franjas, &minimo, &maximo);
+        for(int i=0; i<d->franjas; i++) if(d->ocupacion[i] == maximo) suma += i;
+        for(int i=0; i<d->franjas; i++) if(d->ocupacion[i] == minimo) suma += i;
+    }
+    return suma * 1000003L + minimo * 1009L + maximo;
+}
+
+static long correr_histograma(DatosSimd* d, int con_franjas){
+    int cuenta[4];
+    long suma = con_franjas ? franjas_histograma(d->ocupacion, d->franjas, d->capacidad, 4, cuenta)
+                            : histograma_bucle(d->ocupacion, d->franjas, d->capacidad, 4, cuenta);
+    return suma + cuenta[0] * 7L + cuenta[1] * 11L + cuenta[2] * 13L + cuenta[3] * 17L;
+}
+
+// ¿Cabe el grupo en la ventana? (la búsqueda lineal franja por franja)
+static long correr_cupo(DatosSimd* d, int con_franjas){
+    long caben = 0;
+    for(int k=0; k<d->consultas; k++){
+        caben += con_franjas ? franjas_cupo(d->libre, d->inicios[k], d->visita, d->pedidas[k])
+                             : cupo_bucle(d->libre, d->inicios[k], d->visita, d->pedidas[k]);
+    }
+    return caben;
+}
+
+// Reservar cada ventana y liberarla, recalculando el mínimo de las ventanas vecinas
+static long correr_reserva(DatosSimd* d, int con_franjas){
+    long suma = 0;
+    int L = d->visita;
+    for(int k=0; k<2*d->consultas; k++){
+        int desde = d->inicios[k / 2];
+        int delta = (k & 1) ? d->pedidas[k / 2] : -d->pedidas[k / 2];
+        int primera = desde - L + 1 < 0 ? 0 : desde - L + 1;
+        int ultima = desde + L - 1 > d->franjas - L ? d->franjas - L : desde + L - 1;
+        int n = ultima + L - primera;
+        if(con_franjas) reserva_franjas(d->libre, desde, L, delta, primera, n, d->trabajo, d->salida);
+        else reserva_bucle(d->libre, desde, L, delta, primera, n, d->trabajo, d->salida);
+        suma += d->salida[0] + d->salida[n - L];
+    }
+    return suma;
+}
+
+// Nanosegundos por llamada (lo mejor de 5) y el resultado para comparar
+static double medir_simd(long (*correr)(DatosSimd*, int), DatosSimd* d, int con_franjas, int llamadas, long* resultado){
+    double mejor = 1e9;
+    for(int r=0; r<5; r++){
+        double t0 = segundos_ahora();
+        *resultado = correr(d, con_franjas);
+        double t = segundos_ahora() - t0;
+        if(t < mejor) mejor = t;
+    }
+    return mejor * 1e9 / llamadas;
+}
+
+static int prueba_simd(int argc, char* argv[]){
+    int franjas = argc > 2 ? atoi(argv[2]) : 43200;       // 30 días en franjas de 1 minuto
+    int visita = argc > 3 ? atoi(argv[3]) : 120;          // Visita de 2 horas
+    if(franjas < 3 * visita || visita < 1){
+        printf("Hacen falta al menos 3 visitas de franjas\n");
+        return 1;
+    }
+
+    DatosSimd d = { .franjas = franjas, .visita = visita, .capacidad = 500, .consultas = 4096 };
+    d.ocupacion = malloc(franjas * sizeof(int));
+    d.libre = malloc(franjas * sizeof(int));
+    d.inicios = malloc(d.consultas * sizeof(int));
+    d.pedidas = malloc(d.consultas * sizeof(int));
+    d.trabajo = malloc(3 * visita * sizeof(int));
+    d.salida = malloc(3 * visita * sizeof(int));
+
+    // Ocupación alta y pareja (un día de temporada): casi todas las ventanas
+    // tienen cupo, así que comprobarlas recorre la visita entera
+    srand(42);
+    for(int i=0; i<franjas; i++){
+        d.ocupacion[i] = d.capacidad / 2 + rand() % (d.capacidad / 2);
+        d.libre[i] = d.capacidad - d.ocupacion[i];
+    }
+    for(int k=0; k<d.consultas; k++){
+        d.inicios[k] = rand() % (franjas - visita + 1);
+        d.pedidas[k] = 1 + rand() % 4;
+    }
+
+    struct {
+        const char* nombre;
+        long (*correr)(DatosSimd*, int);
+        int llamadas;
+    } pruebas[] = {
+        { "informe (min/max y franjas)", correr_informe, 1 },
+        { "histograma (4 niveles)", correr_histograma, 1 },
+        { "cupo de una ventana", correr_cupo, d.consultas },
+        { "reserva en el índice", correr_reserva, 2 * d.consultas },
+    };
+    NivelSimd maximo = franjas_forzar(SIMD_AVX2);
+
+    printf("franjas=%d visita=%d; nivel del procesador: %s (ns por llamada, lo mejor de 5)\n", franjas, visita,
+           franjas_nombre_nivel(maximo));
+    printf("%-28s %10s", "operación", "bucle");
+    for(int nivel=SIMD_ESCALAR; nivel<=(int)maximo; nivel++) printf(" %10s", franjas_nombre_nivel(nivel));
+    printf("  mejora\n");
+
+    int iguales = 1;
+    for(size_t p=0; p<sizeof(pruebas)/sizeof(pruebas[0]); p++){
+        long esperado, obtenido;
+        double bucle = medir_simd(pruebas[p].correr, &d, 0, pruebas[p].llamadas, &esperado);
+        printf("%-28s %10.1f", pruebas[p].nombre, bucle);
+        double mejor = bucle;
+        for(int nivel=SIMD_ESCALAR; nivel<=(int)maximo; nivel++){
+            franjas_forzar(nivel);
+            double t = medir_simd(pruebas[p].correr, &d, 1, pruebas[p].llamadas, &obtenido);
+            if(obtenido != esperado) iguales = 0;
+            if(t < mejor) mejor = t;
+            printf(" %10.1f", t);
+        }
+        printf("  x%.1f\n", bucle / mejor);
+    }
+    franjas_forzar(maximo);
+    printf("resultados %s\n", iguales ? "idénticos en todos los niveles" : "DISTINTOS");
+
+    free(d.ocupacion); free(d.libre); free(d.inicios); free(d.pedidas); free(d.trabajo); free(d.salida);
+    return iguales ? 0 : 1;
+}
+
+// ---- cache ----
+
+// Contadores de hardware del hilo que llama (perf_event_open). En máquinas
+// virtuales sin PMU no existen: se informa solo el tiempo.
+#define NUM_CONTADORES 3
+static const char* NOMBRES_CONTADORES[NUM_CONTADORES] = { "refs LLC", "fallos LLC", "fallos L1d" };
+static const uint64_t CONFIG_CONTADORES[NUM_CONTADORES][2] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+};
+
+typedef struct {
+    int descriptores[NUM_CONTADORES];   // -1 si ese contador no está
+    int disponibles;
+} Contadores;
+
+static void contadores_abrir(Contadores* c){
+    c->disponibles = 0;
+    for(int k=0; k<NUM_CONTADORES; k++){
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = CONFIG_CONTADORES[k][0];
+        attr.config = CONFIG_CONTADORES[k][1];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        c->descriptores[k] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if(c->descriptores[k] != -1) c->disponibles++;
+    }
+    if(c->disponibles == 0){
+        printf("contadores de hardware no disponibles (%s): solo tiempos\n", strerror(errno));
+    }
+}
+
+static void contadores_empezar(Contadores* c){
+    for(int k=0; k<NUM_CONTADORES; k++){
+        if(c->descriptores[k] == -1) continue;
+        ioctl(c->descriptores[k], PERF_EVENT_IOC_RESET, 0);
+        ioctl(c->descriptores[k], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+static void contadores_parar(Contadores* c, long valores[NUM_CONTADORES]){
+    for(int k=0; k<NUM_CONTADORES; k++){
+        uint64_t valor = 0;
+        if(c->descriptores[k] != -1){
+            ioctl(c->descriptores[k], PERF_EVENT_IOC_DISABLE, 0);
+            if(read(c->descriptores[k], &valor, sizeof(valor)) != sizeof(valor)) valor = 0;
+        }
+        valores[k] = c->descriptores[k] == -1 ? -1 : (long)valor;
+    }
+}
+
+static void contadores_cerrar(Contadores* c){
+    for(int k=0; k<NUM_CONTADORES; k++){
+        if(c->descriptores[k] != -1) close(c->descriptores[k]);
+    }
+}
+
+// Una fila: tiempo y contadores por operación
+static void imprimir_cache(const char* nombre, int dias, double segundos, long operaciones,
+                           const Contadores* c, const long valores[NUM_CONTADORES]){
+    printf("%-18s %4d %10.1f", nombre, dias, segundos / operaciones * 1e9);
+    for(int k=0; k<NUM_CONTADORES; k++){
+        if(c->disponibles == 0 || valores[k] < 0) printf(" %10s", "-");
+        else printf(" %10.2f", (double)valores[k] / operaciones);
+    }
+    printf("\n");
+}
+
+// Reservas al azar sobre todo el horizonte; si 'reloj', con un hilo que
+// informa franjas (toma el cerrojo) mientras tanto
+static void medir_cache_admision(Agenda* ag, int dias, int solicitudes, int reloj, Contadores* c){
+    HiloReloj informe = { ag, 0, 1, 0 };
+    pthread_t hilo_reloj;
+    if(reloj) pthread_create(&hilo_reloj, NULL, informar, &informe);
+
+    char nombre[32];
+    srand(13);
+    long valores[NUM_CONTADORES];
+    double t0 = segundos_ahora();
+    contadores_empezar(c);
+    for(int r=0; r<solicitudes; r++){
+        int largo = snprintf(nombre, sizeof(nombre), "Familia%d", rand() % 50000);
+        int hora = ag->apertura + rand() % (ag->franjas * ag->minutos / 60);
+        agenda_asignar(ag, hora, ag->apertura, 1 + rand() % 8, nombre, largo);
+    }
+    contadores_parar(c, valores);
+    double t = segundos_ahora() - t0;
+
+    if(reloj){
+        informe.activo = 0;
+        pthread_join(hilo_reloj, NULL);
+    }
+    imprimir_cache(reloj ? "admisión + reloj" : "admisión", dias, t, solicitudes, c, valores);
+}
+
+// Lo que hace el reloj por franja (instantánea de quienes entran y salen)
+// y el informe final (ocupación completa: extremos e histograma), por franja
+static void medir_cache_informe(Agenda* ag, int dias, int rondas, int informes, Contadores* c){
+    int* ocupacion = malloc(ag->franjas * sizeof(int));
+    long valores[NUM_CONTADORES], suma = 0;
+    double t0 = segundos_ahora();
+    contadores_empezar(c);
+    for(int r=0; r<rondas; r++){
+        for(int posicion=0; posicion<=ag->franjas; posicion++){
+            Instantanea inst;
+            if(agenda_instantanea(ag, posicion, &inst) == 0){
+                suma += inst.ingresos + inst.egresos;
+                instantanea_liberar(&inst);
+            }
+        }
+    }
+    contadores_parar(c, valores);
+    double t = segundos_ahora() - t0;
+    imprimir_cache("instantánea", dias, t, (long)rondas * (ag->franjas + 1), c, valores);
+
+    t0 = segundos_ahora();
+    contadores_empezar(c);
+    for(int r=0; r<informes; r++){
+        for(int i=0; i<ag->franjas; i++) ocupacion[i] = atomic_load_explicit(&ag->ocupacion[i], memory_order_relaxed);
+        int minimo, maximo;
+        int cuenta[4];
+        franjas_extremos(ocupacion, ag->franjas, &minimo, &maximo);
+        suma += maximo - minimo + franjas_histograma(ocupacion, ag->franjas, ag->capacidad, 4, cuenta);
+    }
+    contadores_parar(c, valores);
+    t = segundos_ahora() - t0;
+    imprimir_cache("informe ocupación", dias, t, (long)informes * ag->franjas, c, valores);
+    if(suma == 42) printf("\n");     // Que el compilador no descarte el trabajo
+    free(ocupacion);
+}
+
+static int prueba_cache(int argc, char* argv[]){
+    int solicitudes = argc > 2 ? atoi(argv[2]) : 1000000;
+    int minutos = argc > 3 ? atoi(argv[3]) : 15;
+    if(minutos <= 0 || 60 % minutos != 0){
+        printf("Los minutos por franja tienen que dividir a 60\n");
+        return 1;
+    }
+    // Días de 12 horas seguidos (de 7 a 19, de 19 a 7 del día siguiente...),
+    // visitas de 2 horas; cupo para más o menos la demanda
+    int visita = 120 / minutos;
+    Contadores c;
+    contadores_abrir(&c);
+    printf("solicitudes=%d franjas de %d min, visitas de %d franjas (por operación o por franja)\n",
+           solicitudes, minutos, visita);
+    printf("%-18s %4s %10s", "prueba", "días", "ns");
+    for(int k=0; k<NUM_CONTADORES; k++) printf(" %10s", NOMBRES_CONTADORES[k]);
+    printf("\n");
+
+    static const int DIAS[] = { 1, 7, 30 };
+    for(size_t d=0; d<sizeof(DIAS)/sizeof(DIAS[0]); d++){
+        int franjas = DIAS[d] * 12 * 60 / minutos;
+        int capacidad = (int)((long)solicitudes * 9 / 2 * visita / franjas) + 1;
+        for(int reloj=0; reloj<=1; reloj++){
+            Agenda agenda;
+            if(agenda_crear(&agenda, 7, minutos, franjas, capacidad, visita) == -1) return 1;
+            medir_cache_admision(&agenda, DIAS[d], solicitudes, reloj, &c);
+            if(reloj) medir_cache_informe(&agenda, DIAS[d], 3, 200000 * 48 / franjas + 1, &c);
+            agenda_destruir(&agenda);
+        }
+    }
+    contadores_cerrar(&c);
+    return 0;
+}
+
+int main(int argc, char* argv[]){
+    if(argc < 2){
+        printf("Uso: %s indice [franjas] [solicitudes] [visita]\n", argv[0]);
+        printf("     %s contencion [hilos] [solicitudes/hilo]\n", argv[0]);
+        printf("     %s memoria [reservas] [nombres distintos] [capacidad]\n", argv[0]);
+        printf("     %s reloj [horas] [seg/hora] [días virtuales]\n", argv[0]);
+        printf("     %s csv [líneas]\n", argv[0]);
+        printf("     %s transporte [mensajes] [ventana]\n", argv[0]);
+        printf("     %s metricas [solicitudes] [us/solicitud]\n", argv[0]);
+        printf("     %s diario [reservas] [nombres distintos] [prefijo]\n", argv[0]);
+        printf("     %s plan [solicitudes] [hilos] [intentos por hilo y ronda]\n", argv[0]);
+        printf("     %s simd [franjas] [visita]\n", argv[0]);
+        printf("     %s cache [solicitudes] [minutos por franja]\n", argv[0]);
+        return 1;
+    }
+    if(strcmp(argv[1], "indice") == 0) return prueba_indice(argc, argv);
+    if(strcmp(argv[1], "contencion") == 0) return prueba_contencion(argc, argv);
+    if(strcmp(argv[1], "memoria") == 0) return prueba_memoria(argc, argv);
+    if(strcmp(argv[1], "reloj") == 0) return prueba_reloj(argc, argv);
+    if(strcmp(argv[1], "csv") == 0) return prueba_csv(argc, argv);
+    if(strcmp(argv[1], "transporte") == 0) return prueba_transporte(argc, argv);
+    if(strcmp(argv[1], "metricas") == 0) return prueba_metricas(argc, argv);
+    if(strcmp(argv[1], "diario") == 0) return prueba_diario(argc, argv);
+    if(strcmp(argv[1], "plan") == 0) return prueba_plan(argc, argv);
+    if(strcmp(argv[1], "simd") == 0) return prueba_simd(argc, argv);
+    if(strcmp(argv[1], "cache") == 0) return prueba_cache(argc, argv);
+
+    printf("Prueba desconocida: %s\n", argv[1]);
+    return 1;
+}
@@ -0,0 +1,429 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/uio.h>
+#include "Bitacora.h"
+#include "Metricas.h"
+#include "Protocolo.h"
+
+#define TAM_TANDA 65536                   // Texto formateado por write()
+#define ESPERA_MINIMA_NS 1000000          // Pausa del escritor tras una tanda (1 ms)
+#define ESPERA_MAXIMA_NS 16000000         // Pausa máxima sin actividad (16 ms)
+#define PARTES_WRITEV 1024                // Registros por writev() en binario (IOV_MAX de Linux)
+
+_Static_assert((REGISTROS_BITACORA & (REGISTROS_BITACORA - 1)) == 0, "REGISTROS_BITACORA debe ser potencia de 2");
+
+// Cabecera del formato binario, antes del primer registro
+typedef struct {
+    char magia[4];                // "BTC1"
+    uint32_t tam_registro;        // sizeof(RegistroBitacora)
+} CabeceraBitacora;
+
+// Nivel mínimo y nombres JSON de cada evento (NULL: el evento es solo de formato de texto)
+typedef struct {
+    NivelBitacora nivel;
+    const char* nombre;
+    int con_agente;
+    const char* campos[4];        // Nombre de cada valor usado
+    const char* campo_texto;
+} DescripcionEvento;
+
+static const DescripcionEvento eventos[NUM_EVENTOS] = {
+    [EV_TIEMPO]          = { NIVEL_FRANJAS, "tiempo", 0, {"hora", "minuto"}, NULL },
+    [EV_INGRESOS]        = { NIVEL_FRANJAS, "ingresos", 0, {"personas"}, NULL },
+    [EV_SALIDAS]         = { NIVEL_FRANJAS, "salidas", 0, {"personas"}, NULL },
+    [EV_GRUPOS_INGRESAN] = { NIVEL_EVENTOS, NULL, 0, {NULL}, NULL },
+    [EV_GRUPO_INGRESA]   = { NIVEL_EVENTOS, "ingresa", 0, {NULL}, "grupo" },
+    [EV_GRUPOS_SALEN]    = { NIVEL_EVENTOS, NULL, 0, {NULL}, NULL },
+    [EV_GRUPO_SALE]      = { NIVEL_EVENTOS, "sale", 0, {NULL}, "grupo" },
+    [EV_FIN_FRANJA]      = { NIVEL_FRANJAS, NULL, 0, {NULL}, NULL },
+    [EV_PETICION]        = { NIVEL_EVENTOS, "peticion", 1, {"personas", "hora"}, "grupo" },
+    [EV_LOTE]            = { NIVEL_EVENTOS, "lote", 1, {"solicitudes", "confirmadas", "reprogramadas", "denegadas"}, NULL },
+    [EV_CIERRE]          = { NIVEL_EVENTOS, "cierre", 1, {"confirmadas", "reprogramadas", "denegadas"}, NULL },
+    [EV_RESPUESTA]       = { NIVEL_DETALLE, "respuesta", 1, {"resultado", "hora", "minuto"}, "grupo" },
+    [EV_PARQUE]          = { NIVEL_FRANJAS, "parque", 0, {"parque"}, NULL },
+};
+
+// Anillo y bitácora del hilo actual
+static _Thread_local AnilloBitacora* anillo_propio = NULL;
+static _Thread_local Bitacora* bitacora_propia = NULL;
+
+void bitacora_anotar(EventoBitacora evento, uint32_t agente, int v0, int v1, int v2, int v3,
+                     const char* texto, int largo){
+    AnilloBitacora* anillo = anillo_propio;
+    if(anillo == NULL || eventos[evento].nivel > bitacora_propia->nivel) return;
+
+    uint64_t escrito = atomic_load_explicit(&anillo->escrito, memory_order_relaxed);
+    uint64_t leido;
+    while(escrito - (leido = atomic_load_explicit(&anillo->leido, memory_order_acquire)) >= REGISTROS_BITACORA){
+        if(!anillo->esperar){
+            // Un solo escritor por anillo: no hace falta fetch_add
+            atomic_store_explicit(&anillo->perdidos,
+                                  atomic_load_explicit(&anillo->perdidos, memory_order_relaxed) + 1,
+                                  memory_order_relaxed);
+            return;
+        }
+        struct timespec pausa = { 0, 100000 };
+        nanosleep(&pausa, NULL);
+    }
+
+    RegistroBitacora* r = &anillo->registros[escrito & (REGISTROS_BITACORA - 1)];
+    r->tiempo = metricas_ahora();
+    r->evento = evento;
+    r->agente = agente;
+    r->valores[0] = v0;
+    r->valores[1] = v1;
+    r->valores[2] = v2;
+    r->valores[3] = v3;
+    if(texto == NULL || largo < 0) largo = 0;
+    if(largo > TEXTO_BITACORA) largo = TEXTO_BITACORA;
+    r->largo = largo;
+    memcpy(r->texto, texto, largo);
+    memset(r->texto + largo, 0, TEXTO_BITACORA - largo);   // El formato binario no arrastra restos
+
+    atomic_store_explicit(&anillo->escrito, escrito + 1, memory_order_release);
+
+    // Al llegar a la mitad, despertar al escritor sin esperar su pausa
+    if(escrito + 1 - leido == REGISTROS_BITACORA / 2){
+        Bitacora* b = bitacora_propia;
+        pthread_mutex_lock(&b->espera);
+        pthread_cond_signal(&b->hay_trabajo);
+        pthread_mutex_unlock(&b->espera);
+    }
+}
+
+// write() completo, reintentando si lo interrumpen
+static void escribir_todo(int fd, const char* datos, size_t largo){
+    while(largo > 0){
+        ssize_t n = write(fd, datos, largo);
+        if(n == -1){
+            if(errno == EINTR) continue;
+            return;                                     // Destino roto: se pierde la tanda
+        }
+        datos += n;
+        largo -= n;
+    }
+}
+
+// writev() completo: si escribe de a partes, sigue desde donde quedó
+static void escribir_vector(int fd, struct iovec* iov, int cantidad){
+    while(cantidad > 0){
+        ssize_t n = writev(fd, iov, cantidad);
+        if(n == -1){
+            if(errno == EINTR) continue;
+            return;
+        }
+        while(cantidad > 0 && (size_t)n >= iov->iov_len){
+            n -= iov->iov_len;
+            iov++;
+            cantidad--;
+        }
+        if(cantidad > 0){
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+}
+
+// Texto de siempre del evento
+static int formatear_texto(const RegistroBitacora* r, char* destino, int capacidad){
+    const int* v = r->valores;
+    char resultado[128];
+    switch(r->evento){
+        case EV_TIEMPO:
+            return snprintf(destino, capacidad, "\n========== TIEMPO: %d:%02d ==========\n", v[0], v[1]);
+        case EV_INGRESOS:
+            return snprintf(destino, capacidad, ">> Ingresos: %d personas acceden al parque\n", v[0]);
+        case EV_SALIDAS:
+            return snprintf(destino, capacidad, ">> Salidas: %d personas abandonan las instalaciones\n", v[0]);
+        case EV_GRUPOS_INGRESAN:
+            return snprintf(destino, capacidad, "-- Grupos que ingresan:\n");
+        case EV_GRUPO_INGRESA:
+            return snprintf(destino, capacidad, "   * Grupo %.*s (ingreso confirmado)\n", r->largo, r->texto);
+        case EV_GRUPOS_SALEN:
+            return snprintf(destino, capacidad, "-- Grupos que se retiran:\n");
+        case EV_GRUPO_SALE:
+            return snprintf(destino, capacidad, "   * Grupo %.*s (salida registrada)\n", r->largo, r->texto);
+        case EV_FIN_FRANJA:
+            return snprintf(destino, capacidad, "\n");
+        case EV_PETICION:
+            return snprintf(destino, capacidad,
+                            "[PETICION] Cliente %u solicita espacio para grupo %.*s (%d personas) - Hora deseada: %d:00\n",
+                            r->agente, r->largo, r->texto, v[0], v[1]);
+        case EV_LOTE:
+            return snprintf(destino, capacidad,
+                            "[LOTE] Cliente %u: %d solicitudes - %d confirmadas, %d reprogramadas, %d denegadas\n",
+                            r->agente, v[0], v[1], v[2], v[3]);
+        case EV_CIERRE:
+            return snprintf(destino, capacidad, "[CIERRE] Cliente %u: %d confirmadas, %d reprogramadas, %d denegadas\n",
+                            r->agente, v[0], v[1], v[2]);
+        case EV_RESPUESTA:
+            describir_resultado(v[0], v[1], v[2], resultado, sizeof(resultado));
+            return snprintf(destino, capacidad, "[RESPUESTA] Cliente %u, grupo %.*s: %s\n",
+                            r->agente, r->largo, r->texto, resultado);
+        case EV_PARQUE:
+            return snprintf(destino, capacidad, "--- Parque %d ---\n", v[0]);
+    }
+    return 0;
+}
+
+// Piezas del JSON sin snprintf: el escritor formatea cientos de miles por segundo.
+// Quien llama deja lugar de sobra (la tanda se vacía con menos de 1 KB libre).
+static char* agregar_texto(char* destino, const char* texto){
+    while(*texto) *destino++ = *texto++;
+    return destino;
+}
+
+static char* agregar_entero(char* destino, long long valor){
+    char cifras[24];
+    int n = 0;
+    unsigned long long resto = valor < 0 ? -(unsigned long long)valor : (unsigned long long)valor;
+    do {
+        cifras[n++] = '0' + resto % 10;
+        resto /= 10;
+    } while(resto > 0);
+    if(valor < 0) *destino++ = '-';
+    while(n > 0) *destino++ = cifras[--n];
+    return destino;
+}
+
+// ,"campo":
+static char* agregar_campo(char* destino, const char* campo){
+    destino = agregar_texto(destino, ",\"");
+    destino = agregar_texto(destino, campo);
+    return agregar_texto(destino, "\":");
+}
+
+// Un objeto JSON por línea con los campos del evento
+static int formatear_json(const RegistroBitacora* r, char* destino){
+    static const char hex[] = "0123456789abcdef";
+    const DescripcionEvento* e = &eventos[r->evento];
+    if(e->nombre == NULL) return 0;                     // Solo de formato
+
+    char* p = agregar_texto(destino, "{\"t_ns\":");
+    p = agregar_entero(p, (long long)r->tiempo);
+    p = agregar_texto(p, ",\"evento\":\"");
+    p = agregar_texto(p, e->nombre);
+    *p++ = '"';
+    if(e->con_agente){
+        p = agregar_campo(p, "agente");
+        p = agregar_entero(p, r->agente);
+    }
+    for(int i=0; i<4 && e->campos[i] != NULL; i++){
+        p = agregar_campo(p, e->campos[i]);
+        p = agregar_entero(p, r->valores[i]);
+    }
+    if(e->campo_texto != NULL){
+        p = agregar_campo(p, e->campo_texto);
+        *p++ = '"';
+        for(int i=0; i<r->largo; i++){
+            unsigned char c = r->texto[i];
+            if(c == '"' || c == '\\'){
+                *p++ = '\\';
+                *p++ = c;
+            } else if(c < 0x20){
+                p = agregar_texto(p, "\\u00");
+                *p++ = hex[c >> 4];
+                *p++ = hex[c & 15];
+            } else {
+                *p++ = c;
+            }
+        }
+        *p++ = '"';
+    }
+    *p++ = '}';
+    *p++ = '\n';
+    return p - destino;
+}
+
+// Junta lo publicado en todos los anillos en orden de tiempo y lo escribe.
+// Devuelve cuántos registros escribió.
+static uint64_t vaciar(Bitacora* b, char* tanda, struct iovec* vector){
+    int cantidad = atomic_load_explicit(&b->cantidad, memory_order_acquire);
+    uint64_t* desde = b->desde;
+    uint64_t* hasta = b->hasta;
+    for(int i=0; i<cantidad; i++){
+        desde[i] = atomic_load_explicit(&b->anillos[i]->leido, memory_order_relaxed);
+        hasta[i] = atomic_load_explicit(&b->anillos[i]->escrito, memory_order_acquire);
+    }
+
+    uint64_t total = 0;
+    int usados = 0, partes = 0;
+    while(1){
+        // El registro más antiguo entre las cabezas de los anillos
+        RegistroBitacora* siguiente = NULL;
+        int elegido = -1;
+        for(int i=0; i<cantidad; i++){
+            if(desde[i] == hasta[i]) continue;
+            RegistroBitacora* r = &b->anillos[i]->registros[desde[i] & (REGISTROS_BITACORA - 1)];
+            if(siguiente == NULL || r->tiempo < siguiente->tiempo){
+                siguiente = r;
+                elegido = i;
+            }
+        }
+        if(elegido == -1) break;
+        desde[elegido]++;
+        total++;
+
+        // Ticks -> ns desde el inicio (el registro es del escritor hasta liberarlo)
+        siguiente->tiempo = (uint64_t)((siguiente->tiempo - b->inicio) / b->ticks_por_ns);
+
+        if(b->formato == FORMATO_BINARIO){
+            // Sin copiar: writev directo desde los anillos
+            vector[partes++] = (struct iovec){ siguiente, sizeof(RegistroBitacora) };
+            if(partes == PARTES_WRITEV){
+                escribir_vector(b->descriptor, vector, partes);
+                partes = 0;
+            }
+            continue;
+        }
+        if(TAM_TANDA - usados < 1024){                  // Un registro formateado ocupa menos
+            escribir_todo(b->descriptor, tanda, usados);
+            usados = 0;
+        }
+        usados += (b->formato == FORMATO_JSON) ? formatear_json(siguiente, tanda + usados)
+                                               : formatear_texto(siguiente, tanda + usados, TAM_TANDA - usados);
+    }
+    if(partes > 0) escribir_vector(b->descriptor, vector, partes);
+    if(usados > 0) escribir_todo(b->descriptor, tanda, usados);
+
+    // Recién ahora se devuelven los lugares a los productores
+    for(int i=0; i<cantidad; i++){
+        atomic_store_explicit(&b->anillos[i]->leido, desde[i], memory_order_release);
+    }
+    return total;
+}
+
+static void* escribir(void* parametros){
+    Bitacora* b = (Bitacora*)parametros;
+    char* tanda = malloc(TAM_TANDA);
+    struct iovec* vector = malloc(PARTES_WRITEV * sizeof(struct iovec));
+    if(tanda == NULL || vector == NULL){
+        fprintf(stderr, "Sin memoria para el escritor de la bitácora\n");
+        exit(1);
+    }
+
+    // Tras una tanda espera poco; sin actividad, cada vez más (hasta 16 ms)
+    long espera = ESPERA_MINIMA_NS;
+    while(1){
+        int fin = atomic_load_explicit(&b->terminar, memory_order_acquire);
+        if(vaciar(b, tanda, vector) > 0){
+            espera = ESPERA_MINIMA_NS;
+        } else {
+            if(fin) break;                              // Ya no queda nada publicado antes del fin
+            espera = espera * 2 > ESPERA_MAXIMA_NS ? ESPERA_MAXIMA_NS : espera * 2;
+        }
+        struct timespec hasta;
+        clock_gettime(CLOCK_MONOTONIC, &hasta);
+        hasta.tv_nsec += espera;
+        if(hasta.tv_nsec >= 1000000000L){
+            hasta.tv_sec++;
+            hasta.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&b->espera);
+        pthread_cond_timedwait(&b->hay_trabajo, &b->espera, &hasta);
+        pthread_mutex_unlock(&b->espera);
+    }
+
+    free(tanda);
+    free(vector);
+    return NULL;
+}
+
+int bitacora_crear(Bitacora* b, int descriptor, FormatoBitacora formato, NivelBitacora nivel, double ticks_por_ns,
+                   int hilos){
+    b->maximo = hilos > 0 ? hilos : 0;
+    b->anillos = calloc(b->maximo > 0 ? b->maximo : 1, sizeof(AnilloBitacora*));
+    b->desde = malloc((b->maximo > 0 ? b->maximo : 1) * sizeof(uint64_t));
+    b->hasta = malloc((b->maximo > 0 ? b->maximo : 1) * sizeof(uint64_t));
+    if(b->anillos == NULL || b->desde == NULL || b->hasta == NULL){
+        free(b->anillos);
+        free(b->desde);
+        free(b->hasta);
+        return -1;
+    }
+    b->descriptor = descriptor;
+    b->formato = formato;
+    b->nivel = nivel;
+    b->ticks_por_ns = ticks_por_ns;
+    b->inicio = metricas_ahora();
+    atomic_init(&b->cantidad, 0);
+    atomic_init(&b->terminar, 0);
+    pthread_mutex_init(&b->bloqueo, NULL);
+    pthread_mutex_init(&b->espera, NULL);
+    pthread_condattr_t atributos;                       // Pausas con reloj monotónico
+    pthread_condattr_init(&atributos);
+    pthread_condattr_setclock(&atributos, CLOCK_MONOTONIC);
+    pthread_cond_init(&b->hay_trabajo, &atributos);
+    pthread_condattr_destroy(&atributos);
+
+    fflush(stdout);                                     // Lo que ya estaba en el buffer de stdio va primero
+    if(formato == FORMATO_BINARIO){
+        CabeceraBitacora cabecera = { {'B', 'T', 'C', '1'}, sizeof(RegistroBitacora) };
+        escribir_todo(descriptor, (const char*)&cabecera, sizeof(cabecera));
+    }
+
+    if(pthread_create(&b->escritor, NULL, escribir, b) != 0){
+        free(b->anillos);
+        free(b->desde);
+        free(b->hasta);
+        pthread_mutex_destroy(&b->bloqueo);
+        pthread_mutex_destroy(&b->espera);
+        pthread_cond_destroy(&b->hay_trabajo);
+        return -1;
+    }
+    return 0;
+}
+
+int bitacora_registrar(Bitacora* b, int esperar){
+    AnilloBitacora* anillo = aligned_alloc(64, sizeof(AnilloBitacora));
+    if(anillo == NULL) return -1;
+    atomic_init(&anillo->escrito, 0);
+    atomic_init(&anillo->leido, 0);
+    atomic_init(&anillo->perdidos, 0);
+    anillo->esperar = esperar;
+
+    pthread_mutex_lock(&b->bloqueo);
+    int cantidad = atomic_load_explicit(&b->cantidad, memory_order_relaxed);
+    if(cantidad == b->maximo){
+        pthread_mutex_unlock(&b->bloqueo);
+        free(anillo);
+        return -1;
+    }
+    b->anillos[cantidad] = anillo;
+    atomic_store_explicit(&b->cantidad, cantidad + 1, memory_order_release);  // Publicar ya armado
+    pthread_mutex_unlock(&b->bloqueo);
+
+    anillo_propio = anillo;
+    bitacora_propia = b;
+    return 0;
+}
+
+void bitacora_terminar(Bitacora* b){
+    atomic_store_explicit(&b->terminar, 1, memory_order_release);
+    pthread_mutex_lock(&b->espera);
+    pthread_cond_signal(&b->hay_trabajo);
+    pthread_mutex_unlock(&b->espera);
+    pthread_join(b->escritor, NULL);
+
+    uint64_t perdidos = 0;
+    int cantidad = atomic_load(&b->cantidad);
+    for(int i=0; i<cantidad; i++){
+        perdidos += atomic_load(&b->anillos[i]->perdidos);
+        free(b->anillos[i]);
+    }
+    if(perdidos > 0){
+        fprintf(stderr, "Bitácora: %llu registros descartados (salida más lenta que las solicitudes)\n",
+                (unsigned long long)perdidos);
+    }
+    free(b->anillos);
+    free(b->desde);
+    free(b->hasta);
+    b->anillos = NULL;
+    pthread_mutex_destroy(&b->bloqueo);
+    pthread_mutex_destroy(&b->espera);
+    pthread_cond_destroy(&b->hay_trabajo);
+}
@@ -0,0 +1,109 @@
+#ifndef BITACORA_H
+#define BITACORA_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// Bitácora asíncrona del controlador. Quien atiende solicitudes no formatea
+// ni escribe: copia los datos del evento a un anillo propio (un productor,
+// un consumidor, sin cerrojos) y sigue. Un hilo escritor junta lo de todos
+// los anillos en orden de tiempo, lo formatea y lo escribe en tandas.
+//  - Formatos: texto (las mismas líneas de siempre), JSON (un objeto por
+//    línea) o binario (los RegistroBitacora tal cual, tras una cabecera).
+//  - Nivel: cada evento tiene uno; se descartan en el acto los de nivel
+//    mayor al elegido.
+//  - El escritor despierta cada 1-16 ms, o antes si algún anillo llega a
+//    la mitad (única vez que un productor hace una llamada al sistema).
+//  - Si el anillo de un trabajador se llena (salida lenta), el registro se
+//    descarta y se cuenta: la bitácora nunca frena las reservas. El hilo
+//    del reloj, en cambio, espera lugar para no perder los informes.
+
+typedef enum {
+    FORMATO_TEXTO = 0,
+    FORMATO_JSON,
+    FORMATO_BINARIO
+} FormatoBitacora;
+
+typedef enum {
+    NIVEL_NADA = 0,               // Solo el informe final
+    NIVEL_FRANJAS,                // Hora y movimiento de personas por franja
+    NIVEL_EVENTOS,                // + peticiones, lotes, cierres y grupos (por defecto)
+    NIVEL_DETALLE                 // + la respuesta a cada solicitud
+} NivelBitacora;
+
+typedef enum {
+    EV_TIEMPO = 0,                // hora, minuto
+    EV_INGRESOS,                  // personas
+    EV_SALIDAS,                   // personas
+    EV_GRUPOS_INGRESAN,           // Encabezado de la lista (solo texto)
+    EV_GRUPO_INGRESA,             // texto = grupo
+    EV_GRUPOS_SALEN,              // Encabezado de la lista (solo texto)
+    EV_GRUPO_SALE,                // texto = grupo
+    EV_FIN_FRANJA,                // Línea en blanco (solo texto)
+    EV_PETICION,                  // agente; personas, hora; texto = grupo
+    EV_LOTE,                      // agente; solicitudes, confirmadas, reprogramadas, denegadas
+    EV_CIERRE,                    // agente; confirmadas, reprogramadas, denegadas
+    EV_RESPUESTA,                 // agente; resultado, hora, minuto; texto = grupo
+    EV_PARQUE,                    // parque: lo que sigue de la franja es de ese parque (si hay varios)
+    NUM_EVENTOS
+} EventoBitacora;
+
+#define TEXTO_BITACORA 96         // Nombres más largos se recortan
+#define REGISTROS_BITACORA 8192   // Por hilo (potencia de 2): 1 MB
+
+// Registro de tamaño fijo; en formato binario se escribe tal cual
+typedef struct {
+    uint64_t tiempo;              // Ticks al anotar; al escribir, ns desde el inicio
+    uint16_t evento;
+    uint16_t largo;               // Bytes válidos en 'texto'
+    uint32_t agente;
+    int32_t valores[4];
+    char texto[TEXTO_BITACORA];
+} RegistroBitacora;
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t escrito;   // Registros publicados (productor)
+    _Atomic uint64_t perdidos;               // Descartados por anillo lleno
+    int esperar;                             // 1: esperar lugar en vez de descartar
+    _Alignas(64) _Atomic uint64_t leido;     // Registros consumidos (escritor)
+    RegistroBitacora registros[REGISTROS_BITACORA];
+} AnilloBitacora;
+
+typedef struct {
+    int descriptor;               // Destino (stdout o el archivo de -o)
+    FormatoBitacora formato;
+    NivelBitacora nivel;
+    double ticks_por_ns;
+    uint64_t inicio;              // Ticks al crear la bitácora
+    pthread_mutex_t bloqueo;      // Solo para registrar hilos
+    AnilloBitacora** anillos;     // Uno por hilo registrado (lugar para 'maximo')
+    int maximo;
+    uint64_t* desde;              // Del escritor: posición de cada anillo al vaciar
+    uint64_t* hasta;
+    _Atomic int cantidad;
+    _Atomic int terminar;
+    pthread_mutex_t espera;       // El escritor duerme en 'hay_trabajo'
+    pthread_cond_t hay_trabajo;
+    pthread_t escritor;
+} Bitacora;
+
+// Arranca el hilo escritor, con lugar para los anillos de 'hilos' hilos.
+// 0 si ok, -1 sin memoria o si no se pudo crear.
+int bitacora_crear(Bitacora* b, int descriptor, FormatoBitacora formato, NivelBitacora nivel, double ticks_por_ns,
+                   int hilos);
+
+// Escribe lo pendiente, detiene al escritor y avisa por stderr si hubo descartes
+void bitacora_terminar(Bitacora* b);
+
+// Da un anillo al hilo que llama. 'esperar': si se llena, esperar en vez de
+// descartar. 0 si ok, -1 sin memoria o si ya se registraron los 'hilos' de
+// bitacora_crear (el hilo no anotará nada).
+int bitacora_registrar(Bitacora* b, int esperar);
+
+// Anota un evento del hilo actual (nada si el nivel no lo incluye o el hilo
+// no se registró). 'texto' puede ser NULL.
+void bitacora_anotar(EventoBitacora evento, uint32_t agente, int v0, int v1, int v2, int v3,
+                     const char* texto, int largo);
+
+#endif
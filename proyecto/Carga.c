@@ -0,0 +1,475 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include "Protocolo.h"
+#include "Compartida.h"
+#include "Traza.h"
+
+// Generador de carga para un controlador en marcha.
+// Lanza K agentes simulados (un hilo cada uno, con su propio ID y su propio
+// FIFO o anillo de respuestas). Cada uno manda N solicitudes sintéticas con
+// hasta 'ventana' en vuelo, y mide la latencia de admisión: desde que la
+// solicitud sale hasta que llega su respuesta. Al final informa throughput,
+// percentiles de latencia y CPU por solicitud (la del controlador con -c).
+//
+// Uso: ./carga -p <pipe> [-x fifo|shm] [-k agentes] [-n solicitudes/agente]
+//              [-w ventana] [-b lote] [-y uniforme|pico] [-g min-max | -g geo:media]
+//              [-c pid del controlador] [-s semilla] [-P parques]
+//        ./carga -T <traza> [mismas opciones de solicitudes]
+// Con -P N cada marco va a uno de los parques 0..N-1, rotando por agente.
+// Con -T no se conecta: escribe los mismos marcos como traza sintética para
+// ./repeticion, los agentes por turnos y las llegadas parejas de 7:00 a 19:00.
+
+#define ID_BASE 100000                // IDs de los agentes simulados (no chocan con los de prueba)
+
+// Parámetros de la corrida
+typedef struct {
+    char* tubo;
+    int compartida;               // 1: memoria compartida
+    int agentes, solicitudes, ventana, lote;
+    int parques;                  // Marcos repartidos entre los parques 0..parques-1
+    int pico;                     // Horas: 0 uniforme 7..18, 1 concentradas al mediodía
+    int grupo_min, grupo_max;     // Tamaño de grupo uniforme en [min, max]
+    double grupo_media;           // > 0: tamaño geométrico con esta media
+    unsigned semilla;
+    Compartida* segmento;
+} Config;
+
+// Estado y resultados de un agente simulado
+typedef struct {
+    Config* cfg;
+    uint32_t id;
+    pthread_t hilo;
+    int desc_envio, desc_recibo, anillo;
+    char tubo_respuesta[64];
+    double* enviada_en;           // Instante de envío por secuencia (1..n)
+    double* latencias;            // En microsegundos, en orden de llegada
+    int respondidas;
+    int resultados[3];            // Confirmadas / Reprogramadas / Denegadas
+    int error;
+} Simulado;
+
+static double segundos_ahora(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static int comparar_double(const void* a, const void* b){
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Hora pedida: uniforme en 7..18, o triangular centrada en las 12/13 (pico)
+static int hora_sintetica(Config* cfg, unsigned* semilla){
+    if(!cfg->pico) return 7 + rand_r(semilla) % 12;
+    return 7 + (rand_r(semilla) % 6 + rand_r(semilla) % 7);
+}
+
+static int grupo_sintetico(Config* cfg, unsigned* semilla){
+    if(cfg->grupo_media > 0){
+        // Geométrica: cantidad de intentos hasta el primer éxito con p = 1/media
+        int personas = 1;
+        while(personas < 1000 && rand_r(semilla) > RAND_MAX / cfg->grupo_media) personas++;
+        return personas;
+    }
+    return cfg->grupo_min + rand_r(semilla) % (cfg->grupo_max - cfg->grupo_min + 1);
+}
+
+// Arma el marco número 'marco' del agente 'id' con hasta 'cantidad'
+// solicitudes desde la 'enviadas' + 1 (una: MSG_SOLICITUD; más: MSG_LOTE,
+// hasta donde entren). Devuelve cuántas entraron; los datos del marco
+// quedan en *datos y *largo.
+static int armar_marco(Config* cfg, uint32_t id, unsigned* semilla, int enviadas, int cantidad, unsigned marco,
+                       CabeceraMarco* cab, char* carga, char nombres[][32], const char** datos, int* largo){
+    *cab = (CabeceraMarco){ .agente = id, .secuencia = enviadas + 1, .parque = (id + marco) % cfg->parques };
+    int usados = 0, largo_nombre = 0;
+    for(int k=0; k<cantidad; k++){
+        largo_nombre = snprintf(nombres[k], 32, "Carga%u_%d", id, enviadas + k + 1);
+        SolicitudLote solicitud = { .secuencia = enviadas + k + 1, .hora = hora_sintetica(cfg, semilla),
+                                    .personas = grupo_sintetico(cfg, semilla), .largo_nombre = largo_nombre };
+        if(cantidad == 1){
+            cab->tipo = MSG_SOLICITUD;
+            cab->hora = solicitud.hora;
+            cab->personas = solicitud.personas;
+        } else if(lote_agregar(carga, &usados, solicitud, nombres[k]) == -1){
+            cantidad = k;                       // No entra más en el marco
+            break;
+        }
+    }
+    if(cantidad > 1){
+        cab->tipo = MSG_LOTE;
+        cab->personas = cantidad;
+        *datos = carga;
+        *largo = usados;
+    } else {
+        *datos = nombres[0];
+        *largo = largo_nombre;
+    }
+    return cantidad;
+}
+
+static int enviar(Simulado* s, CabeceraMarco cab, const char* datos, int largo){
+    if(s->cfg->compartida) return compartida_enviar(s->cfg->segmento, cab, datos, largo);
+    return marco_enviar(s->desc_envio, cab, datos, largo);
+}
+
+static ssize_t leer(Simulado* s, Decodificador* entrada){
+    if(s->cfg->compartida) return compartida_leer(s->cfg->segmento, s->anillo, entrada);
+    return decodificador_leer(entrada, s->desc_recibo);
+}
+
+// Duerme hasta que haya respuestas (o, si 'enviar', lugar para enviar)
+static void esperar(Simulado* s, int enviar){
+    if(s->cfg->compartida){
+        compartida_esperar_respuestas(s->cfg->segmento, s->anillo, enviar ? 1 : 100);
+        return;
+    }
+    struct pollfd espera[2] = { { s->desc_recibo, POLLIN, 0 }, { s->desc_envio, POLLOUT, 0 } };
+    poll(espera, enviar ? 2 : 1, 100);
+}
+
+static void anotar(Simulado* s, uint32_t secuencia, int resultado, double ahora){
+    if(secuencia == 0 || secuencia > (uint32_t)s->cfg->solicitudes || s->enviada_en[secuencia] == 0) return;
+    s->latencias[s->respondidas++] = (ahora - s->enviada_en[secuencia]) * 1e6;
+    s->enviada_en[secuencia] = 0;
+    s->resultados[resultado == RES_CONFIRMADO ? 0 :
+                  (resultado == RES_REPROGRAMADO || resultado == RES_REPROGRAMADO_EXTEMPORANEO) ? 1 : 2]++;
+}
+
+// Procesa las respuestas disponibles. -1 si el controlador terminó.
+static int recibir(Simulado* s, Decodificador* entrada){
+    CabeceraMarco cab;
+    const char* datos;
+    while(1){
+        ssize_t leidos = leer(s, entrada);
+        double ahora = segundos_ahora();
+        while(decodificador_siguiente(entrada, &cab, &datos) == 1){
+            if(cab.tipo == MSG_FIN) return -1;
+            if(cab.tipo == MSG_RESPUESTA){
+                anotar(s, cab.secuencia, cab.resultado, ahora);
+            } else if(cab.tipo == MSG_RESPUESTA_LOTE){
+                for(int k=0; k<cab.largo_nombre / (int)sizeof(ResultadoLote); k++){
+                    ResultadoLote r;
+                    memcpy(&r, datos + k * sizeof(ResultadoLote), sizeof(r));
+                    anotar(s, r.secuencia, r.resultado, ahora);
+                }
+            }
+        }
+        if(leidos == 0) return -1;
+        if(leidos == -1) return 0;
+    }
+}
+
+// Registro: FIFO privado o anillo propio, y espera de la hora del sistema
+static int conectar(Simulado* s, Decodificador* entrada){
+    Config* cfg = s->cfg;
+    char destino[64];
+    if(cfg->compartida){
+        s->anillo = compartida_conectar(cfg->segmento, s->id);
+        if(s->anillo == -1) return -1;
+        snprintf(destino, sizeof(destino), "%d", s->anillo);
+    } else {
+        snprintf(s->tubo_respuesta, sizeof(s->tubo_respuesta), "/tmp/carga%d_%u", getpid(), s->id);
+        unlink(s->tubo_respuesta);
+        if(mkfifo(s->tubo_respuesta, 0666) == -1) return -1;
+        s->desc_recibo = open(s->tubo_respuesta, O_RDONLY | O_NONBLOCK);
+        s->desc_envio = open(cfg->tubo, O_WRONLY | O_NONBLOCK);
+        if(s->desc_recibo == -1 || s->desc_envio == -1) return -1;
+        snprintf(destino, sizeof(destino), "%s", s->tubo_respuesta);
+    }
+
+    CabeceraMarco registro = { .tipo = MSG_REGISTRO, .agente = s->id };
+    while(enviar(s, registro, destino, strlen(destino)) == -1){
+        if(errno != EAGAIN) return -1;
+        esperar(s, 1);
+    }
+
+    // La hora del sistema confirma que el controlador nos registró
+    CabeceraMarco cab;
+    const char* datos;
+    double limite = segundos_ahora() + 5;
+    while(segundos_ahora() < limite){
+        leer(s, entrada);
+        if(decodificador_siguiente(entrada, &cab, &datos) == 1 && cab.tipo == MSG_HORA) return 0;
+        esperar(s, 0);
+    }
+    errno = ETIMEDOUT;
+    return -1;
+}
+
+static void desconectar(Simulado* s){
+    CabeceraMarco cierre = { .tipo = MSG_CIERRE, .agente = s->id };
+    enviar(s, cierre, NULL, 0);
+    if(s->cfg->compartida){
+        compartida_desconectar(s->cfg->segmento, s->anillo);
+        return;
+    }
+    close(s->desc_envio);
+    close(s->desc_recibo);
+    unlink(s->tubo_respuesta);
+}
+
+static void* simular_agente(void* parametros){
+    Simulado* s = parametros;
+    Config* cfg = s->cfg;
+    Decodificador* entrada = malloc(sizeof(Decodificador));
+    unsigned semilla = cfg->semilla + s->id;
+    decodificador_iniciar(entrada);
+
+    if(conectar(s, entrada) == -1){
+        perror("Agente simulado: no se pudo registrar");
+        s->error = 1;
+        free(entrada);
+        return NULL;
+    }
+
+    char carga[MAX_CARGA];
+    char nombres[MAX_LOTE][32];
+    int enviadas = 0, terminado = 0;
+    unsigned marcos = 0;
+    while(!terminado){
+        // Armar y mandar mientras haya lugar en la ventana
+        while(enviadas < cfg->solicitudes && enviadas - s->respondidas < cfg->ventana){
+            int cantidad = cfg->lote;
+            if(cantidad > cfg->solicitudes - enviadas) cantidad = cfg->solicitudes - enviadas;
+            if(cantidad > cfg->ventana - (enviadas - s->respondidas)) cantidad = cfg->ventana - (enviadas - s->respondidas);
+
+            CabeceraMarco cab;
+            const char* datos;
+            int largo;
+            cantidad = armar_marco(cfg, s->id, &semilla, enviadas, cantidad, marcos++, &cab, carga, nombres, &datos, &largo);
+
+            double ahora = segundos_ahora();
+            int estado = enviar(s, cab, datos, largo);
+            if(estado == -1){
+                if(errno != EAGAIN) terminado = 1;
+                break;                                  // Sin lugar: esperar y volver a armar
+            }
+            for(int k=1; k<=cantidad; k++) s->enviada_en[enviadas + k] = ahora;
+            enviadas += cantidad;
+        }
+        if(terminado || (enviadas == cfg->solicitudes && s->respondidas == enviadas)) break;
+
+        esperar(s, enviadas < cfg->solicitudes && enviadas - s->respondidas < cfg->ventana);
+        if(recibir(s, entrada) == -1) terminado = 1;
+    }
+
+    desconectar(s);
+    free(entrada);
+    return NULL;
+}
+
+// Modo -T: los marcos que mandarían los agentes, como traza sintética. Cada
+// agente arma sus marcos igual que simular_agente (misma semilla), sin
+// ventana: se registran a las 7:00, mandan por turnos con las llegadas
+// repartidas parejas hasta las 19:00 y se despiden al final.
+static int grabar_traza(Config* cfg, const char* ruta){
+    Traza traza;
+    if(traza_crear(&traza, ruta, 0) == -1){
+        perror("Error al crear la traza");
+        return 1;
+    }
+    const int64_t apertura = 7 * 3600000LL, duracion = 12 * 3600000LL;
+    long por_agente = (cfg->solicitudes + cfg->lote - 1) / cfg->lote;
+    long total = por_agente * cfg->agentes, numero = 0;
+
+    unsigned* semillas = malloc(cfg->agentes * sizeof(unsigned));
+    int* enviadas = calloc(cfg->agentes, sizeof(int));
+    if(semillas == NULL || enviadas == NULL){
+        printf("Error: Sin memoria para %d agentes simulados.\n", cfg->agentes);
+        return 1;
+    }
+    for(int i=0; i<cfg->agentes; i++){
+        CabeceraMarco registro = { .tipo = MSG_REGISTRO, .agente = ID_BASE + i };
+        traza_anotar(&traza, apertura, registro, "traza", 5);
+        semillas[i] = cfg->semilla + ID_BASE + i;
+    }
+
+    char carga[MAX_CARGA];
+    char nombres[MAX_LOTE][32];
+    for(unsigned marco=0, quedan=1; quedan; marco++){
+        quedan = 0;
+        for(int i=0; i<cfg->agentes; i++){
+            if(enviadas[i] == cfg->solicitudes) continue;
+            int cantidad = cfg->lote;
+            if(cantidad > cfg->solicitudes - enviadas[i]) cantidad = cfg->solicitudes - enviadas[i];
+
+            CabeceraMarco cab;
+            const char* datos;
+            int largo;
+            enviadas[i] += armar_marco(cfg, ID_BASE + i, &semillas[i], enviadas[i], cantidad, marco, &cab, carga,
+                                       nombres, &datos, &largo);
+            int64_t ms = apertura + duracion * (numero < total ? numero : total - 1) / total;
+            traza_anotar(&traza, ms, cab, datos, largo);
+            numero++;
+            quedan = 1;
+        }
+    }
+    for(int i=0; i<cfg->agentes; i++){
+        CabeceraMarco cierre = { .tipo = MSG_CIERRE, .agente = ID_BASE + i };
+        traza_anotar(&traza, apertura + duracion - 1, cierre, NULL, 0);
+    }
+    traza_cerrar(&traza);
+    printf("Traza %s: %d agentes, %ld solicitudes en %ld marcos\n", ruta, cfg->agentes,
+           (long)cfg->agentes * cfg->solicitudes, numero);
+    free(semillas);
+    free(enviadas);
+    return 0;
+}
+
+// CPU (usuario + sistema) de un proceso, en segundos
+static double cpu_proceso(int pid){
+    char ruta[64];
+    snprintf(ruta, sizeof(ruta), "/proc/%d/stat", pid);
+    FILE* archivo = fopen(ruta, "r");
+    if(archivo == NULL) return -1;
+
+    // Campos 14 y 15 (utime, stime), después del nombre entre paréntesis
+    char linea[1024];
+    double total = -1;
+    if(fgets(linea, sizeof(linea), archivo)){
+        char* resto = strrchr(linea, ')');
+        unsigned long usuario, sistema;
+        if(resto && sscanf(resto + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &usuario, &sistema) == 2){
+            total = (double)(usuario + sistema) / sysconf(_SC_CLK_TCK);
+        }
+    }
+    fclose(archivo);
+    return total;
+}
+
+static double cpu_propia(){
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_utime.tv_sec + uso.ru_utime.tv_usec / 1e6 + uso.ru_stime.tv_sec + uso.ru_stime.tv_usec / 1e6;
+}
+
+int main(int argc, char* argv[]){
+    Config cfg = { .tubo = NULL, .agentes = 4, .solicitudes = 10000, .ventana = 32, .lote = 1, .parques = 1,
+                   .grupo_min = 1, .grupo_max = 10, .semilla = 1 };
+    char* transporte = "fifo";
+    char* horas = "uniforme";
+    int controlador = 0;          // PID para medir su CPU (0: no se mide)
+    char* traza = NULL;           // -T: escribir una traza en vez de conectarse
+
+    for(int i=1; i+1<argc; i++){
+        if(*argv[i] == '-'){
+            switch (*(argv[i++]+1)) {
+                case 'p': cfg.tubo = argv[i]; break;                  // FIFO principal del controlador
+                case 'x': transporte = argv[i]; break;                // Transporte: fifo o shm
+                case 'k': cfg.agentes = atoi(argv[i]); break;         // Agentes simulados
+                case 'n': cfg.solicitudes = atoi(argv[i]); break;     // Solicitudes por agente
+                case 'w': cfg.ventana = atoi(argv[i]); break;         // Solicitudes en vuelo por agente
+                case 'b': cfg.lote = atoi(argv[i]); break;            // Solicitudes por marco
+                case 'y': horas = argv[i]; break;                     // Distribución de horas
+                case 'c': controlador = atoi(argv[i]); break;         // PID del controlador
+                case 's': cfg.semilla = atoi(argv[i]); break;         // Semilla
+                case 'P': cfg.parques = atoi(argv[i]); break;         // Parques entre los que repartir
+                case 'T': traza = argv[i]; break;                     // Traza sintética para ./repeticion
+                case 'g':                                             // Tamaño de grupo
+                    if(strncmp(argv[i], "geo:", 4) == 0) cfg.grupo_media = atof(argv[i] + 4);
+                    else sscanf(argv[i], "%d-%d", &cfg.grupo_min, &cfg.grupo_max);
+                    break;
+            }
+        }
+    }
+    cfg.compartida = strcmp(transporte, "shm") == 0;
+    cfg.pico = strcmp(horas, "pico") == 0;
+    if((cfg.tubo == NULL && traza == NULL) || cfg.agentes <= 0 || cfg.solicitudes <= 0 || cfg.ventana <= 0 ||
+       cfg.lote < 1 || cfg.lote > MAX_LOTE || cfg.grupo_min < 1 || cfg.grupo_max < cfg.grupo_min ||
+       cfg.parques < 1 || cfg.parques > UINT16_MAX + 1 ||
+       (!cfg.compartida && strcmp(transporte, "fifo") != 0) || (!cfg.pico && strcmp(horas, "uniforme") != 0)){
+        printf("Uso: %s -p <pipe> [-x fifo|shm] [-k agentes] [-n solicitudes/agente] [-w ventana] [-b lote]\n"
+               "       [-y uniforme|pico] [-g min-max | -g geo:media] [-c pid controlador] [-s semilla] [-P parques]\n"
+               "     %s -T <traza> [las mismas opciones de solicitudes]\n",
+               argv[0], argv[0]);
+        return 1;
+    }
+    if(traza != NULL) return grabar_traza(&cfg, traza);
+    signal(SIGPIPE, SIG_IGN);
+
+    if(cfg.compartida){
+        char nombre[NAME_MAX];
+        compartida_nombre(cfg.tubo, nombre, sizeof(nombre));
+        cfg.segmento = compartida_abrir(nombre);
+        if(cfg.segmento == NULL){
+            perror("Error al abrir la memoria compartida del controlador");
+            return 1;
+        }
+    }
+
+    Simulado* agentes = calloc(cfg.agentes, sizeof(Simulado));
+    for(int i=0; i<cfg.agentes; i++){
+        agentes[i].cfg = &cfg;
+        agentes[i].id = ID_BASE + i;
+        agentes[i].enviada_en = calloc(cfg.solicitudes + 1, sizeof(double));
+        agentes[i].latencias = malloc(cfg.solicitudes * sizeof(double));
+        if(agentes[i].enviada_en == NULL || agentes[i].latencias == NULL){
+            printf("Error: Sin memoria para %d agentes simulados.\n", cfg.agentes);
+            return 1;
+        }
+    }
+
+    double cpu_ctl0 = controlador ? cpu_proceso(controlador) : -1;
+    double cpu0 = cpu_propia();
+    double t0 = segundos_ahora();
+
+    for(int i=0; i<cfg.agentes; i++) pthread_create(&agentes[i].hilo, NULL, simular_agente, &agentes[i]);
+    for(int i=0; i<cfg.agentes; i++) pthread_join(agentes[i].hilo, NULL);
+
+    double segundos = segundos_ahora() - t0;
+    double cpu_generador = cpu_propia() - cpu0;
+    double cpu_ctl = controlador ? cpu_proceso(controlador) - cpu_ctl0 : -1;
+
+    // Juntar latencias y resultados de todos los agentes
+    long total = 0;
+    int resultados[3] = {0, 0, 0}, errores = 0;
+    for(int i=0; i<cfg.agentes; i++) total += agentes[i].respondidas;
+    double* latencias = malloc((total > 0 ? total : 1) * sizeof(double));
+    long n = 0;
+    for(int i=0; i<cfg.agentes; i++){
+        memcpy(latencias + n, agentes[i].latencias, agentes[i].respondidas * sizeof(double));
+        n += agentes[i].respondidas;
+        for(int t=0; t<3; t++) resultados[t] += agentes[i].resultados[t];
+        errores += agentes[i].error;
+    }
+    qsort(latencias, n, sizeof(double), comparar_double);
+
+    long pedidas = (long)cfg.agentes * cfg.solicitudes;
+    printf("Agentes: %d (%s)  solicitudes: %ld  ventana: %d  lote: %d  horas: %s  grupos: ",
+           cfg.agentes, transporte, pedidas, cfg.ventana, cfg.lote, horas);
+    if(cfg.grupo_media > 0) printf("geo:%.1f\n", cfg.grupo_media);
+    else printf("%d-%d\n", cfg.grupo_min, cfg.grupo_max);
+    printf("Respondidas: %ld de %ld en %.3f s  →  %.0f solicitudes/s\n", total, pedidas, segundos,
+           segundos > 0 ? total / segundos : 0);
+    if(n > 0){
+        printf("Latencia de admisión (us): p50=%.1f  p99=%.1f  p999=%.1f  max=%.1f\n",
+               latencias[n / 2], latencias[(long)(n * 0.99)], latencias[(long)(n * 0.999)], latencias[n - 1]);
+    }
+    printf("Resultados: %d confirmadas, %d reprogramadas, %d denegadas\n", resultados[0], resultados[1], resultados[2]);
+    if(total > 0){
+        if(cpu_ctl >= 0) printf("CPU controlador: %.2f us/solicitud (%.2f s)\n", cpu_ctl * 1e6 / total, cpu_ctl);
+        printf("CPU generador:   %.2f us/solicitud (%.2f s)\n", cpu_generador * 1e6 / total, cpu_generador);
+    }
+    if(errores > 0) printf("Agentes que no pudieron registrarse: %d\n", errores);
+
+    for(int i=0; i<cfg.agentes; i++){
+        free(agentes[i].enviada_en);
+        free(agentes[i].latencias);
+    }
+    free(agentes);
+    free(latencias);
+    if(cfg.segmento != NULL) compartida_cerrar(cfg.segmento);
+    return (total == pedidas && errores == 0) ? 0 : 1;
+}
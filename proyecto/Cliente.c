@@ -6,9 +6,35 @@
 #include <sys/stat.h>   
 #include <unistd.h>     
 #include <fcntl.h>      
-
-// Extrae parámetros -s (id), -a (archivo), -p (pipe principal)
-void extraer_parametros(int argc, char* argv[], char** id_proceso, char** ruta_archivo, char** tubo_principal) {
+#include <stdint.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include "Protocolo.h"
+#include "Lector.h"
+#include "Compartida.h"
+
+// Canal con el controlador: FIFOs con nombre o memoria compartida
+typedef struct {
+    int desc_envio;               // FIFO principal (escritura)
+    int desc_recibo;              // FIFO privado (lectura)
+    Compartida* compartida;       // Segmento del controlador (NULL: FIFOs)
+    int anillo;                   // Anillo de respuestas propio (memoria compartida)
+} Enlace;
+
+// Solicitud enviada que todavía espera respuesta (modo ventana)
+typedef struct {
+    uint32_t secuencia;           // 0 = posición libre
+    int hora;
+    int personas;
+    const char* grupo;            // Tramo dentro del archivo mapeado
+    int largo;
+} EnVuelo;
+
+// Extrae parámetros -s (id), -a (archivo), -p (pipe principal), -w (ventana), -b (lote), -x (transporte),
+// -P (parque)
+void extraer_parametros(int argc, char* argv[], char** id_proceso, char** ruta_archivo, char** tubo_principal,
+                        int* ventana, int* lote, char** transporte, int* parque) {
     for(int i=0; i<argc; i++){
         if(*argv[i] == '-'){
             switch (*(argv[i++]+1))
@@ -16,35 +42,102 @@ void extraer_parametros(int argc, char* argv[], char** id_proceso, char** ruta_a
             case 's': *id_proceso = argv[i]; break;   // ID del agente
             case 'a': *ruta_archivo = argv[i]; break; // Archivo de solicitudes
             case 'p': *tubo_principal = argv[i]; break; // Pipe hacia el servidor
+            case 'w': *ventana = atoi(argv[i]); break;  // Solicitudes en vuelo (modo ventana)
+            case 'b': *lote = atoi(argv[i]); break;     // Solicitudes por marco (modo ventana)
+            case 'x': *transporte = argv[i]; break;     // Transporte: fifo o shm
+            case 'P': *parque = atoi(argv[i]); break;   // Parque al que van las solicitudes
             }
         }
     }
 }
 
-// Conexión inicial con el servidor (crea FIFO privado y envía registro)
-void conectar_servidor(char* tubo_principal, char* id_proceso, float* momento_sistema,
-                       int* desc_envio, int *desc_recibo, char* tubo_respuesta) {
+// Envía un marco sin bloquear. 0 si ok, -1 con errno (EAGAIN: sin lugar).
+int enlace_enviar(Enlace* enlace, CabeceraMarco cab, const char* datos, int largo){
+    if(enlace->compartida != NULL) return compartida_enviar(enlace->compartida, cab, datos, largo);
+    return marco_enviar(enlace->desc_envio, cab, datos, largo);
+}
 
-    // Crear FIFO propio para recibir respuestas
-    if (mkfifo(tubo_respuesta, 0666) == -1) {
-        perror("Error al crear FIFO");
+// Pasa al decodificador lo recibido. Bytes leídos, 0 si el servidor terminó, -1 con errno.
+ssize_t enlace_leer(Enlace* enlace, Decodificador* entrada){
+    if(enlace->compartida != NULL) return compartida_leer(enlace->compartida, enlace->anillo, entrada);
+    return decodificador_leer(entrada, enlace->desc_recibo);
+}
+
+// Duerme hasta que haya respuestas o, si 'enviar', lugar para enviar.
+// En memoria compartida no hay aviso de lugar libre: se reintenta cada 1 ms.
+void enlace_esperar(Enlace* enlace, int enviar){
+    if(enlace->compartida != NULL){
+        compartida_esperar_respuestas(enlace->compartida, enlace->anillo, enviar ? 1 : -1);
+        return;
     }
+    struct pollfd esperar[2] = { { enlace->desc_recibo, POLLIN, 0 }, { enlace->desc_envio, POLLOUT, 0 } };
+    if(poll(esperar, enviar ? 2 : 1, -1) == -1 && errno != EINTR) perror("Error en poll");
+}
 
-    // Abrir pipe privado en modo lectura
-    *desc_recibo = open(tubo_respuesta, O_RDONLY | O_NONBLOCK);
+// Cierra el canal y elimina el FIFO privado
+void enlace_cerrar(Enlace* enlace, char* tubo_respuesta){
+    if(enlace->compartida != NULL){
+        compartida_desconectar(enlace->compartida, enlace->anillo);
+        compartida_cerrar(enlace->compartida);
+        return;
+    }
+    close(enlace->desc_envio);   // Cierra pipe principal
+    close(enlace->desc_recibo);  // Cierra pipe privado
+    unlink(tubo_respuesta);      // Elimina FIFO privado
+}
 
-    // Abrir pipe principal en modo escritura
-    *desc_envio = open(tubo_principal, O_WRONLY | O_NONBLOCK);
+// Intenta obtener un marco del servidor sin bloquear.
+// Devuelve 1 si hay marco, 0 si todavía no llegó nada completo.
+int recibir_marco(Decodificador* entrada, Enlace* enlace, CabeceraMarco* cab, const char** nombre){
+    if(decodificador_siguiente(entrada, cab, nombre) == 1) return 1;
+    enlace_leer(enlace, entrada);
+    return decodificador_siguiente(entrada, cab, nombre) == 1;
+}
+
+// Conexión inicial con el servidor (crea FIFO privado, o toma un anillo de
+// respuestas en memoria compartida, y envía registro)
+void conectar_servidor(char* tubo_principal, uint32_t id_agente, char* id_proceso, float* momento_sistema,
+                       Enlace* enlace, char* tubo_respuesta, Decodificador* entrada) {
+
+    char destino[MAX_NOMBRE + 1];               // Lo que viaja en el registro
+    if(enlace->compartida == NULL){
+        // Crear FIFO propio para recibir respuestas
+        if (mkfifo(tubo_respuesta, 0666) == -1) {
+            perror("Error al crear FIFO");
+        }
 
-    // Enviar mensaje de registro: "id,pipePropio"
-    char msg_inicial[100];
-    snprintf(msg_inicial, 100, "%s,%s", id_proceso, tubo_respuesta);
-    write(*desc_envio, msg_inicial, sizeof(msg_inicial));
+        // Abrir pipe privado en modo lectura
+        enlace->desc_recibo = open(tubo_respuesta, O_RDONLY | O_NONBLOCK);
+
+        // Abrir pipe principal en modo escritura
+        enlace->desc_envio = open(tubo_principal, O_WRONLY | O_NONBLOCK);
+        snprintf(destino, sizeof(destino), "%s", tubo_respuesta);
+    } else {
+        // Anillo propio: el registro lleva su número
+        enlace->anillo = compartida_conectar(enlace->compartida, id_agente);
+        if(enlace->anillo == -1){
+            printf("[ERROR] No hay anillos de respuesta libres en la memoria compartida\n");
+            exit(1);
+        }
+        snprintf(destino, sizeof(destino), "%d", enlace->anillo);
+    }
+
+    // Enviar marco de registro con el nombre del pipe propio
+    CabeceraMarco registro = { .tipo = MSG_REGISTRO, .agente = id_agente };
+    if(enlace_enviar(enlace, registro, destino, strlen(destino)) == -1){
+        perror("Error al registrarse en el servidor");
+        exit(1);
+    }
 
     usleep(100000); // Pequeña espera
 
     // Recibir hora del sistema enviada por el servidor
-    read(*desc_recibo, momento_sistema, sizeof(float));
+    CabeceraMarco cab;
+    const char* nombre;
+    *momento_sistema = 0;
+    if(recibir_marco(entrada, enlace, &cab, &nombre) && cab.tipo == MSG_HORA){
+        *momento_sistema = cab.hora;
+    }
 
     // Mensajes de estado
     printf("\n╔════════════════════════════════════════╗\n");
@@ -57,68 +150,70 @@ void conectar_servidor(char* tubo_principal, char* id_proceso, float* momento_si
 }
 
 // Procesa cada solicitud del archivo y la envía al servidor
-void procesar_solicitudes(char* ruta_archivo, int desc_envio, float momento_sistema,
-                          int desc_recibo, char* id_proceso, char* tubo_respuesta) {
+void procesar_solicitudes(char* ruta_archivo, Enlace* enlace, float momento_sistema,
+                          uint32_t id_agente, char* id_proceso, char* tubo_respuesta,
+                          Decodificador* entrada, int parque) {
 
-    FILE* entrada = fopen(ruta_archivo, "r");   // Abrir archivo CSV
-    if (entrada == NULL) {
+    LectorCsv archivo;                          // Archivo CSV mapeado en memoria
+    if (lector_abrir(&archivo, ruta_archivo) == -1) {
         printf("[ERROR] No se pudo acceder al archivo de datos\n");
         return;
     }
 
-    char registro[50];
+    RegistroCsv registro;
+    int estado;
     char respuesta[100];
+    CabeceraMarco cab;
+    const char* nombre;
     char finalizado = 1;
     int num_solicitud = 0;
 
     printf("┌─ Iniciando procesamiento de solicitudes\n");
 
-    // Leer línea por línea del archivo
-    while (fgets(registro, sizeof(registro), entrada)) {
+    // Leer registro por registro del archivo (hasta el fin o "Fin,0,0")
+    while ((estado = lector_siguiente(&archivo, &registro)) != 0) {
 
         finalizado = 0;
-        char temporal[50]; 
-        strcpy(temporal, registro);
+        if(estado == -1){
+            printf("│\n├─ [LINEA INVALIDA] %s\n", archivo.error);
+            finalizado = 1;             // Se ignora y se sigue con la próxima
+            continue;
+        }
 
-        // Separar datos: nombre, hora, cantidad
-        char* nombre_grupo = strtok(temporal, ",");
-        char* token = strtok(NULL, ",");
-        int hora_pedida = atoi(token);
-        token = strtok(NULL, ",");
-        int personas = atoi(token);
+        // Datos: nombre (tramo del archivo), hora, cantidad
+        const char* nombre_grupo = registro.nombre;
+        int largo_grupo = registro.largo;
+        int hora_pedida = registro.hora;
+        int personas = registro.personas;
 
         // Solo enviar si la hora es mayor que la hora actual del sistema
         if (hora_pedida > momento_sistema) {
 
             num_solicitud++;
 
-            // Formar solicitud completa
-            char peticion[100];
-            snprintf(peticion, 100, "%s,%s%s",
-                     id_proceso, registro, feof(entrada) ? "\n" : "");
-
             // Mostrar datos
             printf("│\n├─ [SOLICITUD #%d]\n", num_solicitud);
-            printf("│  ├─ Grupo: %s\n", nombre_grupo);
+            printf("│  ├─ Grupo: %.*s\n", largo_grupo, nombre_grupo);
             printf("│  ├─ Horario solicitado: %d:00\n", hora_pedida);
             printf("│  ├─ Cantidad personas: %d\n", personas);
             printf("│  └─ Estado: ENVIANDO...\n");
 
             // Enviar al servidor
-            write(desc_envio, peticion, strlen(peticion)+1);
+            CabeceraMarco peticion = { .tipo = MSG_SOLICITUD, .agente = id_agente,
+                                       .hora = hora_pedida, .personas = personas,
+                                       .secuencia = num_solicitud, .parque = parque };
+            enlace_enviar(enlace, peticion, nombre_grupo, largo_grupo);
 
             usleep(10000); // Espera corta
 
             // Leer respuesta del servidor
-            ssize_t recibido = read(desc_recibo, respuesta, sizeof(respuesta));
-            if(recibido > 0){
-                respuesta[recibido] = '\0';
-
-                if(strcmp(respuesta, "FIN") == 0){
+            if(recibir_marco(entrada, enlace, &cab, &nombre)){
+                if(cab.tipo == MSG_FIN){
                     printf("│  └─ SERVIDOR FINALIZADO\n");
                     break; // Servidor terminó
                 }
-                else{
+                else if(cab.tipo == MSG_RESPUESTA){
+                    describir_resultado(cab.resultado, cab.hora, cab.minuto, respuesta, sizeof(respuesta));
                     printf("│  └─ RESPUESTA: %s\n", respuesta);
                 }
             }
@@ -126,11 +221,8 @@ void procesar_solicitudes(char* ruta_archivo, int desc_envio, float momento_sist
             sleep(2); // Pausa de 2 segundos requerida por el proyecto
 
             // Segunda lectura por si hay otra respuesta
-            recibido = read(desc_recibo, respuesta, sizeof(respuesta));
-            if(recibido > 0){
-                respuesta[recibido] = '\0';
-
-                if(strcmp(respuesta, "FIN") == 0){
+            if(recibir_marco(entrada, enlace, &cab, &nombre)){
+                if(cab.tipo == MSG_FIN){
                     printf("│  └─ SERVIDOR FINALIZADO\n");
                     break;
                 }
@@ -139,8 +231,8 @@ void procesar_solicitudes(char* ruta_archivo, int desc_envio, float momento_sist
         } else {
             // Si la hora de la solicitud ya pasó
             printf("│\n├─ [SOLICITUD OMITIDA]\n");
-            printf("│  └─ Grupo %s solicita hora %d:00 (anterior al tiempo actual)\n",
-                   nombre_grupo, hora_pedida);
+            printf("│  └─ Grupo %.*s solicita hora %d:00 (anterior al tiempo actual)\n",
+                   largo_grupo, nombre_grupo, hora_pedida);
         }
 
         finalizado = 1;
@@ -148,9 +240,8 @@ void procesar_solicitudes(char* ruta_archivo, int desc_envio, float momento_sist
 
     // Si todo terminó correctamente
     if(finalizado){
-        char msg_cierre[40];
-        snprintf(msg_cierre, 40, "Agente %s termina.", id_proceso);
-        write(desc_envio, msg_cierre, strlen(msg_cierre)+1);
+        CabeceraMarco cierre = { .tipo = MSG_CIERRE, .agente = id_agente };
+        enlace_enviar(enlace, cierre, NULL, 0);
 
         printf("│\n└─ Todas las solicitudes han sido procesadas\n\n");
         printf("╔════════════════════════════════════════╗\n");
@@ -162,35 +253,247 @@ void procesar_solicitudes(char* ruta_archivo, int desc_envio, float momento_sist
         printf("════════════════════════════════════════\n\n");
     }
 
-    fclose(entrada);     // Cierra archivo
-    close(desc_envio);   // Cierra pipe principal
+    lector_cerrar(&archivo);     // Libera el mapeo
     usleep(10000);
-    close(desc_recibo);  // Cierra pipe privado
-    unlink(tubo_respuesta); // Elimina FIFO privado
+    enlace_cerrar(enlace, tubo_respuesta);
+}
+
+// Empareja una respuesta con su solicitud por secuencia y la muestra
+void anotar_respuesta(EnVuelo pendientes[], int ventana, uint32_t secuencia, Resultado resultado,
+                      int hora, int minuto, int* en_vuelo, int resultados[]){
+    char respuesta[100];
+
+    EnVuelo* solicitud = &pendientes[secuencia % ventana];
+    if(solicitud->secuencia != secuencia){
+        printf("│  [#%u] Respuesta sin solicitud pendiente\n", secuencia);
+        return;
+    }
+    describir_resultado(resultado, hora, minuto, respuesta, sizeof(respuesta));
+    printf("│  [#%u] Grupo %.*s (%d:00) → %s\n", secuencia, solicitud->largo, solicitud->grupo,
+           solicitud->hora, respuesta);
+    resultados[resultado == RES_CONFIRMADO ? 0 :
+               (resultado == RES_REPROGRAMADO || resultado == RES_REPROGRAMADO_EXTEMPORANEO) ? 1 : 2]++;
+    solicitud->secuencia = 0;
+    (*en_vuelo)--;
+}
+
+// Lee las respuestas disponibles (sueltas o de un lote) y las anota.
+// Devuelve 1 si el servidor terminó (MSG_FIN o FIFO cerrado).
+int recibir_respuestas(Decodificador* entrada, Enlace* enlace, EnVuelo pendientes[], int ventana,
+                       int* en_vuelo, int resultados[]){
+    CabeceraMarco cab;
+    const char* datos;
+
+    while(1){
+        ssize_t leidos = enlace_leer(enlace, entrada);
+        while(decodificador_siguiente(entrada, &cab, &datos) == 1){
+            if(cab.tipo == MSG_FIN){
+                printf("│  └─ SERVIDOR FINALIZADO\n");
+                return 1;
+            }
+            if(cab.tipo == MSG_RESPUESTA){
+                anotar_respuesta(pendientes, ventana, cab.secuencia, cab.resultado, cab.hora, cab.minuto,
+                                 en_vuelo, resultados);
+            } else if(cab.tipo == MSG_RESPUESTA_LOTE){
+                // Un ResultadoLote por solicitud, en el orden del lote
+                for(int k=0; k<cab.largo_nombre / (int)sizeof(ResultadoLote); k++){
+                    ResultadoLote r;
+                    memcpy(&r, datos + k * sizeof(ResultadoLote), sizeof(r));
+                    anotar_respuesta(pendientes, ventana, r.secuencia, r.resultado, r.hora, r.minuto,
+                                     en_vuelo, resultados);
+                }
+            }
+        }
+        if(leidos == 0) return 1;                   // El servidor cerró su extremo
+        if(leidos == -1) return 0;                  // EAGAIN: no hay más por ahora
+    }
+}
+
+// Envía las 'cantidad' solicitudes armadas: una sola como MSG_SOLICITUD,
+// varias como un MSG_LOTE. 0 si se envió, -1 con errno (EAGAIN: FIFO lleno).
+int enviar_armado(Enlace* enlace, uint32_t id_agente, EnVuelo* primera, const char* carga, int usados,
+                  int cantidad, int parque){
+    if(cantidad == 1){
+        CabeceraMarco peticion = { .tipo = MSG_SOLICITUD, .agente = id_agente, .hora = primera->hora,
+                                   .personas = primera->personas, .secuencia = primera->secuencia,
+                                   .parque = parque };
+        return enlace_enviar(enlace, peticion, primera->grupo, primera->largo);
+    }
+    CabeceraMarco lote = { .tipo = MSG_LOTE, .agente = id_agente, .personas = cantidad,
+                           .secuencia = primera->secuencia, .parque = parque };
+    return enlace_enviar(enlace, lote, carga, usados);
+}
+
+// Modo ventana: mantiene hasta 'ventana' solicitudes en vuelo en lugar de
+// esperar cada respuesta. El enlace despierta al agente cuando llegan
+// respuestas o cuando vuelve a haber lugar para enviar. Con 'lote' > 1 junta
+// hasta 'lote' solicitudes por marco y el servidor responde con un solo marco.
+void procesar_en_ventana(char* ruta_archivo, Enlace* enlace, float momento_sistema,
+                         uint32_t id_agente, char* id_proceso, char* tubo_respuesta,
+                         Decodificador* entrada, int ventana, int lote, int parque) {
+
+    LectorCsv archivo;                          // Archivo CSV mapeado en memoria
+    if (lector_abrir(&archivo, ruta_archivo) == -1) {
+        printf("[ERROR] No se pudo acceder al archivo de datos\n");
+        return;
+    }
+    EnVuelo* pendientes = calloc(ventana, sizeof(EnVuelo));
+    if (pendientes == NULL) {
+        printf("[ERROR] Sin memoria para la ventana de solicitudes\n");
+        lector_cerrar(&archivo);
+        return;
+    }
+
+    RegistroCsv registro;                       // Siguiente solicitud, leída y sin armar
+    char carga[MAX_CARGA];                      // Marco de lote en armado
+    int usados = 0, en_lote = 0;                // Bytes y solicitudes armadas sin enviar
+    int preparada = 0, fin_archivo = 0, servidor_fin = 0;
+    int en_vuelo = 0, enviadas = 0, omitidas = 0, invalidas = 0;
+    int resultados[3] = {0, 0, 0};              // Confirmadas / Reprogramadas / Denegadas
+
+    struct timespec inicio, final;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    printf("┌─ Iniciando procesamiento de solicitudes (ventana de %d, lotes de %d)\n", ventana, lote);
+
+    while(!servidor_fin && (!fin_archivo || preparada || en_lote > 0 || en_vuelo > 0)){
+
+        // Llenar la ventana mientras el FIFO principal acepte marcos
+        while(en_vuelo + en_lote < ventana || en_lote > 0){
+
+            // Armar hasta 'lote' solicitudes (las que entren en un marco)
+            while(en_lote < lote && en_vuelo + en_lote < ventana){
+                if(!preparada){
+                    int estado = lector_siguiente(&archivo, &registro);
+                    if(estado == 0){
+                        fin_archivo = 1;
+                        break;
+                    }
+                    if(estado == -1){
+                        printf("│  [LINEA INVALIDA] %s\n", archivo.error);
+                        invalidas++;
+                        continue;
+                    }
+                    if(registro.hora <= momento_sistema){
+                        omitidas++;             // Hora anterior al tiempo actual
+                        continue;
+                    }
+                    preparada = 1;
+                }
+                SolicitudLote armada = { .secuencia = enviadas + en_lote + 1, .hora = registro.hora,
+                                         .personas = registro.personas, .largo_nombre = registro.largo };
+                if(lote_agregar(carga, &usados, armada, registro.nombre) == -1) break;   // Va en el próximo marco
+
+                pendientes[armada.secuencia % ventana] = (EnVuelo){ armada.secuencia, registro.hora,
+                                                                    registro.personas, registro.nombre, registro.largo };
+                en_lote++;
+                preparada = 0;
+            }
+            if(en_lote == 0) break;
+
+            EnVuelo* primera = &pendientes[(enviadas + 1) % ventana];
+            if(enviar_armado(enlace, id_agente, primera, carga, usados, en_lote, parque) == -1){
+                if(errno == EAGAIN) break;      // FIFO lleno: esperar POLLOUT
+                perror("Error al enviar solicitud");
+                servidor_fin = 1;
+                break;
+            }
+            enviadas += en_lote;
+            en_vuelo += en_lote;
+            en_lote = 0;
+            usados = 0;
+        }
+        if(servidor_fin || (fin_archivo && !preparada && en_lote == 0 && en_vuelo == 0)) break;
+
+        // Dormir hasta que lleguen respuestas o haya lugar para enviar
+        enlace_esperar(enlace, en_lote > 0);
+        servidor_fin = recibir_respuestas(entrada, enlace, pendientes, ventana, &en_vuelo, resultados);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &final);
+    double segundos = (final.tv_sec - inicio.tv_sec) + (final.tv_nsec - inicio.tv_nsec) / 1e9;
+
+    if(!servidor_fin){
+        CabeceraMarco cierre = { .tipo = MSG_CIERRE, .agente = id_agente };
+        enlace_enviar(enlace, cierre, NULL, 0);
+    }
+
+    printf("│\n└─ Solicitudes procesadas\n\n");
+    printf("╔════════════════════════════════════════╗\n");
+    printf("║      PROCESO CLIENTE FINALIZADO       ║\n");
+    printf("╚════════════════════════════════════════╝\n");
+    printf("» Cliente: %s\n", id_proceso);
+    printf("» Solicitudes tramitadas: %d (omitidas: %d, inválidas: %d, sin respuesta: %d)\n",
+           enviadas, omitidas, invalidas, en_vuelo);
+    printf("» Confirmadas: %d  Reprogramadas: %d  Denegadas: %d\n", resultados[0], resultados[1], resultados[2]);
+    printf("» Tiempo: %.3f s (%.0f solicitudes/s)\n", segundos, segundos > 0 ? enviadas / segundos : 0);
+    printf("» Estado: DESCONECTADO\n");
+    printf("════════════════════════════════════════\n\n");
+
+    free(pendientes);
+    lector_cerrar(&archivo);     // Libera el mapeo
+    enlace_cerrar(enlace, tubo_respuesta);
 }
 
 int main(int argc, char *argv[]){
-    char* id_proceso;        // Identificador del agente
-    char* ruta_archivo;      // Archivo de solicitudes
-    char* tubo_principal;    // FIFO principal hacia servidor
-    int desc_envio;          // Descriptor de escritura
-    int desc_recibo;         // Descriptor de lectura
+    char* id_proceso = NULL;     // Identificador del agente
+    char* ruta_archivo = NULL;   // Archivo de solicitudes
+    char* tubo_principal = NULL; // FIFO principal hacia servidor
+    Enlace enlace = { -1, -1, NULL, -1 };   // FIFOs o memoria compartida
+    char* transporte = "fifo";   // fifo o shm
     float momento_sistema;   // Hora actual simulada
     char tubo_respuesta[20]; // FIFO privado del agente
+    static Decodificador entrada; // Respuestas del servidor
+    int ventana = 0;         // 0: modo pausado original
+    int lote = 1;            // Solicitudes por marco
+    int parque = 0;          // Parque de las solicitudes (0: el único, si hay uno solo)
 
     // Leer parámetros del terminal
-    extraer_parametros(argc, argv, &id_proceso, &ruta_archivo, &tubo_principal);
+    extraer_parametros(argc, argv, &id_proceso, &ruta_archivo, &tubo_principal, &ventana, &lote, &transporte, &parque);
+
+    if(id_proceso == NULL || ruta_archivo == NULL || tubo_principal == NULL || ventana < 0 ||
+       lote < 1 || lote > MAX_LOTE || parque < 0 || parque > UINT16_MAX || (strcmp(transporte, "fifo") != 0 && strcmp(transporte, "shm") != 0)){
+        printf("Uso: %s -s <id> -a <archivo> -p <pipe> [-w <solicitudes en vuelo>] [-b <solicitudes por lote, hasta %d>]"
+               " [-x fifo|shm] [-P parque]\n", argv[0], MAX_LOTE);
+        return 1;
+    }
+    if(lote > ventana && lote > 1) ventana = lote;  // Los lotes usan el modo ventana
+    signal(SIGPIPE, SIG_IGN);    // Si el servidor ya cerró, write() devuelve EPIPE
+
+    // El protocolo identifica al agente con un número
+    char* resto;
+    unsigned long id_agente = strtoul(id_proceso, &resto, 10);
+    if(*id_proceso == '\0' || *resto != '\0' || id_agente == 0 || id_agente > UINT32_MAX){
+        printf("[ERROR] El ID del agente (-s) debe ser un entero positivo\n");
+        return 1;
+    }
+    decodificador_iniciar(&entrada);
 
     // Crear nombre del pipe privado: "pipe<ID>"
     snprintf(tubo_respuesta, 20, "%s%s", "pipe", id_proceso);
 
+    // Memoria compartida: el segmento lleva el nombre del pipe principal
+    if(strcmp(transporte, "shm") == 0){
+        char nombre_compartida[NAME_MAX];
+        compartida_nombre(tubo_principal, nombre_compartida, sizeof(nombre_compartida));
+        enlace.compartida = compartida_abrir(nombre_compartida);
+        if(enlace.compartida == NULL){
+            perror("Error al abrir la memoria compartida del servidor");
+            return 1;
+        }
+    }
+
     // Conexión inicial
-    conectar_servidor(tubo_principal, id_proceso, &momento_sistema,
-                      &desc_envio, &desc_recibo, tubo_respuesta);
+    conectar_servidor(tubo_principal, id_agente, id_proceso, &momento_sistema,
+                      &enlace, tubo_respuesta, &entrada);
 
     // Procesar archivo y enviar solicitudes
-    procesar_solicitudes(ruta_archivo, desc_envio, momento_sistema,
-                         desc_recibo, id_proceso, tubo_respuesta);
+    if(ventana > 0){
+        procesar_en_ventana(ruta_archivo, &enlace, momento_sistema,
+                            id_agente, id_proceso, tubo_respuesta, &entrada, ventana, lote, parque);
+    } else {
+        procesar_solicitudes(ruta_archivo, &enlace, momento_sistema,
+                             id_agente, id_proceso, tubo_respuesta, &entrada, parque);
+    }
 
     return 0;
 }
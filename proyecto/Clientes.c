@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <string.h>
+#include "Clientes.h"
+
+#define CARGA_MAXIMA 2   // Crecer al superar 1/2 de ocupación
+
+// Hash multiplicativo (Fibonacci): mezcla bien IDs consecutivos
+static int posicion_de(uint32_t agente, int capacidad){
+    return (int)((agente * 2654435769u) & (uint32_t)(capacidad - 1));
+}
+
+// Celda del agente o la celda vacía donde iría
+static int buscar_celda(Cliente* celdas, int capacidad, uint32_t agente){
+    int i = posicion_de(agente, capacidad);
+    while(celdas[i].agente != 0 && celdas[i].agente != agente){
+        i = (i + 1) & (capacidad - 1);
+    }
+    return i;
+}
+
+int clientes_crear(TablaClientes* tabla, int capacidad_inicial){
+    int capacidad = 16;
+    while(capacidad < capacidad_inicial * CARGA_MAXIMA) capacidad *= 2;
+
+    tabla->celdas = calloc(capacidad, sizeof(Cliente));
+    if(tabla->celdas == NULL) return -1;
+    tabla->capacidad = capacidad;
+    tabla->cantidad = 0;
+    pthread_mutex_init(&tabla->bloqueo, NULL);
+    return 0;
+}
+
+void clientes_destruir(TablaClientes* tabla){
+    pthread_mutex_destroy(&tabla->bloqueo);
+    free(tabla->celdas);
+    tabla->celdas = NULL;
+}
+
+// Duplica la tabla y reubica todas las celdas
+static int crecer(TablaClientes* tabla){
+    int capacidad = tabla->capacidad * 2;
+    Cliente* celdas = calloc(capacidad, sizeof(Cliente));
+    if(celdas == NULL) return -1;
+
+    for(int i=0; i<tabla->capacidad; i++){
+        if(tabla->celdas[i].agente != 0){
+            celdas[buscar_celda(celdas, capacidad, tabla->celdas[i].agente)] = tabla->celdas[i];
+        }
+    }
+    free(tabla->celdas);
+    tabla->celdas = celdas;
+    tabla->capacidad = capacidad;
+    return 0;
+}
+
+int clientes_registrar(TablaClientes* tabla, uint32_t agente, int descriptor){
+    pthread_mutex_lock(&tabla->bloqueo);
+
+    int i = buscar_celda(tabla->celdas, tabla->capacidad, agente);
+    if(tabla->celdas[i].agente == agente){
+        int anterior = tabla->celdas[i].descriptor;
+        tabla->celdas[i].descriptor = descriptor;
+        pthread_mutex_unlock(&tabla->bloqueo);
+        return anterior;
+    }
+
+    if((tabla->cantidad + 1) * CARGA_MAXIMA > tabla->capacidad){
+        if(crecer(tabla) == -1){
+            pthread_mutex_unlock(&tabla->bloqueo);
+            return -2;
+        }
+        i = buscar_celda(tabla->celdas, tabla->capacidad, agente);
+    }
+
+    tabla->celdas[i] = (Cliente){ .agente = agente, .descriptor = descriptor };
+    tabla->cantidad++;
+
+    pthread_mutex_unlock(&tabla->bloqueo);
+    return -1;
+}
+
+int clientes_anotar(TablaClientes* tabla, uint32_t agente, int tipo){
+    pthread_mutex_lock(&tabla->bloqueo);
+
+    int descriptor = -1;
+    int i = buscar_celda(tabla->celdas, tabla->capacidad, agente);
+    if(tabla->celdas[i].agente == agente){
+        tabla->celdas[i].solicitudes[tipo]++;
+        descriptor = tabla->celdas[i].descriptor;
+    }
+
+    pthread_mutex_unlock(&tabla->bloqueo);
+    return descriptor;
+}
+
+int clientes_sumar(TablaClientes* tabla, uint32_t agente, const int cantidades[3]){
+    pthread_mutex_lock(&tabla->bloqueo);
+
+    int descriptor = -1;
+    int i = buscar_celda(tabla->celdas, tabla->capacidad, agente);
+    if(tabla->celdas[i].agente == agente){
+        for(int tipo=0; tipo<3; tipo++) tabla->celdas[i].solicitudes[tipo] += cantidades[tipo];
+        descriptor = tabla->celdas[i].descriptor;
+    }
+
+    pthread_mutex_unlock(&tabla->bloqueo);
+    return descriptor;
+}
+
+int clientes_eliminar(TablaClientes* tabla, uint32_t agente, Cliente* cliente){
+    pthread_mutex_lock(&tabla->bloqueo);
+
+    int mascara = tabla->capacidad - 1;
+    int i = buscar_celda(tabla->celdas, tabla->capacidad, agente);
+    if(tabla->celdas[i].agente != agente){
+        pthread_mutex_unlock(&tabla->bloqueo);
+        return 0;
+    }
+    *cliente = tabla->celdas[i];
+    tabla->cantidad--;
+
+    // Borrado con corrimiento hacia atrás: sin lápidas, las búsquedas
+    // siguen cortando en la primera celda vacía
+    int j = i;
+    while(1){
+        j = (j + 1) & mascara;
+        if(tabla->celdas[j].agente == 0) break;
+        int ideal = posicion_de(tabla->celdas[j].agente, tabla->capacidad);
+        // Mover j al hueco i si su posición ideal no está entre (i, j]
+        if(((j - ideal) & mascara) >= ((j - i) & mascara)){
+            tabla->celdas[i] = tabla->celdas[j];
+            i = j;
+        }
+    }
+    memset(&tabla->celdas[i], 0, sizeof(Cliente));
+
+    pthread_mutex_unlock(&tabla->bloqueo);
+    return 1;
+}
+
+int clientes_cantidad(TablaClientes* tabla){
+    pthread_mutex_lock(&tabla->bloqueo);
+    int cantidad = tabla->cantidad;
+    pthread_mutex_unlock(&tabla->bloqueo);
+    return cantidad;
+}
+
+void clientes_recorrer(TablaClientes* tabla, void (*visitar)(Cliente* cliente, void* contexto), void* contexto){
+    pthread_mutex_lock(&tabla->bloqueo);
+    for(int i=0; i<tabla->capacidad; i++){
+        if(tabla->celdas[i].agente != 0) visitar(&tabla->celdas[i], contexto);
+    }
+    pthread_mutex_unlock(&tabla->bloqueo);
+}
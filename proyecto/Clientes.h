@@ -0,0 +1,49 @@
+#ifndef CLIENTES_H
+#define CLIENTES_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+// Tabla de agentes conectados: hash con direccionamiento abierto (sondeo
+// lineal) indexado por ID de agente. Registrar, buscar y eliminar son O(1)
+// en promedio y la tabla crece sola, así que no hay límite fijo de agentes.
+// El ID 0 marca una celda vacía (los agentes usan IDs >= 1).
+
+typedef struct {
+    uint32_t agente;              // ID del agente (0 = celda vacía)
+    int descriptor;               // FIFO privado del agente (escritura)
+    int solicitudes[3];           // Confirmadas / Reprogramadas / Denegadas
+} Cliente;
+
+typedef struct {
+    pthread_mutex_t bloqueo;      // Protege celdas y contadores
+    Cliente* celdas;
+    int capacidad;                // Siempre potencia de 2
+    int cantidad;                 // Celdas ocupadas
+} TablaClientes;
+
+// 0 si ok, -1 sin memoria
+int clientes_crear(TablaClientes* tabla, int capacidad_inicial);
+void clientes_destruir(TablaClientes* tabla);
+
+// Registra (o reemplaza) el agente. Devuelve el descriptor anterior si ya
+// estaba registrado, -1 si es nuevo, o -2 si no hubo memoria para crecer.
+int clientes_registrar(TablaClientes* tabla, uint32_t agente, int descriptor);
+
+// Suma una solicitud al contador 'tipo' del agente y devuelve su descriptor,
+// o -1 si el agente no está registrado. Una sola búsqueda por solicitud.
+int clientes_anotar(TablaClientes* tabla, uint32_t agente, int tipo);
+
+// Igual que clientes_anotar para un lote: suma cantidades[tipo] a cada contador
+int clientes_sumar(TablaClientes* tabla, uint32_t agente, const int cantidades[3]);
+
+// Quita el agente. Devuelve 1 y copia sus datos en 'cliente' si existía.
+int clientes_eliminar(TablaClientes* tabla, uint32_t agente, Cliente* cliente);
+
+// Nº de agentes registrados
+int clientes_cantidad(TablaClientes* tabla);
+
+// Llama a 'visitar' con cada agente registrado (bajo el cerrojo)
+void clientes_recorrer(TablaClientes* tabla, void (*visitar)(Cliente* cliente, void* contexto), void* contexto);
+
+#endif
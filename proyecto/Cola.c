@@ -0,0 +1,81 @@
+#include <stdlib.h>
+#include <string.h>
+#include "Cola.h"
+
+int cola_crear(Cola* cola, int capacidad, int tam_elemento){
+    cola->elementos = malloc((size_t)capacidad * tam_elemento);
+    if(cola->elementos == NULL) return -1;
+    cola->tam_elemento = tam_elemento;
+    cola->capacidad = capacidad;
+    cola->inicio = 0;
+    cola->cantidad = 0;
+    cola->maximo = 0;
+    cola->cerrada = 0;
+    pthread_mutex_init(&cola->bloqueo, NULL);
+    pthread_cond_init(&cola->hay_datos, NULL);
+    pthread_cond_init(&cola->hay_espacio, NULL);
+    return 0;
+}
+
+void cola_destruir(Cola* cola){
+    pthread_mutex_destroy(&cola->bloqueo);
+    pthread_cond_destroy(&cola->hay_datos);
+    pthread_cond_destroy(&cola->hay_espacio);
+    free(cola->elementos);
+    cola->elementos = NULL;
+}
+
+int cola_poner(Cola* cola, const void* elemento){
+    pthread_mutex_lock(&cola->bloqueo);
+    while(cola->cantidad == cola->capacidad && !cola->cerrada){
+        pthread_cond_wait(&cola->hay_espacio, &cola->bloqueo);
+    }
+    if(cola->cerrada){
+        pthread_mutex_unlock(&cola->bloqueo);
+        return -1;
+    }
+
+    int fin = (cola->inicio + cola->cantidad) % cola->capacidad;
+    memcpy(cola->elementos + (size_t)fin * cola->tam_elemento, elemento, cola->tam_elemento);
+    cola->cantidad++;
+    if(cola->cantidad > cola->maximo) cola->maximo = cola->cantidad;
+
+    pthread_cond_signal(&cola->hay_datos);
+    pthread_mutex_unlock(&cola->bloqueo);
+    return 0;
+}
+
+int cola_sacar(Cola* cola, void* elemento){
+    pthread_mutex_lock(&cola->bloqueo);
+    while(cola->cantidad == 0 && !cola->cerrada){
+        pthread_cond_wait(&cola->hay_datos, &cola->bloqueo);
+    }
+    if(cola->cantidad == 0){
+        pthread_mutex_unlock(&cola->bloqueo);
+        return 0;               // Cerrada y vacía
+    }
+
+    memcpy(elemento, cola->elementos + (size_t)cola->inicio * cola->tam_elemento, cola->tam_elemento);
+    cola->inicio = (cola->inicio + 1) % cola->capacidad;
+    cola->cantidad--;
+
+    pthread_cond_signal(&cola->hay_espacio);
+    pthread_mutex_unlock(&cola->bloqueo);
+    return 1;
+}
+
+int cola_cantidad(Cola* cola, int* maximo){
+    pthread_mutex_lock(&cola->bloqueo);
+    int cantidad = cola->cantidad;
+    if(maximo != NULL) *maximo = cola->maximo;
+    pthread_mutex_unlock(&cola->bloqueo);
+    return cantidad;
+}
+
+void cola_cerrar(Cola* cola){
+    pthread_mutex_lock(&cola->bloqueo);
+    cola->cerrada = 1;
+    pthread_cond_broadcast(&cola->hay_datos);
+    pthread_cond_broadcast(&cola->hay_espacio);
+    pthread_mutex_unlock(&cola->bloqueo);
+}
@@ -0,0 +1,38 @@
+#ifndef COLA_H
+#define COLA_H
+
+#include <pthread.h>
+
+// Cola acotada de elementos de tamaño fijo, segura para varios productores
+// y varios consumidores. Poner bloquea si está llena y sacar bloquea si
+// está vacía, así que la cola también hace de control de flujo.
+typedef struct {
+    pthread_mutex_t bloqueo;
+    pthread_cond_t hay_datos;     // Se avisa al poner
+    pthread_cond_t hay_espacio;   // Se avisa al sacar
+    char* elementos;              // Anillo de capacidad * tam_elemento bytes
+    int tam_elemento;
+    int capacidad;
+    int inicio;                   // Posición del elemento más antiguo
+    int cantidad;                 // Elementos en la cola
+    int maximo;                   // Mayor cantidad alcanzada
+    int cerrada;                  // Ya no se aceptan elementos
+} Cola;
+
+// 0 si ok, -1 sin memoria
+int cola_crear(Cola* cola, int capacidad, int tam_elemento);
+void cola_destruir(Cola* cola);
+
+// Copia el elemento al final. Devuelve 0, o -1 si la cola está cerrada.
+int cola_poner(Cola* cola, const void* elemento);
+
+// Copia el elemento más antiguo. Devuelve 1, o 0 si la cola está cerrada y vacía.
+int cola_sacar(Cola* cola, void* elemento);
+
+// Elementos en la cola ahora; en 'maximo' (si no es NULL) el mayor alcanzado
+int cola_cantidad(Cola* cola, int* maximo);
+
+// No acepta más elementos; los consumidores terminan de vaciarla y salen.
+void cola_cerrar(Cola* cola);
+
+#endif
@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "Compartida.h"
+
+#define MAGIA_COMPARTIDA 0x4d454d31u  // "MEM1"
+
+_Static_assert((RANURAS_PETICION & (RANURAS_PETICION - 1)) == 0, "RANURAS_PETICION debe ser potencia de 2");
+_Static_assert((BYTES_RESPUESTA & (BYTES_RESPUESTA - 1)) == 0, "BYTES_RESPUESTA debe ser potencia de 2");
+
+// Futex entre procesos (sin FUTEX_PRIVATE_FLAG: el segmento es compartido)
+static void futex_esperar(_Atomic uint32_t* palabra, uint32_t valor, int milisegundos){
+    struct timespec limite = { milisegundos / 1000, (milisegundos % 1000) * 1000000L };
+    syscall(SYS_futex, palabra, FUTEX_WAIT, valor, milisegundos >= 0 ? &limite : NULL, NULL, 0);
+}
+
+static void futex_despertar(_Atomic uint32_t* palabra){
+    syscall(SYS_futex, palabra, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+// Productor: despierta al consumidor solo si se durmió con el anillo vacío
+static void avisar(_Atomic uint32_t* esperando, _Atomic uint32_t* despertar){
+    atomic_thread_fence(memory_order_seq_cst);  // Publicación antes de mirar 'esperando'
+    if(atomic_load_explicit(esperando, memory_order_relaxed) && atomic_exchange(esperando, 0)){
+        atomic_fetch_add(despertar, 1);
+        futex_despertar(despertar);
+    }
+}
+
+// Consumidor: duerme salvo que 'hay_datos' ya vea algo tras anunciarse
+static void dormir(_Atomic uint32_t* esperando, _Atomic uint32_t* despertar, int (*hay_datos)(void*),
+                   void* contexto, int milisegundos){
+    uint32_t valor = atomic_load(despertar);
+    atomic_store(esperando, 1);
+    atomic_thread_fence(memory_order_seq_cst);  // Anuncio antes de volver a mirar el anillo
+    if(!hay_datos(contexto)) futex_esperar(despertar, valor, milisegundos);
+    atomic_store(esperando, 0);
+}
+
+void compartida_nombre(const char* tubo, char* destino, int capacidad){
+    int j = 0;
+    if(capacidad > 1) destino[j++] = '/';
+    for(int i=0; tubo[i] != '\0' && j < capacidad - 1; i++){
+        destino[j++] = (tubo[i] == '/') ? '_' : tubo[i];
+    }
+    destino[j] = '\0';
+}
+
+Compartida* compartida_crear(const char* nombre){
+    shm_unlink(nombre);                         // Restos de una ejecución anterior
+    int fd = shm_open(nombre, O_CREAT | O_EXCL | O_RDWR, 0666);
+    if(fd == -1) return NULL;
+    if(ftruncate(fd, sizeof(Compartida)) == -1){
+        close(fd);
+        shm_unlink(nombre);
+        return NULL;
+    }
+    Compartida* c = mmap(NULL, sizeof(Compartida), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(c == MAP_FAILED){
+        shm_unlink(nombre);
+        return NULL;
+    }
+
+    // El segmento nace en cero: solo hay que dar turno a cada ranura
+    for(int i=0; i<RANURAS_PETICION; i++) atomic_store(&c->peticiones[i].turno, i);
+    atomic_store_explicit(&c->magia, MAGIA_COMPARTIDA, memory_order_release);
+    return c;
+}
+
+void compartida_destruir(Compartida* c, const char* nombre){
+    munmap(c, sizeof(Compartida));
+    shm_unlink(nombre);
+}
+
+Compartida* compartida_abrir(const char* nombre){
+    int fd = shm_open(nombre, O_RDWR, 0);
+    if(fd == -1) return NULL;
+
+    struct stat info;
+    if(fstat(fd, &info) == -1 || info.st_size != sizeof(Compartida)){
+        close(fd);
+        errno = EINVAL;                         // Otro tamaño: otra versión del controlador
+        return NULL;
+    }
+    Compartida* c = mmap(NULL, sizeof(Compartida), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(c == MAP_FAILED) return NULL;
+
+    if(atomic_load_explicit(&c->magia, memory_order_acquire) != MAGIA_COMPARTIDA){
+        munmap(c, sizeof(Compartida));
+        errno = EAGAIN;                         // El controlador todavía lo está preparando
+        return NULL;
+    }
+    return c;
+}
+
+void compartida_cerrar(Compartida* c){
+    munmap(c, sizeof(Compartida));
+}
+
+int compartida_enviar(Compartida* c, CabeceraMarco cab, const char* datos, int largo){
+    if(largo < 0 || largo > marco_carga_maxima(cab.tipo)){
+        errno = EINVAL;                         // Se valida antes de ocupar una ranura
+        return -1;
+    }
+
+    // Reservar la próxima posición libre (varios agentes compiten por 'cola')
+    RanuraPeticion* ranura;
+    uint64_t posicion = atomic_load_explicit(&c->cola, memory_order_relaxed);
+    while(1){
+        ranura = &c->peticiones[posicion & (RANURAS_PETICION - 1)];
+        uint64_t turno = atomic_load_explicit(&ranura->turno, memory_order_acquire);
+        int64_t diferencia = (int64_t)(turno - posicion);
+        if(diferencia == 0){
+            if(atomic_compare_exchange_weak_explicit(&c->cola, &posicion, posicion + 1,
+                                                     memory_order_relaxed, memory_order_relaxed)) break;
+        } else if(diferencia < 0){
+            errno = EAGAIN;                     // Anillo lleno: el controlador no consumió la vuelta anterior
+            return -1;
+        } else {
+            posicion = atomic_load_explicit(&c->cola, memory_order_relaxed);
+        }
+    }
+
+    marco_codificar(ranura->marco, PIPE_BUF, cab, datos, largo);
+    atomic_store_explicit(&ranura->turno, posicion + 1, memory_order_release);
+
+    avisar(&c->esperando, &c->despertar);
+    return 0;
+}
+
+static int hay_peticion(void* contexto){
+    Compartida* c = contexto;
+    uint64_t posicion = atomic_load_explicit(&c->cabeza, memory_order_relaxed);
+    RanuraPeticion* ranura = &c->peticiones[posicion & (RANURAS_PETICION - 1)];
+    return atomic_load_explicit(&ranura->turno, memory_order_acquire) == posicion + 1 ||
+           atomic_load(&c->fin);
+}
+
+int compartida_tomar(Compartida* c, CabeceraMarco* cab, const char** datos){
+    uint64_t posicion = atomic_load_explicit(&c->cabeza, memory_order_relaxed);
+    RanuraPeticion* ranura = &c->peticiones[posicion & (RANURAS_PETICION - 1)];
+    if(atomic_load_explicit(&ranura->turno, memory_order_acquire) != posicion + 1) return 0;
+
+    memcpy(cab, ranura->marco, TAM_CABECERA);
+    if(!marco_entrante(cab)){
+        compartida_soltar(c);
+        return -1;
+    }
+    *datos = ranura->marco + TAM_CABECERA;
+    return 1;
+}
+
+void compartida_soltar(Compartida* c){
+    uint64_t posicion = atomic_load_explicit(&c->cabeza, memory_order_relaxed);
+    RanuraPeticion* ranura = &c->peticiones[posicion & (RANURAS_PETICION - 1)];
+    atomic_store_explicit(&ranura->turno, posicion + RANURAS_PETICION, memory_order_release);
+    atomic_store_explicit(&c->cabeza, posicion + 1, memory_order_relaxed);
+}
+
+void compartida_esperar_peticiones(Compartida* c){
+    dormir(&c->esperando, &c->despertar, hay_peticion, c, -1);
+}
+
+void compartida_terminar(Compartida* c){
+    atomic_store(&c->fin, 1);
+    atomic_fetch_add(&c->despertar, 1);
+    futex_despertar(&c->despertar);
+}
+
+int compartida_terminada(Compartida* c){
+    return atomic_load(&c->fin);
+}
+
+int compartida_conectar(Compartida* c, uint32_t agente){
+    for(int i=0; i<ANILLOS_RESPUESTA; i++){
+        AnilloRespuesta* anillo = &c->respuestas[i];
+        uint32_t dueno = atomic_load(&anillo->dueno);
+
+        // Libre, o de un agente que terminó sin desconectarse
+        int32_t proceso = atomic_load(&anillo->proceso);
+        if(dueno != 0 && !(proceso > 0 && kill(proceso, 0) == -1 && errno == ESRCH)) continue;
+        if(!atomic_compare_exchange_strong(&anillo->dueno, &dueno, agente)) continue;
+
+        atomic_store(&anillo->proceso, getpid());
+        atomic_store(&anillo->leido, atomic_load(&anillo->escrito));    // Descartar restos
+        return i;
+    }
+    return -1;
+}
+
+void compartida_desconectar(Compartida* c, int anillo){
+    atomic_store(&c->respuestas[anillo].proceso, 0);
+    atomic_store(&c->respuestas[anillo].dueno, 0);
+}
+
+ssize_t compartida_escribir(Compartida* c, int anillo, uint32_t agente, const char* bytes, int largo){
+    AnilloRespuesta* a = &c->respuestas[anillo];
+    if(atomic_load(&a->dueno) != agente){
+        errno = EPIPE;
+        return -1;
+    }
+
+    uint64_t escrito = atomic_load_explicit(&a->escrito, memory_order_relaxed);
+    uint64_t libres = BYTES_RESPUESTA - (escrito - atomic_load_explicit(&a->leido, memory_order_acquire));
+    if(libres == 0){
+        // Lleno: que espere en la cola, salvo que el agente se haya ido
+        int32_t proceso = atomic_load(&a->proceso);
+        errno = (kill(proceso, 0) == -1 && errno == ESRCH) ? EPIPE : EAGAIN;
+        return -1;
+    }
+    int cantidad = (uint64_t)largo < libres ? largo : (int)libres;
+
+    // Copiar dando la vuelta al final del anillo si hace falta
+    int desde = escrito & (BYTES_RESPUESTA - 1);
+    int primera = (cantidad < BYTES_RESPUESTA - desde) ? cantidad : BYTES_RESPUESTA - desde;
+    memcpy(a->datos + desde, bytes, primera);
+    memcpy(a->datos, bytes + primera, cantidad - primera);
+    atomic_store_explicit(&a->escrito, escrito + cantidad, memory_order_release);
+
+    avisar(&a->esperando, &a->despertar);
+    return cantidad;
+}
+
+void compartida_pendiente(Compartida* c, int anillo, int hay){
+    AnilloRespuesta* a = &c->respuestas[anillo];
+    atomic_store(&a->pendiente, hay);
+    if(!hay) avisar(&a->esperando, &a->despertar);  // Puede estar esperando solo eso para terminar
+}
+
+ssize_t compartida_leer(Compartida* c, int anillo, Decodificador* d){
+    AnilloRespuesta* a = &c->respuestas[anillo];
+
+    // Mover al inicio el marco incompleto que haya quedado
+    if(d->inicio > 0){
+        memmove(d->datos, d->datos + d->inicio, d->usados - d->inicio);
+        d->usados -= d->inicio;
+        d->inicio = 0;
+    }
+
+    uint64_t leido = atomic_load_explicit(&a->leido, memory_order_relaxed);
+    uint64_t disponibles = atomic_load_explicit(&a->escrito, memory_order_acquire) - leido;
+    if(disponibles == 0){
+        if(atomic_load(&c->fin) && !atomic_load(&a->pendiente)) return 0;     // Como un EOF del FIFO
+        errno = EAGAIN;
+        return -1;
+    }
+
+    int cantidad = sizeof(d->datos) - d->usados;
+    if(cantidad == 0){
+        errno = EAGAIN;                         // Decodificador lleno: consumir marcos primero
+        return -1;
+    }
+    if((uint64_t)cantidad > disponibles) cantidad = disponibles;
+    int desde = leido & (BYTES_RESPUESTA - 1);
+    int primera = (cantidad < BYTES_RESPUESTA - desde) ? cantidad : BYTES_RESPUESTA - desde;
+    memcpy(d->datos + d->usados, a->datos + desde, primera);
+    memcpy(d->datos + d->usados + primera, a->datos, cantidad - primera);
+    d->usados += cantidad;
+
+    atomic_store_explicit(&a->leido, leido + cantidad, memory_order_release);
+    return cantidad;
+}
+
+// Contexto de hay_respuesta
+typedef struct {
+    Compartida* c;
+    AnilloRespuesta* a;
+} Espera;
+
+static int hay_respuesta(void* contexto){
+    Espera* e = contexto;
+    return atomic_load_explicit(&e->a->escrito, memory_order_acquire) != atomic_load(&e->a->leido) ||
+           (atomic_load(&e->c->fin) && !atomic_load(&e->a->pendiente));
+}
+
+void compartida_esperar_respuestas(Compartida* c, int anillo, int milisegundos){
+    Espera espera = { c, &c->respuestas[anillo] };
+    dormir(&espera.a->esperando, &espera.a->despertar, hay_respuesta, &espera, milisegundos);
+}
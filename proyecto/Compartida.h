@@ -0,0 +1,108 @@
+#ifndef COMPARTIDA_H
+#define COMPARTIDA_H
+
+#include <stdint.h>
+#include <limits.h>
+#include <sys/types.h>
+#include "Protocolo.h"
+
+// Transporte por memoria compartida POSIX, alternativo a los FIFOs.
+// El controlador crea un segmento con:
+//  - Un anillo de peticiones de ranuras fijas (una por marco), sin cerrojos
+//    y con varios productores (los agentes): cada ranura lleva un turno que
+//    dice si está libre o publicada.
+//  - Un anillo de bytes por agente para las respuestas, con un solo consumidor
+//    (el agente). Pueden responderle los trabajadores de varios parques: la
+//    cola de salida del agente en el controlador (Salida.h) los serializa y
+//    guarda lo que no entra, así nadie espera a un agente que no lee.
+// Los marcos son los mismos que en los FIFOs. Quien consume duerme en un
+// futex solo cuando su anillo está vacío, y quien produce hace la llamada
+// al sistema solo si encuentra a alguien durmiendo.
+
+#define RANURAS_PETICION 512          // Marcos en el anillo de peticiones (potencia de 2)
+#define ANILLOS_RESPUESTA 128         // Agentes conectados a la vez
+#define BYTES_RESPUESTA 65536         // Bytes por anillo de respuestas (potencia de 2)
+
+typedef struct {
+    _Atomic uint64_t turno;           // == posición: libre; posición + 1: tiene marco
+    char marco[PIPE_BUF];
+} RanuraPeticion;
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t escrito;   // Bytes publicados por el controlador
+    _Atomic uint32_t pendiente;              // El controlador tiene respuestas en cola para él
+    _Atomic uint32_t esperando;              // El agente duerme en 'despertar'
+    _Atomic uint32_t despertar;              // Futex del agente
+    _Alignas(64) _Atomic uint64_t leido;     // Bytes consumidos por el agente
+    _Atomic uint32_t dueno;                  // ID del agente que lo usa (0 = libre)
+    _Atomic int32_t proceso;                 // PID del agente, para detectar abandonos
+    _Alignas(64) char datos[BYTES_RESPUESTA];
+} AnilloRespuesta;
+
+typedef struct {
+    _Atomic uint32_t magia;                  // Segmento inicializado
+    _Atomic uint32_t fin;                    // El controlador terminó la simulación
+    _Alignas(64) _Atomic uint64_t cola;      // Próxima posición a producir (agentes)
+    _Alignas(64) _Atomic uint64_t cabeza;    // Próxima posición a consumir (controlador)
+    _Atomic uint32_t esperando;              // El controlador duerme en 'despertar'
+    _Atomic uint32_t despertar;              // Futex del controlador
+    RanuraPeticion peticiones[RANURAS_PETICION];
+    AnilloRespuesta respuestas[ANILLOS_RESPUESTA];
+} Compartida;
+
+// Nombre del segmento para el FIFO 'tubo' ("/" + nombre sin barras)
+void compartida_nombre(const char* tubo, char* destino, int capacidad);
+
+// Controlador: crea (o recrea) el segmento. NULL con errno si falla.
+Compartida* compartida_crear(const char* nombre);
+void compartida_destruir(Compartida* c, const char* nombre);
+
+// Agente: se conecta a un segmento existente. NULL con errno si falla.
+Compartida* compartida_abrir(const char* nombre);
+void compartida_cerrar(Compartida* c);
+
+// --- Peticiones (agentes -> controlador) ---
+
+// Publica un marco sin bloquear. 0 si ok, -1 con errno (EAGAIN: anillo lleno).
+int compartida_enviar(Compartida* c, CabeceraMarco cab, const char* datos, int largo);
+
+// Controlador: marco más antiguo, sin copiarlo. Devuelve 1 si hay marco
+// (datos apunta a la ranura hasta compartida_soltar), 0 si el anillo está
+// vacío y -1 si el marco era inválido (ya se descartó).
+int compartida_tomar(Compartida* c, CabeceraMarco* cab, const char** datos);
+void compartida_soltar(Compartida* c);
+
+// Controlador: duerme hasta que llegue una petición o termine la simulación
+void compartida_esperar_peticiones(Compartida* c);
+
+// Marca el fin de la simulación y despierta al controlador
+void compartida_terminar(Compartida* c);
+int compartida_terminada(Compartida* c);
+
+// --- Respuestas (controlador -> un agente) ---
+
+// Agente: toma un anillo de respuestas libre. Devuelve su índice o -1 si no hay.
+int compartida_conectar(Compartida* c, uint32_t agente);
+void compartida_desconectar(Compartida* c, int anillo);
+
+// Controlador: copia en el anillo del agente lo que entre de 'bytes' (marcos
+// ya codificados) sin esperar, como un write() no bloqueante al FIFO. Un
+// productor por anillo a la vez. Devuelve los bytes copiados, o -1 con
+// errno = EAGAIN si el anillo está lleno, o EPIPE si ya no es del agente o
+// el proceso del agente terminó.
+ssize_t compartida_escribir(Compartida* c, int anillo, uint32_t agente, const char* bytes, int largo);
+
+// Controlador: anuncia si tiene respuestas en cola para el anillo. Mientras
+// las tenga, el agente no toma el fin de la simulación como un EOF.
+void compartida_pendiente(Compartida* c, int anillo, int hay);
+
+// Agente: pasa al decodificador lo que haya en su anillo. Igual que
+// decodificador_leer: bytes leídos, 0 si el controlador terminó y no queda
+// nada (ni en el anillo ni en su cola), o -1 con errno = EAGAIN si todavía
+// no hay datos.
+ssize_t compartida_leer(Compartida* c, int anillo, Decodificador* d);
+
+// Agente: duerme hasta que haya respuestas (o fin), a lo sumo 'milisegundos' (-1: sin límite)
+void compartida_esperar_respuestas(Compartida* c, int anillo, int milisegundos);
+
+#endif
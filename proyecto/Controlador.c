@@ -3,470 +3,948 @@
 #include <string.h>
 #include <pthread.h>
 #include <time.h>
+#include <signal.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
-
-#define LIMITE_CLIENTES 10   // Máx. clientes simultáneos
-#define TAM_BUFFER 256        // Tamaño de lectura
-
-pthread_mutex_t bloqueo;      // Mutex para proteger secciones críticas
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "Protocolo.h"
+#include "Agenda.h"
+#include "Cola.h"
+#include "Clientes.h"
+#include "Reloj.h"
+#include "Compartida.h"
+#include "Metricas.h"
+#include "Estadisticas.h"
+#include "Bitacora.h"
+#include "Diario.h"
+#include "Parques.h"
+#include "Traza.h"
+#include "Admision.h"
+#include "Salida.h"
+#include "Lector.h"
+#include "Plan.h"
+
+#define MAX_EVENTOS 8         // Eventos atendidos por cada epoll_wait
+#define CAPACIDAD_COLA 1024   // Marcos pendientes por trabajador
+#define CLIENTES_INICIAL 64   // Tamaño inicial de la tabla de clientes (crece sola)
+#define MAX_ARCHIVOS_PLAN 64  // Archivos de solicitudes en el modo plan
+#define RONDAS_PLAN 16        // Rondas de búsqueda del plan (los hilos comparten lo mejor en cada una)
+#define ESPERA_FIN_MS 1000    // Al cerrar: cuánto esperar a que los agentes lean su FIN
 
 // Datos usados por el hilo que simula el reloj
 typedef struct {
-    int duracion_hora;            // Duración de 1h simulada (en seg reales)
-    time_t inicio_real;           // Momento real de inicio
-    int apertura;                 // Hora de apertura parque
-    int cierre;                   // Hora de cierre parque
-    int inicio_sim;               // Inicio simulación
+    Reloj* reloj;                 // Hora simulada
     int fin_sim;                  // Fin simulación
-    volatile float* reloj;        // Hora simulada
-    int total_horas;              // Horas totales del día
-    int* ocupacion;               // Ocupación por hora
-    char*** registros_familias;   // Familias que ingresan por hora
-    int* contador_familias;       // Cuántas familias entran por hora
-    volatile char* terminado;     // Marca de finalización
-    int* ingresos;                // Personas que ingresan por hora
+    Admision* admision;           // Parques cuyas franjas se informan
+    int evento_fin;               // eventfd que avisa el fin de la simulación
+    Compartida* compartida;       // Segmento compartido (NULL: transporte por FIFOs)
+    Bitacora* bitacora;
 } DatosReloj;
 
 // Datos usados por el hilo que atiende el pipe principal
 typedef struct {
     int descriptor_lectura;       // FIFO principal
-    char** ids_clientes;          // IDs de clientes registrados
-    int* descriptores_escritura;  // Pipes privados de los clientes
-    int* num_clientes;            // Nº clientes conectados
-    volatile float* reloj;        // Hora actual
-    int apertura, cierre;         // Franja operativa
+    TablaClientes* clientes;      // Clientes registrados (ID -> pipe privado)
+    Reloj* reloj;                 // Hora actual (lectura sin cerrojo)
     int inicio_sim, fin_sim;      // Rango de simulación
-    int capacidad;                // Capacidad del parque
-    int* ocupacion;               // Ocupación por hora
-    int total_horas;
-    char*** registros_familias;   // Familias por hora
-    int* contador_familias;       // Contadores por hora
-    volatile char* terminado;
-    int* estadisticas;            // Confirmadas / Reprogramadas / Denegadas
-    int* ingresos;                // Entradas por hora
+    Parques* parques;             // Agenda, horario y contadores de cada parque
+    int evento_fin;               // eventfd de fin de simulación
+    Cola* colas;                  // Una cola por trabajador
+    int num_trabajadores;
+    Compartida* compartida;       // Segmento compartido (NULL: transporte por FIFOs)
+    Metricas* metricas;           // Histogramas por hilo y etapa
+    Bitacora* bitacora;           // Salida asíncrona de eventos
+    Admision* admision;           // Decide cada marco (y lo graba con -g)
+    Salida* respuestas;           // Colas de salida a los FIFOs privados (NULL con memoria compartida)
 } DatosPipe;
 
-void parsear_argumentos(int argc, char* argv[], int* inicio, int* fin, int* seg, int* cap, char** tubo) {
+// Despedida de un agente, repartida a todos los trabajadores: sus peticiones
+// pueden estar en la cola de cualquier parque. El último en atenderla cierra
+// el descriptor, cuando ya ningún trabajador puede estar respondiéndole.
+typedef struct {
+    _Atomic int pendientes;       // Trabajadores que todavía no la atendieron
+    uint32_t agente;
+    int descriptor;               // >= 0: solo cerrar este descriptor (el agente se volvió a registrar)
+} Despedida;
+
+// Marco copiado fuera del buffer del FIFO para entregarlo a un trabajador
+typedef struct {
+    CabeceraMarco cab;
+    char nombre[MAX_NOMBRE];
+    char* lote;                   // Datos de un MSG_LOTE (malloc), NULL si no es lote
+    Despedida* despedida;         // Solo en MSG_CIERRE
+} Tarea;
+
+// Datos de cada hilo trabajador
+typedef struct {
+    DatosPipe* datos;
+    Cola* cola;                   // Tareas de los agentes asignados a este hilo
+    int numero;
+} DatosTrabajador;
+
+
+void parsear_argumentos(int argc, char* argv[], int* inicio, int* fin, float* seg, int* cap, char** tubo, float* visita,
+                        int* minutos, int* hilos, char** transporte, int* nivel, char** formato, char** salida,
+                        char** diario, char** parques, char* planes[], int* num_planes, char** objetivo,
+                        long* intentos, char** traza) {
     for(int i=1; i<argc; i++){
         if(*argv[i] == '-'){
             switch (*(argv[i++]+1)) {
                 case 'i': *inicio = atoi(argv[i]); break;     // Hora inicio simulación
                 case 'f': *fin = atoi(argv[i]); break;        // Hora fin simulación
-                case 's': *seg = atoi(argv[i]); break;        // Segundos por hora
+                case 's': *seg = atof(argv[i]); break;        // Segundos por hora (0.01 = acelerado)
                 case 't': *cap = atoi(argv[i]); break;        // Capacidad total parque
                 case 'p': *tubo = argv[i]; break;             // FIFO principal
+                case 'd': *visita = atof(argv[i]); break;     // Horas por visita (admite fracción: 1.5)
+                case 'm': *minutos = atoi(argv[i]); break;    // Minutos por franja
+                case 'h': *hilos = atoi(argv[i]); break;      // Hilos trabajadores
+                case 'x': *transporte = argv[i]; break;       // Transporte: fifo o shm
+                case 'v': *nivel = atoi(argv[i]); break;      // Nivel de la bitácora (0-3)
+                case 'l': *formato = argv[i]; break;          // Bitácora: texto, json o binario
+                case 'o': *salida = argv[i]; break;           // Archivo de la bitácora (por defecto stdout)
+                case 'j': *diario = argv[i]; break;           // Prefijo del diario de recuperación
+                case 'P': *parques = argv[i]; break;          // Configuración de varios parques
+                case 'a':                                     // Modo plan: archivo de solicitudes (se repite)
+                    if(*num_planes < MAX_ARCHIVOS_PLAN) planes[(*num_planes)++] = argv[i];
+                    break;
+                case 'O': *objetivo = argv[i]; break;         // Modo plan: maximizar personas o grupos
+                case 'n': *intentos = atol(argv[i]); break;   // Modo plan: intentos por hilo y ronda
+                case 'g': *traza = argv[i]; break;            // Grabar la traza para ./repeticion
             }
         }
     }
 }
 
-void preparar_sistema(char* tubo, time_t* momento_inicio, int* fd_lect) {
-    if (mkfifo(tubo, 0666) == -1) { // Crear FIFO principal
-        perror("Error al crear FIFO");
+void preparar_sistema(char* tubo, int usar_fifo, int* fd_lect, int* fd_guardia, int* evento_fin) {
+    *fd_lect = *fd_guardia = -1;
+    if(usar_fifo){
+        if (mkfifo(tubo, 0666) == -1) { // Crear FIFO principal
+            perror("Error al crear FIFO");
+        }
+        *fd_lect = open(tubo, O_RDONLY | O_NONBLOCK);  // Abrir FIFO en lectura non-blocking
+        if(*fd_lect == -1){ 
+            perror("Error al abrir FIFO para lectura");
+            exit(1);
+        }
+
+        // Escritor propio: mientras exista, el FIFO nunca queda en EPOLLHUP
+        // cuando se van todos los agentes (epoll no despierta en vacío)
+        *fd_guardia = open(tubo, O_WRONLY | O_NONBLOCK);
+        if(*fd_guardia == -1){
+            perror("Error al abrir FIFO de guardia");
+            exit(1);
+        }
+    }
+
+    // Un descriptor por agente: subir el límite blando hasta el duro
+    struct rlimit limite;
+    if(getrlimit(RLIMIT_NOFILE, &limite) == 0 && limite.rlim_cur < limite.rlim_max){
+        limite.rlim_cur = limite.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limite);
     }
-    time(momento_inicio);  // Guardar tiempo de inicio real
-    *fd_lect = open(tubo, O_RDONLY | O_NONBLOCK);  // Abrir FIFO en lectura non-blocking
-    if(*fd_lect == -1){ 
-        perror("Error al abrir FIFO para lectura");
+
+    // Aviso de fin de simulación (lo escribe el reloj, lo espera epoll)
+    *evento_fin = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(*evento_fin == -1){
+        perror("Error al crear eventfd");
         exit(1);
     }
 }
 
-int dividir_mensaje(char mensaje[], char* fragmentos[]){
-    int cantidad = 0;
-    char* copia = strdup(mensaje);        // Copia de seguridad
-    char* token = strtok(mensaje, ",");
+// Envía un marco a un agente por el transporte en uso. 'descriptor' es el
+// FIFO privado del agente, o su anillo de respuestas en memoria compartida.
+// Nunca bloquea: si el agente no lee, la respuesta espera en su cola de
+// salida y el trabajador sigue con los demás.
+int enviar_cliente(DatosPipe* d, int descriptor, CabeceraMarco cab, const char* datos, int largo){
+    return salida_enviar(d->respuestas, descriptor, cab, datos, largo);
+}
+
+void cerrar_cliente(uint32_t id, DatosPipe* datos) {
+    Cliente cliente;
+    if(admision_cierre(datos->admision, id, reloj_ms(datos->reloj), &cliente) && datos->compartida == NULL){
+        salida_cerrar(datos->respuestas, cliente.descriptor);   // El anillo lo libera el agente
+    }
+}
+
+// Un trabajador llegó a la despedida en su cola: todo lo anterior del agente
+// en esa cola ya está respondido. El último cierra.
+void atender_despedida(Despedida* despedida, DatosPipe* datos){
+    if(atomic_fetch_sub_explicit(&despedida->pendientes, 1, memory_order_acq_rel) != 1) return;
+    if(despedida->descriptor >= 0) salida_cerrar(datos->respuestas, despedida->descriptor);
+    else cerrar_cliente(despedida->agente, datos);
+    free(despedida);
+}
+
+// Pone la despedida al final de la cola de cada trabajador
+void repartir_despedida(DatosPipe* datos, uint32_t agente, int descriptor){
+    Despedida* despedida = malloc(sizeof(Despedida));
+    if(despedida == NULL){
+        fprintf(stderr, "Sin memoria para el cierre del cliente %u\n", agente);
+        return;
+    }
+    atomic_init(&despedida->pendientes, datos->num_trabajadores);
+    despedida->agente = agente;
+    despedida->descriptor = descriptor;
+
+    Tarea tarea = { .cab = { .tipo = MSG_CIERRE, .agente = agente }, .lote = NULL, .despedida = despedida };
+    for(int i=0; i<datos->num_trabajadores; i++){
+        if(cola_poner(&datos->colas[i], &tarea) == -1){
+            atender_despedida(despedida, datos);                // Cola cerrada: cuenta como atendida
+        }
+    }
+}
 
-    while(token != NULL){                 // Separar por comas
-        fragmentos[cantidad++] = token;
-        token = strtok(NULL, ",");
+// El registro lo atiende el hilo del tubo antes de repartir lo que sigue:
+// las peticiones del agente pueden ir a cualquier trabajador y todos deben
+// encontrarlo ya registrado.
+void registrar_cliente(CabeceraMarco* cab, const char* nombre, DatosPipe* datos){
+    Compartida* compartida = datos->compartida;
+    float momento = reloj_horas(datos->reloj);
+    char tubo_cliente[MAX_NOMBRE + 1];
+    snprintf(tubo_cliente, sizeof(tubo_cliente), "%.*s", cab->largo_nombre, nombre);
+
+    if(cab->agente == 0){                                       // El ID 0 marca celdas vacías
+        fprintf(stderr, "Registro rechazado: ID de agente 0\n");
+        return;
     }
 
-    // Si no venía separado por comas, separar por espacios
-    if(cantidad == 1){
-        cantidad = 0;
-        token = strtok(copia, " ");
-        while(token != NULL){
-            fragmentos[cantidad++] = token;
-            token = strtok(NULL, " ");
+    int descriptor;
+    if(compartida != NULL){
+        // En memoria compartida el registro trae el anillo que tomó el agente
+        descriptor = atoi(tubo_cliente);
+        if(descriptor < 0 || descriptor >= ANILLOS_RESPUESTA ||
+           atomic_load(&compartida->respuestas[descriptor].dueno) != cab->agente){
+            fprintf(stderr, "Registro rechazado: el anillo %s no es del cliente %u\n", tubo_cliente, cab->agente);
+            return;
+        }
+        salida_abrir(datos->respuestas, descriptor, cab->agente);  // Descarta lo del dueño anterior
+    } else {
+        descriptor = open(tubo_cliente, O_WRONLY);              // Abrir FIFO privado del cliente
+        if(descriptor == -1){
+            perror("Error abrir FIFO de escritura");            // Se ignora solo este agente
+            return;
         }
+        if(salida_abrir(datos->respuestas, descriptor, cab->agente) == -1){     // Desde acá, no bloqueante
+            fprintf(stderr, "Sin cola de salida para el cliente %u\n", cab->agente);
+            close(descriptor);
+            return;
+        }
+    }
+    CabeceraMarco hora = { .tipo = MSG_HORA, .agente = cab->agente, .hora = (int)momento };
+    enviar_cliente(datos, descriptor, hora, NULL, 0);           // Enviar hora actual
+
+    int anterior = admision_registro(datos->admision, cab, nombre, reloj_ms(datos->reloj), descriptor);
+    if(anterior >= 0 && compartida == NULL){
+        repartir_despedida(datos, cab->agente, anterior);       // El agente se volvió a registrar
+    }else if(anterior == -2){
+        fprintf(stderr, "Sin memoria para registrar al cliente %u\n", cab->agente);
+        if(compartida == NULL) salida_cerrar(datos->respuestas, descriptor);
     }
+}
+
+// La decisión la toma el núcleo de admisión con una sola lectura del reloj;
+// acá solo se mide y se envía la respuesta. La escritura va fuera de todo
+// cerrojo y no bloquea: el cierre del agente espera a que cada trabajador
+// atienda lo que tenía de él, así que el descriptor sigue abierto.
+void procesar_peticion(CabeceraMarco* cab, const char* nombre, DatosPipe *d) {
+    uint64_t inicio = metricas_medir();
+    CabeceraMarco respuesta;
+    int descriptor = admision_solicitud(d->admision, cab, nombre, reloj_ms(d->reloj), &respuesta);
+    uint64_t decidido = metricas_etapa(ETAPA_ADMISION, inicio);
+    if(descriptor == -1) return;                                // Agente no registrado
+
+    // Enviar la respuesta al cliente correspondiente
+    enviar_cliente(d, descriptor, respuesta, nombre, cab->largo_nombre);
+    metricas_etapa(ETAPA_RESPUESTA, decidido);
+}
 
-    return cantidad;                       // Devuelve número de partes
+// Un lote completo: todas las reservas en orden bajo un solo cerrojo de la
+// agenda y una sola respuesta con el resultado de cada solicitud
+void procesar_lote(CabeceraMarco* cab, const char* carga, DatosPipe* d) {
+    uint64_t inicio = metricas_medir();
+    CabeceraMarco respuesta;
+    ResultadoLote resultados[MAX_LOTE];
+    int descriptor = admision_lote(d->admision, cab, carga, reloj_ms(d->reloj), &respuesta, resultados);
+    uint64_t decidido = metricas_etapa(ETAPA_ADMISION, inicio);
+    if(descriptor == -1) return;                                // Agente no registrado
+
+    enviar_cliente(d, descriptor, respuesta, (const char*)resultados,
+                   respuesta.personas * sizeof(ResultadoLote));
+    metricas_etapa(ETAPA_RESPUESTA, decidido);
 }
 
-void registrar_cliente(char** fragmentos, char* ids[], int descriptores[], int* contador, float momento){
-    ids[*contador] = strdup(fragmentos[0]);                     // Guardar ID del cliente
-    descriptores[*contador] = open(fragmentos[1], O_WRONLY);    // Abrir FIFO privado del cliente
-    if(descriptores[*contador] == -1){
-        perror("Error abrir FIFO de escritura");
+void* ejecutar_reloj(void* parametros){
+    DatosReloj* datos = (DatosReloj*)parametros;
+    if(bitacora_registrar(datos->bitacora, 1) == -1){      // Los informes no se descartan: espera lugar
+        fprintf(stderr, "Error: No se pudo registrar el reloj en la bitácora\n");
         exit(1);
     }
-    write(descriptores[*contador], &momento, sizeof(float));    // Enviar hora actual
-    (*contador)++;                                              // Aumentar nº clientes
-}
 
-int asignar_espacio(int ocupacion[], int horas, int solicitada,
-    int apertura, float momento, int cantidad, int capacidad,
-    char*** registros, char* familia, int contador[], int* ingresos) {
+    // Un informe por franja (cada hora, o cada 'minutos' si es más fina).
+    // Con varios parques el paso es el divisor común de sus franjas y en
+    // cada paso informan los parques a los que les empieza una. Todas las
+    // franjas dividen la hora y abren en hora en punto, así que los bordes
+    // coinciden con los múltiplos del paso.
+    // El hilo duerme hasta el borde exacto del siguiente paso.
+    int paso = admision_paso(datos->admision->parques);
+    int minuto = (int)(reloj_ms(datos->reloj) / 60000) / paso * paso;
+    while(1){
+        admision_tic(datos->admision, minuto);
 
-    int posicion = ((solicitada < momento ? ((int)momento + 1) : solicitada) - apertura);
+        // Fin de simulación: despertar al hilo del tubo
+        if(minuto >= datos->fin_sim * 60){
+            uint64_t uno = 1;
+            write(datos->evento_fin, &uno, sizeof(uno));
+            if(datos->compartida != NULL) compartida_terminar(datos->compartida);
+            break;
+        }
 
-    // Buscar una hora donde haya espacio
-    for(int i=posicion; i<horas; i++){
-        if( (ocupacion[i] + cantidad) <= capacidad ){
-            if((i+1 < horas) && ((ocupacion[i+1] + cantidad) <= capacidad)){
+        minuto += paso;
+        reloj_esperar_hasta(datos->reloj, minuto * 60000LL);
+    }
+    return NULL;
+}
 
-                ocupacion[i] += cantidad;   // Registrar ocupación hora 1
-                ocupacion[i+1] += cantidad; // Registrar ocupación hora 2
+// Atiende una tarea sacada de la cola del trabajador
+void atender_marco(CabeceraMarco* cab, const char* nombre, Despedida* despedida, DatosPipe* datos){
+    switch(cab->tipo){
+        case MSG_SOLICITUD:                 // Solicitud de reserva
+            procesar_peticion(cab, nombre, datos);
+            break;
+        case MSG_LOTE:                      // Varias solicitudes en un marco
+            procesar_lote(cab, nombre, datos);
+            break;
+        case MSG_CIERRE:                    // Cierre de cliente (o de su descriptor anterior)
+            atender_despedida(despedida, datos);
+            break;
+    }
+}
 
-                char* duplicado = strdup(familia); // Guardar familia en registros
+// Hilo trabajador: atiende en orden las tareas de sus parques
+void* atender_tareas(void* parametros){
+    DatosTrabajador* trabajador = (DatosTrabajador*)parametros;
+    Tarea tarea;
 
-                registros[i][contador[i]] = duplicado;
-                ingresos[i] += cantidad;
-                contador[i]++;
+    char nombre[32];
+    snprintf(nombre, sizeof(nombre), "trabajador %d", trabajador->numero);
+    if(metricas_registrar(trabajador->datos->metricas, nombre) == -1){
+        fprintf(stderr, "Error: No se pudieron registrar las métricas del %s\n", nombre);
+        exit(1);
+    }
+    if(bitacora_registrar(trabajador->datos->bitacora, 0) == -1){
+        fprintf(stderr, "Error: No se pudo registrar el %s en la bitácora\n", nombre);
+        exit(1);
+    }
+
+    while(cola_sacar(trabajador->cola, &tarea)){
+        atender_marco(&tarea.cab, tarea.lote != NULL ? tarea.lote : tarea.nombre, tarea.despedida, trabajador->datos);
+        free(tarea.lote);
+    }
+    return NULL;
+}
 
-                registros[i+1][contador[i+1]] = duplicado;
-                contador[i+1]++;
+// Copia el marco y lo encola para el trabajador dueño de su parque. Todo lo
+// de un parque lo decide el mismo trabajador, en orden de llegada; lo que pide
+// un parque inexistente va al trabajador del agente, que lo deniega.
+// El registro se atiende acá mismo y el cierre va a todos los trabajadores.
+// Un lote no cabe en la tarea: sus datos se copian aparte.
+void repartir_marco(CabeceraMarco* cab, const char* nombre, DatosPipe* datos){
+    if(cab->tipo == MSG_REGISTRO){
+        registrar_cliente(cab, nombre, datos);
+        return;
+    }
+    if(cab->tipo == MSG_CIERRE){
+        repartir_despedida(datos, cab->agente, -1);
+        return;
+    }
 
-                return (i + apertura);      // Devolver hora asignada
-            }
+    Tarea tarea;
+    tarea.cab = *cab;
+    tarea.lote = NULL;
+    tarea.despedida = NULL;
+    if(cab->tipo == MSG_LOTE){
+        tarea.lote = malloc(cab->largo_nombre > 0 ? cab->largo_nombre : 1);
+        if(tarea.lote == NULL){
+            fprintf(stderr, "Sin memoria para el lote del cliente %u, descartado\n", cab->agente);
+            return;
         }
+        memcpy(tarea.lote, nombre, cab->largo_nombre);
+    } else {
+        if(cab->largo_nombre > (int)sizeof(tarea.nombre)) return;   // Ya filtrado al decodificar
+        memcpy(tarea.nombre, nombre, cab->largo_nombre);
+    }
+    int posicion = (cab->parque < MAX_PARQUES) ? datos->parques->posicion[cab->parque] : -1;
+    int trabajador = (posicion >= 0) ? posicion % datos->num_trabajadores : cab->agente % datos->num_trabajadores;
+    if(cola_poner(&datos->colas[trabajador], &tarea) == -1){
+        free(tarea.lote);                                   // Cola cerrada: se descarta
     }
-
-    return 0;   // No hay cupo
 }
 
-void procesar_peticion(char** f, DatosPipe *d) {
-    char* id_cliente = f[0];
-    char* nombre = f[1];
-    int hora = atoi(f[2]);
-    int personas = atoi(f[3]);
-    char respuesta[100];
-    char tiene_respuesta = 0;
-    int hora_asignada;
-
-    // Imprimir la petición recibida
-    printf("[PETICION] Cliente %s solicita espacio para grupo %s (%d personas) - Hora deseada: %d:00\n", 
-           id_cliente, nombre, personas, hora);
-
-    // Validaciones iniciales
-    if(hora > d->cierre || personas > d->capacidad || *(d->reloj) >= d->cierre){
-        snprintf(respuesta, 100, "DENEGADO: Solicitud fuera de rango operativo");
-        d->estadisticas[2]++;
-        tiene_respuesta = 1;
-    }
-
-    if(tiene_respuesta == 0){
-        // Intentar asignar espacio
-        hora_asignada = asignar_espacio(d->ocupacion, d->total_horas, hora, d->apertura, 
-                                        *(d->reloj), personas, d->capacidad, d->registros_familias, 
-                                        nombre, d->contador_familias, d->ingresos);
-        
-        // Caso hora pasada (extemporánea)
-        if(hora < *(d->reloj)){
-            tiene_respuesta = 1;
-            if(hora_asignada > hora){
-                snprintf(respuesta, 100, "REPROGRAMADO: Hora extemporanea - Nueva asignacion: %d:00", hora_asignada);
-                d->estadisticas[1]++;
-            } else {
-                snprintf(respuesta, 100, "DENEGADO: Hora extemporanea sin disponibilidad posterior");
-                d->estadisticas[2]++;
+// Lee todo lo disponible en el FIFO y reparte cada marco completo.
+// Un marco que llega cortado queda en el decodificador para la siguiente lectura.
+void drenar_tubo(DatosPipe* datos, Decodificador* entrada){
+    CabeceraMarco cab;
+    const char* nombre;
+
+    while(decodificador_leer(entrada, datos->descriptor_lectura) > 0){
+        long descartados = entrada->descartados;
+        uint64_t antes = metricas_medir();
+        while(decodificador_siguiente(entrada, &cab, &nombre) == 1){
+            // Solo marcos de agente a controlador: una respuesta no cabe en la tarea
+            if(!marco_entrante(&cab)){
+                fprintf(stderr, "Marco de tipo %d no esperado en el FIFO principal, descartado\n", cab.tipo);
+                continue;
             }
+            repartir_marco(&cab, nombre, datos);
+            metricas_etapa(ETAPA_DECODIFICAR, antes);       // Incluye encolar la tarea
+            antes = metricas_medir();
+        }
+        if(entrada->descartados > descartados){
+            fprintf(stderr, "%ld bytes inválidos en el FIFO principal, descartados\n",
+                    entrada->descartados - descartados);
         }
+    }
+}
 
-        // Horario válido
-        if(tiene_respuesta == 0){
-            if(hora_asignada == hora){
-                snprintf(respuesta, 100, "CONFIRMADO: Espacios asignados para %d:00", hora_asignada);
-                d->estadisticas[0]++;
-            } else if(hora_asignada > hora){
-                snprintf(respuesta, 100, "REPROGRAMADO: Sin cupo - Nueva asignacion: %d:00", hora_asignada);
-                d->estadisticas[1]++;
+void* escuchar_tubo(void* parametros){
+    DatosPipe* datos = (DatosPipe*)parametros;
+    static Decodificador entrada;     // 64 KB: fuera de la pila del hilo
+    decodificador_iniciar(&entrada);
+    if(metricas_registrar(datos->metricas, "tubo") == -1){
+        fprintf(stderr, "Error: No se pudieron registrar las métricas del tubo\n");
+        exit(1);
+    }
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(epoll_fd == -1){
+        perror("Error al crear epoll");
+        exit(1);
+    }
+    struct epoll_event evento = { .events = EPOLLIN };
+    evento.data.fd = datos->descriptor_lectura;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, datos->descriptor_lectura, &evento);
+    evento.data.fd = datos->evento_fin;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, datos->evento_fin, &evento);
+
+    // Dormir hasta que el FIFO tenga datos o el reloj avise el fin
+    int activo = 1;
+    while(activo){
+        struct epoll_event listos[MAX_EVENTOS];
+        int n = epoll_wait(epoll_fd, listos, MAX_EVENTOS, -1);
+        if(n == -1){
+            if(errno == EINTR) continue;
+            perror("Error en epoll_wait");
+            break;
+        }
+        for(int i=0; i<n; i++){
+            if(listos[i].data.fd == datos->descriptor_lectura){
+                drenar_tubo(datos, &entrada);
             } else {
-                snprintf(respuesta, 100, "DENEGADO: Capacidad insuficiente en todas las franjas");
-                d->estadisticas[2]++;
+                activo = 0;
             }
         }
     }
 
-    // Enviar la respuesta al cliente correspondiente
-    for(int i=0; i<*(d->num_clientes); i++){
-        if(strcmp(d->ids_clientes[i], id_cliente) == 0){
-            write(d->descriptores_escritura[i], respuesta, strlen(respuesta)+1);
-            break;
+    close(epoll_fd);
+    return NULL;
+}
+
+// Igual que escuchar_tubo, pero sobre el anillo de peticiones compartido.
+// Cada marco se reparte directo desde su ranura y recién después se libera.
+void* escuchar_compartida(void* parametros){
+    DatosPipe* datos = (DatosPipe*)parametros;
+    Compartida* compartida = datos->compartida;
+    CabeceraMarco cab;
+    const char* carga;
+    if(metricas_registrar(datos->metricas, "memoria compartida") == -1){
+        fprintf(stderr, "Error: No se pudieron registrar las métricas de la memoria compartida\n");
+        exit(1);
+    }
+
+    // Dormir en el futex hasta que llegue una petición o el reloj avise el fin
+    while(!compartida_terminada(compartida)){
+        int estado;
+        uint64_t antes = metricas_medir();
+        while((estado = compartida_tomar(compartida, &cab, &carga)) != 0){
+            if(estado == -1){
+                fprintf(stderr, "Marco inválido en memoria compartida, descartado\n");
+                continue;
+            }
+            repartir_marco(&cab, carga, datos);
+            compartida_soltar(compartida);
+            metricas_etapa(ETAPA_DECODIFICAR, antes);       // Incluye encolar la tarea
+            antes = metricas_medir();
         }
+        compartida_esperar_peticiones(compartida);
     }
+    return NULL;
 }
 
-void cerrar_cliente(char** f, char* ids[], int descriptores[], int* contador) {
-    char* id = f[1];
+// Copia de los contadores por agente, tomada bajo el cerrojo de la tabla
+// para imprimirla después sin frenar a los trabajadores
+typedef struct {
+    Cliente* clientes;
+    int cantidad, capacidad;
+} CopiaClientes;
+
+void copiar_cliente(Cliente* cliente, void* contexto){
+    CopiaClientes* copia = contexto;
+    if(copia->cantidad == copia->capacidad){
+        int capacidad = copia->capacidad > 0 ? copia->capacidad * 2 : 64;
+        Cliente* mayor = realloc(copia->clientes, capacidad * sizeof(Cliente));
+        if(mayor == NULL) return;                       // Se omite: es solo un volcado
+        copia->clientes = mayor;
+        copia->capacidad = capacidad;
+    }
+    copia->clientes[copia->cantidad++] = *cliente;
+}
 
-    // Buscar cliente y quitarlo del arreglo
-    for(int i=0; i<(*contador); i++){
-        if(strcmp(ids[i], id) == 0){
-            close(descriptores[i]);
-            (*contador)--;
+// Volcado de estadísticas en marcha: contadores, latencia por etapa,
+// profundidad de cada cola y contadores de cada agente conectado
+// (contexto: los datos del tubo)
+void imprimir_estadisticas(FILE* salida, void* contexto){
+    DatosPipe* d = contexto;
+    int minuto = (int)(reloj_horas(d->reloj) * 60);
+    int totales[3];
+    admision_totales(d->admision, totales);
+    fprintf(salida, "== ESTADISTICAS (hora simulada %d:%02d) ==\n", minuto / 60, minuto % 60);
+    fprintf(salida, "solicitudes: %d confirmadas, %d reprogramadas, %d denegadas\n", totales[0], totales[1], totales[2]);
+    for(int i=0; d->parques->cantidad > 1 && i<d->parques->cantidad; i++){
+        Parque* parque = &d->parques->lista[i];
+        fprintf(salida, "  parque %d: %d confirmadas, %d reprogramadas, %d denegadas\n", parque->id,
+                atomic_load(&parque->estadisticas[0]), atomic_load(&parque->estadisticas[1]),
+                atomic_load(&parque->estadisticas[2]));
+    }
+    metricas_imprimir(d->metricas, salida);
 
-            // Compactar arreglo
-            for(int j=i; j<(*contador); j++){
-                ids[j] = ids[j+1];
-                descriptores[j] = descriptores[j+1];
-            }
-            break;
-        }
+    fprintf(salida, "colas (actual/maximo):");
+    for(int i=0; i<d->num_trabajadores; i++){
+        int maximo;
+        int cantidad = cola_cantidad(&d->colas[i], &maximo);
+        fprintf(salida, " %d/%d", cantidad, maximo);
     }
+    fprintf(salida, "\n");
+    Salida* r = d->respuestas;
+    fprintf(salida, "respuestas: %ld directas, %ld por la cola (%ld tandas), %ld descartadas, %ld agentes cortados\n",
+            atomic_load(&r->directas), atomic_load(&r->diferidas), atomic_load(&r->tandas),
+            atomic_load(&r->descartadas), atomic_load(&r->cortados));
+
+    CopiaClientes copia = { NULL, 0, 0 };
+    clientes_recorrer(d->clientes, copiar_cliente, &copia);
+    fprintf(salida, "agentes conectados: %d\n", copia.cantidad);
+    for(int i=0; i<copia.cantidad; i++){
+        Cliente* cliente = &copia.clientes[i];
+        fprintf(salida, "  agente %u: %d confirmadas, %d reprogramadas, %d denegadas\n", cliente->agente,
+                cliente->solicitudes[0], cliente->solicitudes[1], cliente->solicitudes[2]);
+    }
+    free(copia.clientes);
 }
 
-void* ejecutar_reloj(void* parametros){
-    DatosReloj* datos = (DatosReloj*)parametros;
-    float anterior = -1;
-    
-    while(1){
-        // Calcular hora simulada
-        time_t actual;
-        pthread_mutex_lock(&bloqueo);
-        time(&actual);
-        *(datos->reloj) = (difftime(actual, datos->inicio_real) / datos->duracion_hora) + datos->inicio_sim;
-
-        // Imprimir cambios de hora
-        if((int)(*(datos->reloj)) != (int)anterior){
-            anterior = *(datos->reloj);
-            printf("\n========== TIEMPO: %.0f:00 ==========\n", *(datos->reloj));
-
-            // Cálculo de entradas y salidas por hora (lógica de ocupación del parque)
-            if( (int)(*(datos->reloj)) >= datos->apertura && (int)(*(datos->reloj)) <= datos->cierre ){
-                int posicion = (int)(*(datos->reloj)) - datos->apertura;
-
-                if(posicion == datos->total_horas){
-                    printf(">> Salidas: %d personas abandonan las instalaciones\n", datos->ocupacion[posicion-1]);
-                }else if(posicion > 0){
-                    int diferencia = datos->ocupacion[posicion-1] + datos->ingresos[posicion] - datos->ocupacion[posicion];
-                    printf(">> Ingresos: %d personas acceden al parque\n", datos->ingresos[posicion]);
-                    printf(">> Salidas: %d personas abandonan las instalaciones\n", diferencia);
-                }else if(posicion == 0){
-                    printf(">> Ingresos: %d personas acceden al parque\n", datos->ocupacion[posicion]);
-                }
+// Envía FIN a un cliente que sigue conectado y cierra su pipe cuando lo
+// lea (contexto: los datos del tubo)
+void despedir_cliente(Cliente* cliente, void* contexto){
+    DatosPipe* d = contexto;
+    CabeceraMarco fin = { .tipo = MSG_FIN, .agente = cliente->agente };
+    enviar_cliente(d, cliente->descriptor, fin, NULL, 0);
+    if(d->compartida == NULL) salida_cerrar(d->respuestas, cliente->descriptor);
+}
 
-                // Mostrar grupos que entran/salen
-                if(posicion == 0){
-                    printf("-- Grupos que ingresan:\n");
-                    for(int j=0; j<datos->contador_familias[posicion]; j++){
-                        printf("   * Grupo %s (ingreso confirmado)\n", datos->registros_familias[posicion][j]);
-                    }
-                }else if(posicion != datos->total_horas){
-                    printf("-- Grupos que ingresan:\n");
-                    for(int i=0; i<datos->contador_familias[posicion]; i++){
-                        for(int j=0; j<datos->contador_familias[posicion-1]; j++){
-                            if(datos->registros_familias[posicion][i] == datos->registros_familias[posicion-1][j]){
-                                break;
-                            }
-                            if(j == datos->contador_familias[posicion-1]-1){
-                                printf("   * Grupo %s (ingreso confirmado)\n", datos->registros_familias[posicion][i]);
-                            }
-                        }
-                    }
-                    printf("-- Grupos que se retiran:\n");
-                    for(int i=0; i<datos->contador_familias[posicion-1]; i++){
-                        for(int j=0; j<datos->contador_familias[posicion]; j++){
-                            if(datos->registros_familias[posicion-1][i] == datos->registros_familias[posicion][j]){
-                                break;
-                            }
-                            if(j == datos->contador_familias[posicion]-1){
-                                printf("   * Grupo %s (salida registrada)\n", datos->registros_familias[posicion-1][i]);
-                                free(datos->registros_familias[posicion-1][i]);
-                            }
-                        }
-                    }
-                }else{
-                    printf("-- Grupos que se retiran:\n");
-                    for(int j=0; j<datos->contador_familias[posicion-1]; j++){
-                        printf("   * Grupo %s (salida registrada)\n", datos->registros_familias[posicion-1][j]);
-                        free(datos->registros_familias[posicion-1][j]);
-                    }
-                }
-                printf("\n");
-            }
-        }
+// Despide a los agentes, informa cada parque y, si hay varios, el total de todos
+void generar_informe(DatosPipe* d, char* tubo, int fd_lect) {
+    // Enviar FIN a todos los clientes (sin esperar a que lo lean)
+    clientes_recorrer(d->clientes, despedir_cliente, d);
 
-        // Fin de simulación
-        if(*(datos->reloj) >= datos->fin_sim){
-            *(datos->terminado) = 1;
-            break;
-        }
+    admision_informe(d->admision);
 
-        pthread_mutex_unlock(&bloqueo);
-        usleep(100000);
+    if(fd_lect != -1){
+        close(fd_lect);
+        unlink(tubo); // Eliminar FIFO principal
     }
-    return NULL;
 }
 
-void* escuchar_tubo(void* parametros){
-    DatosPipe* datos = (DatosPipe*)parametros;
-    char buffer[TAM_BUFFER];
-    char* fragmentos[4];
+// Fila del informe del plan: voraz contra plan
+void comparar_fila(const char* titulo, long voraz, long plan){
+    printf("   %-26s %10ld %10ld %+10ld\n", titulo, voraz, plan, plan - voraz);
+}
 
-    while(*(datos->terminado) == 0){
-        ssize_t leidos = read(datos->descriptor_lectura, buffer, sizeof(buffer)-1);
+// Modo plan: lee todas las solicitudes del día, las reparte como lo haría
+// el controlador en línea (todas conocidas a la hora de inicio, llegando por
+// turnos de a una por archivo) y busca un plan mejor. Informa ambos y, con
+// 'salida', escribe el plan como "grupo,hora,personas,asignada".
+int planificar(char* archivos[], int num_archivos, Parque* parque, float momento, ObjetivoPlan objetivo,
+               int hilos, long intentos, const char* salida){
+    Agenda* agenda = &parque->agenda;
+    LectorCsv lectores[num_archivos];
+    int activos[num_archivos];                 // Archivos que todavía tienen solicitudes
+    int abiertos = 0, estado = 1;
+    ProblemaPlan problema;
+    SolucionPlan voraz = { NULL }, plan = { NULL };
+    RegistroCsv* registros = NULL;
+    int cantidad = 0, capacidad = 0;
+
+    if(plan_crear(&problema, agenda->franjas, agenda->visita, agenda->capacidad, objetivo) == -1){
+        printf("Error: Sin memoria para el plan.\n");
+        return 1;
+    }
+    for(; abiertos<num_archivos; abiertos++){
+        if(lector_abrir(&lectores[abiertos], archivos[abiertos]) == -1){
+            printf("Error: No se pudo abrir %s.\n", archivos[abiertos]);
+            goto salir;
+        }
+    }
 
-        if(leidos > 0){
-            buffer[leidos] = '\0';
-            int cantidad = dividir_mensaje(buffer, fragmentos);
+    // Una solicitud de cada archivo por turno, hasta agotarlos
+    for(int k=0; k<num_archivos; k++) activos[k] = 1;
+    for(int quedan = num_archivos; quedan > 0; ){
+        for(int k=0; k<num_archivos; k++){
+            if(!activos[k]) continue;
+            RegistroCsv registro;
+            int leido = lector_siguiente(&lectores[k], &registro);
+            if(leido == 0){
+                activos[k] = 0;
+                quedan--;
+                continue;
+            }
+            if(leido == -1){
+                fprintf(stderr, "%s:%d: %s (se omite)\n", archivos[k], lectores[k].linea, lectores[k].error);
+                continue;
+            }
 
-            pthread_mutex_lock(&bloqueo);
-            
-            if(cantidad == 2){                      // Registro de nuevo cliente
-                registrar_cliente(fragmentos, datos->ids_clientes, datos->descriptores_escritura, 
-                                 datos->num_clientes, *(datos->reloj));
+            PedidoPlan pedido = { -1, -1, registro.personas };
+            if(admision_valida(registro.hora, registro.personas, momento, parque)){
+                pedido.desde = agenda_franja_desde(agenda, registro.hora, momento);
+                pedido.pedida = agenda_franja_pedida(agenda, registro.hora, momento);
+                if(pedido.desde < 0) pedido.desde = 0;
             }
-            else if(cantidad == 4){                 // Solicitud de reserva
-                procesar_peticion(fragmentos, datos);
+            if(cantidad == capacidad){
+                capacidad = capacidad > 0 ? capacidad * 2 : 1024;
+                RegistroCsv* mayor = realloc(registros, capacidad * sizeof(RegistroCsv));
+                if(mayor == NULL){
+                    printf("Error: Sin memoria para las solicitudes.\n");
+                    goto salir;
+                }
+                registros = mayor;
             }
-            else if(cantidad == 3){                 // Cierre de cliente
-                cerrar_cliente(fragmentos, datos->ids_clientes, datos->descriptores_escritura, 
-                              datos->num_clientes);
+            if(plan_agregar(&problema, pedido) == -1){
+                printf("Error: Sin memoria para las solicitudes.\n");
+                goto salir;
             }
-            
-            pthread_mutex_unlock(&bloqueo);
+            registros[cantidad++] = registro;
         }
-        usleep(1000);
     }
-    return NULL;
-}
 
-void generar_informe(int horas, int ocupacion[], int estadisticas[], int clientes, 
-                     int descriptores[], int apertura, char* tubo, int fd_lect) {
-    char* msg_fin = "FIN";
-    
-    // Enviar "FIN" a todos los clientes
-    for(int i=0; i<clientes; i++){
-        write(descriptores[i], msg_fin, strlen(msg_fin));
-        close(descriptores[i]);
+    // Voraz (lo que haría el controlador en línea) y búsqueda desde ahí
+    struct timespec t0, t1;
+    if(solucion_crear(&voraz, &problema) == -1 || solucion_crear(&plan, &problema) == -1 ||
+       plan_voraz(&problema, &voraz) == -1){
+        printf("Error: Sin memoria para el plan.\n");
+        goto salir;
+    }
+    memcpy(plan.inicio, voraz.inicio, (cantidad > 0 ? cantidad : 1) * sizeof(int));
+    plan.grupos = voraz.grupos;
+    plan.personas = voraz.personas;
+    plan.confirmadas = voraz.confirmadas;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if(plan_mejorar(&problema, &plan, hilos, RONDAS_PLAN, intentos, 1) == -1){
+        printf("Error: No se pudo ejecutar la búsqueda del plan.\n");
+        goto salir;
     }
-    
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double segundos = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    long cota = plan_cota(&problema);
+
     printf("\n╔════════════════════════════════════════╗\n");
-    printf("║     INFORME FINAL DE OPERACIONES      ║\n");
+    printf("║        PLAN DEL DIA (FUERA DE LINEA)   ║\n");
     printf("╚════════════════════════════════════════╝\n\n");
-    
-    // Cálculo de franjas con mayor ocupación
-    int maximo = 0;
-    for(int i=0; i<horas; i++){
-        if(ocupacion[i] > maximo){
-            maximo = ocupacion[i];
-        }
-    }
-    printf("📊 PERIODOS DE MAXIMA OCUPACION:\n");
-    for(int i=0; i<horas; i++){
-        if(ocupacion[i] == maximo){
-            printf("   └─ Franja horaria %d:00 → %d visitantes\n", i+apertura, maximo);
-        }
-    }
+    printf("📂 %d solicitudes de %d archivos; capacidad %d, %d franjas de %d min, visita de %d franjas\n\n",
+           cantidad, num_archivos, agenda->capacidad, agenda->franjas, agenda->minutos, agenda->visita);
+    printf("   %-26s %10s %10s %10s\n", "", "voraz", "plan", "diferencia");
+    comparar_fila("Grupos admitidos", voraz.grupos, plan.grupos);
+    comparar_fila("Personas admitidas", voraz.personas, plan.personas);
+    comparar_fila("Confirmadas", voraz.confirmadas, plan.confirmadas);
+    comparar_fila("Reprogramadas", voraz.grupos - voraz.confirmadas, plan.grupos - plan.confirmadas);
+    comparar_fila("Denegadas", cantidad - voraz.grupos, cantidad - plan.grupos);
+    long admitido_voraz = objetivo == OBJETIVO_PERSONAS ? voraz.personas : voraz.grupos;
+    long admitido_plan = objetivo == OBJETIVO_PERSONAS ? plan.personas : plan.grupos;
+    printf("\n📈 Objetivo (%s): %+.1f %% sobre el voraz; cota superior %ld (el plan llega al %.1f %%)\n",
+           objetivo == OBJETIVO_PERSONAS ? "personas" : "grupos",
+           admitido_voraz > 0 ? 100.0 * (admitido_plan - admitido_voraz) / admitido_voraz : 0.0,
+           cota, cota > 0 ? 100.0 * admitido_plan / cota : 100.0);
+    printf("   Búsqueda: %d hilos x %d rondas x %ld intentos en %.2f s\n", hilos, RONDAS_PLAN, intentos, segundos);
+    printf("\n════════════════════════════════════════\n");
 
-    // Cálculo de franjas con menor ocupación
-    int minimo = maximo;
-    for(int i=0; i<horas; i++){
-        if(ocupacion[i] < minimo){
-            minimo = ocupacion[i];
+    if(salida != NULL){
+        FILE* archivo = fopen(salida, "w");
+        if(archivo == NULL){
+            perror("Error al escribir el plan");
+            goto salir;
         }
-    }
-    printf("\n📉 PERIODOS DE MINIMA OCUPACION:\n");
-    for(int i=0; i<horas; i++){
-        if(ocupacion[i] == minimo){
-            printf("   └─ Franja horaria %d:00 → %d visitantes\n", i+apertura, minimo);
+        for(int i=0; i<cantidad; i++){
+            fprintf(archivo, "%.*s,%d,%d,", registros[i].largo, registros[i].nombre, registros[i].hora,
+                    registros[i].personas);
+            if(plan.inicio[i] < 0){
+                fprintf(archivo, "denegada\n");
+            } else {
+                int minuto = agenda_minuto(agenda, plan.inicio[i]);
+                fprintf(archivo, "%d:%02d\n", minuto / 60, minuto % 60);
+            }
         }
+        fclose(archivo);
     }
+    estado = 0;
 
-    // Resumen de estadísticas de solicitudes
-    printf("\n📋 RESUMEN DE SOLICITUDES PROCESADAS:\n");
-    printf("   ✓ Aprobadas en horario solicitado: %d\n", estadisticas[0]);
-    printf("   ↻ Reprogramadas a otro horario: %d\n", estadisticas[1]);
-    printf("   ✗ Rechazadas definitivamente: %d\n", estadisticas[2]);
-    printf("\n════════════════════════════════════════\n");
-
-    close(fd_lect);
-    unlink(tubo); // Eliminar FIFO principal
+salir:
+    solucion_destruir(&voraz);
+    solucion_destruir(&plan);
+    plan_destruir(&problema);
+    free(registros);
+    for(int k=0; k<abiertos; k++) lector_cerrar(&lectores[k]);
+    return estado;
 }
 
 int main(int argc, char *argv[]){
-    int inicio, fin, duracion, capacidad;
+    int inicio, fin, capacidad = 0;
+    float duracion;
     char* tubo;
-    time_t momento_inicio;
-    volatile float reloj = 0;
-    int fd_lect;
-    volatile char terminado = 0;
-    char* ids[LIMITE_CLIENTES];
-    int descriptores[LIMITE_CLIENTES];
-    int clientes_activos = 0;
-    int estadisticas[3]={0,0,0};  // [confirmadas, reprogramadas, denegadas]
+    Reloj reloj;
+    int fd_lect, fd_guardia, evento_fin;
+    TablaClientes clientes;
+    float visita = 2;             // Horas por visita (por defecto 2)
+    int minutos = 60;             // Minutos por franja (por defecto, una franja por hora)
+    int hilos = sysconf(_SC_NPROCESSORS_ONLN);   // Trabajadores (por defecto, uno por núcleo)
+    char* transporte = "fifo";    // fifo: FIFOs con nombre; shm: memoria compartida
+    Compartida* compartida = NULL;
+    char nombre_compartida[NAME_MAX];
+    Metricas metricas;
+    ServidorEstadisticas servidor_estadisticas;
+    Bitacora bitacora;
+    int nivel = NIVEL_EVENTOS;    // Bitácora: 0 nada ... 3 detalle
+    char* formato = "texto";      // texto, json o binario
+    char* salida = NULL;          // Archivo de la bitácora (NULL: stdout)
+    char* prefijo_diario = NULL;  // Diario de recuperación (NULL: sin diario)
+    char* ruta_parques = NULL;    // Configuración de parques (NULL: uno solo, con -t/-m/-d)
+    Parques parques;
+    char* planes[MAX_ARCHIVOS_PLAN];  // Modo plan: archivos de solicitudes del día
+    int num_planes = 0;
+    char* objetivo = "personas";  // Modo plan: personas o grupos
+    long intentos = 20000;        // Modo plan: intentos por hilo y ronda
+    char* ruta_traza = NULL;      // Traza de lo decidido (NULL: no se graba)
+    Traza traza;
+    Admision admision;
+    Salida respuestas;            // Colas de salida a los agentes (solo con FIFOs)
 
     // Leer parámetros
-    parsear_argumentos(argc, argv, &inicio, &fin, &duracion, &capacidad, &tubo);
-
-    // Validar entrada
-    if(inicio >= fin || duracion <= 0 || capacidad <= 0){
+    parsear_argumentos(argc, argv, &inicio, &fin, &duracion, &capacidad, &tubo, &visita, &minutos, &hilos,
+                       &transporte, &nivel, &formato, &salida, &prefijo_diario, &ruta_parques,
+                       planes, &num_planes, &objetivo, &intentos, &ruta_traza);
+    int usar_fifo = strcmp(transporte, "shm") != 0;
+    FormatoBitacora formato_bitacora = strcmp(formato, "json") == 0 ? FORMATO_JSON :
+                                       strcmp(formato, "binario") == 0 ? FORMATO_BINARIO : FORMATO_TEXTO;
+
+    // Validar entrada: las franjas dividen la hora y la visita ocupa franjas enteras
+    // (con -P cada parque trae lo suyo)
+    int minutos_visita = (int)(visita * 60 + 0.5f);
+    int un_parque = ruta_parques == NULL;
+    if(inicio >= fin || duracion <= 0 || hilos <= 0 ||
+       (un_parque && (capacidad <= 0 || minutos <= 0 || 60 % minutos != 0 ||
+                      minutos_visita <= 0 || minutos_visita % minutos != 0)) ||
+       (usar_fifo && strcmp(transporte, "fifo") != 0) || nivel < NIVEL_NADA || nivel > NIVEL_DETALLE ||
+       (formato_bitacora == FORMATO_TEXTO && strcmp(formato, "texto") != 0) ||
+       (num_planes > 0 && (!un_parque || intentos < 0 ||
+                           (strcmp(objetivo, "personas") != 0 && strcmp(objetivo, "grupos") != 0)))){
         printf("Error: Parámetros de ejecución inválidos.\n");
         return(1);
     }
 
-    pthread_mutex_init(&bloqueo, NULL);
-    
-    // Ajustar apertura/cierre reales del parque (7–19)
-    int apertura = (inicio <= 7) ? 7 : inicio;
-    int cierre = (fin <= 19) ? fin : 19;
-    int horas = (fin == apertura) ? 1 : cierre - apertura;
-    
-    // Inicializar arrays de ocupación
-    int ocupacion[horas];
-    for(int i=0;i<horas;i++){
-        ocupacion[i]=0;
+    if(clientes_crear(&clientes, CLIENTES_INICIAL) == -1){
+        printf("Error: Sin memoria para la tabla de clientes.\n");
+        return(1);
+    }
+
+    // Parques: los de -P, o uno solo (ID 0, de 7 a 19) con -t, -m y -d
+    ConfigParque unico = { 0, capacidad, 7, 19, minutos, minutos_visita };
+    ConfigParque* configs = &unico;
+    int num_parques = 1;
+    if(!un_parque && (num_parques = parques_leer(ruta_parques, &configs)) == -1){
+        printf("Error: Configuración de parques inválida.\n");
+        return(1);
     }
 
-    int ingresos[horas];
-    for(int i=0;i<horas;i++){
-        ingresos[i]=0;
+    // Ocupación, índice y registros de familias de cada parque, con su
+    // horario real recortado al de la simulación
+    int creados = parques_crear(&parques, configs, num_parques, inicio, fin);
+    if(configs != &unico) free(configs);
+    if(creados == -1){
+        printf("Error: Sin memoria para las agendas de los parques.\n");
+        return(1);
     }
 
-    int contadores[horas];
-    for(int i=0;i<horas;i++){
-        contadores[i]=0;
+    // Modo plan: no atiende agentes, solo planifica el día y termina
+    if(num_planes > 0){
+        int estado = planificar(planes, num_planes, &parques.lista[0], (float)inicio,
+                                strcmp(objetivo, "grupos") == 0 ? OBJETIVO_GRUPOS : OBJETIVO_PERSONAS,
+                                hilos, intentos, salida);
+        parques_destruir(&parques);
+        clientes_destruir(&clientes);
+        return estado;
     }
 
-    // Reservar memoria para registros de familias
-    char*** registros = malloc(horas * sizeof(char**));
-    for(int i=0;i<horas;i++) registros[i] = malloc(capacidad * sizeof(char*));
+    // Diario: rehacer lo que se había decidido antes de una caída. Con
+    // varios parques, cada uno lleva el suyo en <prefijo>.<id>.
+    for(int i=0; prefijo_diario != NULL && i<parques.cantidad; i++){
+        Parque* parque = &parques.lista[i];
+        int largo = strlen(prefijo_diario) + 16;
+        parque->prefijo_diario = malloc(largo);
+        if(parque->prefijo_diario == NULL){
+            printf("Error: Sin memoria para el diario.\n");
+            return(1);
+        }
+        if(parques.cantidad > 1) snprintf(parque->prefijo_diario, largo, "%s.%d", prefijo_diario, parque->id);
+        else snprintf(parque->prefijo_diario, largo, "%s", prefijo_diario);
+
+        Recuperacion recuperacion;
+        if(diario_abrir(&parque->diario, parque->prefijo_diario, &parque->agenda, &recuperacion) == -1){
+            printf("Error: No se pudo abrir el diario %s.\n", parque->prefijo_diario);
+            return(1);
+        }
+        parque->con_diario = 1;
+        if(recuperacion.reservas_instantanea > 0 || recuperacion.registros_diario > 0){
+            printf("Recuperadas %d reservas de la instantánea y %ld registros del diario en %.2f s\n",
+                   recuperacion.reservas_instantanea, recuperacion.registros_diario, recuperacion.segundos);
+        }
+        for(int t=0; t<3; t++) parque->estadisticas[t] = recuperacion.conteo[t];
+    }
 
     // Inicializar estructuras internas
-    preparar_sistema(tubo, &momento_inicio, &fd_lect);
+    preparar_sistema(tubo, usar_fifo, &fd_lect, &fd_guardia, &evento_fin);
+
+    // Un agente que se va deja su FIFO sin lector: write() da EPIPE en vez de matar al controlador
+    signal(SIGPIPE, SIG_IGN);
+
+    // Transporte por memoria compartida: el segmento toma el nombre del FIFO
+    if(!usar_fifo){
+        compartida_nombre(tubo, nombre_compartida, sizeof(nombre_compartida));
+        compartida = compartida_crear(nombre_compartida);
+        if(compartida == NULL){
+            perror("Error al crear la memoria compartida");
+            return(1);
+        }
+    }
 
-    // Crear hilos del reloj y pipe
-    pthread_t hilo_reloj, hilo_tubo;
+    // Núcleo de admisión, que graba cada decisión si se pidió la traza
+    if(ruta_traza != NULL && traza_crear(&traza, ruta_traza, 1) == -1){
+        perror("Error al crear la traza");
+        return(1);
+    }
+    admision_iniciar(&admision, &parques, &clientes, ruta_traza != NULL ? &traza : NULL);
 
-    DatosReloj parametros_reloj = {duracion, momento_inicio, apertura, cierre, inicio, fin, 
-                                   &reloj, horas, ocupacion, registros, contadores, &terminado, ingresos};
-    DatosPipe parametros_tubo = {fd_lect, ids, descriptores, &clientes_activos, &reloj, apertura, cierre, 
-                                inicio, fin, capacidad, ocupacion, horas, registros, contadores, 
-                                &terminado, estadisticas, ingresos};
+    // Reloj de la simulación: arranca en la hora de inicio
+    if(reloj_iniciar(&reloj, inicio, duracion, 0) == -1){
+        perror("Error al crear el temporizador del reloj");
+        return(1);
+    }
 
+    // Histogramas por etapa; cada hilo registra los suyos al arrancar
+    // (los trabajadores y el que lee el FIFO o la memoria compartida)
+    if(metricas_crear(&metricas, hilos + 1) == -1){
+        printf("Error: No se pudieron iniciar las métricas.\n");
+        return(1);
+    }
+
+    // Bitácora: los hilos anotan eventos y un escritor aparte los vuelca
+    int fd_bitacora = STDOUT_FILENO;
+    if(salida != NULL){
+        fd_bitacora = open(salida, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if(fd_bitacora == -1){
+            perror("Error al abrir el archivo de la bitácora");
+            return(1);
+        }
+    }
+    // Anotan los trabajadores y el reloj
+    if(bitacora_crear(&bitacora, fd_bitacora, formato_bitacora, nivel, metricas.ticks_por_ns, hilos + 1) == -1){
+        printf("Error: No se pudo crear el hilo de la bitácora.\n");
+        return(1);
+    }
+
+    // Una cola acotada por trabajador
+    Cola colas[hilos];
+    for(int i=0; i<hilos; i++){
+        if(cola_crear(&colas[i], CAPACIDAD_COLA, sizeof(Tarea)) == -1){
+            printf("Error: Sin memoria para las colas de trabajo.\n");
+            return(1);
+        }
+    }
+
+    // Crear hilos del reloj, pipe y trabajadores
+    pthread_t hilo_reloj, hilo_tubo, hilos_trabajo[hilos];
+
+    DatosReloj parametros_reloj = {&reloj, fin, &admision, evento_fin, compartida, &bitacora};
+    DatosPipe parametros_tubo = {fd_lect, &clientes, &reloj, inicio, fin, &parques, evento_fin, colas, hilos,
+                                compartida, &metricas, &bitacora, &admision, &respuestas};
+    DatosTrabajador parametros_trabajo[hilos];
+
+    // Estadísticas en marcha (socket y SIGUSR1): antes que los demás hilos,
+    // que heredan SIGUSR1 bloqueada
+    if(estadisticas_iniciar(&servidor_estadisticas, tubo, evento_fin, imprimir_estadisticas, &parametros_tubo) == -1){
+        printf("Error: No se pudo crear el hilo de estadísticas.\n");
+        return(1);
+    }
+
+    // Respuestas no bloqueantes, por FIFO o por los anillos, con un escritor
+    // para los agentes lentos (también hereda SIGUSR1 bloqueada)
+    if(salida_crear(&respuestas, compartida) == -1){
+        printf("Error: No se pudo crear el hilo de respuestas.\n");
+        return(1);
+    }
+
+    for(int i=0; i<hilos; i++){
+        parametros_trabajo[i] = (DatosTrabajador){ &parametros_tubo, &colas[i], i };
+        pthread_create(&hilos_trabajo[i], NULL, atender_tareas, &parametros_trabajo[i]);
+    }
     pthread_create(&hilo_reloj, NULL, ejecutar_reloj, &parametros_reloj);
-    pthread_create(&hilo_tubo, NULL, escuchar_tubo, &parametros_tubo);
+    pthread_create(&hilo_tubo, NULL, usar_fifo ? escuchar_tubo : escuchar_compartida, &parametros_tubo);
 
-    // Esperar hilos
+    // Esperar hilos; los trabajadores terminan de vaciar sus colas
     pthread_join(hilo_reloj, NULL);
     pthread_join(hilo_tubo, NULL);
+    estadisticas_terminar(&servidor_estadisticas);
+    for(int i=0; i<hilos; i++) cola_cerrar(&colas[i]);
+    for(int i=0; i<hilos; i++){
+        pthread_join(hilos_trabajo[i], NULL);
+        cola_destruir(&colas[i]);
+    }
+
+    if(ruta_traza != NULL) traza_cerrar(&traza);
+
+    // El día terminó: no queda nada que recuperar
+    for(int i=0; i<parques.cantidad; i++){
+        if(parques.lista[i].con_diario) diario_cerrar(&parques.lista[i].diario, 1);
+    }
+
+    // Vaciar la bitácora antes del informe, que va directo a stdout
+    bitacora_terminar(&bitacora);
+    if(fd_bitacora != STDOUT_FILENO) close(fd_bitacora);
 
     // Informe final
-    generar_informe(horas, ocupacion, estadisticas, clientes_activos, descriptores, apertura, tubo, fd_lect);
+    generar_informe(&parametros_tubo, tubo, fd_lect);
+    salida_terminar(&respuestas, ESPERA_FIN_MS);
 
-    pthread_mutex_destroy(&bloqueo);
+    clientes_destruir(&clientes);
+    if(fd_guardia != -1) close(fd_guardia);
+    if(compartida != NULL) compartida_destruir(compartida, nombre_compartida);
+    close(evento_fin);
+    metricas_destruir(&metricas);
+    reloj_destruir(&reloj);
 
     // Liberar memoria
-    for (int i = 0; i < horas; i++) {
-        free(registros[i]);
-    }
-    free(registros);
+    parques_destruir(&parques);
 
     return 0;
 }
\ No newline at end of file
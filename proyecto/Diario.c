@@ -0,0 +1,539 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Diario.h"
+
+// Parámetros del parque: un diario solo se aplica sobre la misma agenda
+typedef struct {
+    int32_t apertura, minutos, franjas, capacidad, visita;
+} ConfiguracionDiario;
+
+// Cabecera de cada archivo <prefijo>.diario.<generación>
+typedef struct {
+    char magia[4];                // "DIA1"
+    ConfiguracionDiario configuracion;
+    uint64_t generacion;
+} CabeceraDiario;
+
+// Cabecera de <prefijo>.instantanea. Le siguen 'reservas' Reserva tal cual
+// están en la agenda y los 'nombres' textos en orden de ID, cada uno como su
+// largo (uint16_t) y sus bytes: un nombre puede traer '\0' adentro.
+typedef struct {
+    char magia[4];                // "INS2"
+    ConfiguracionDiario configuracion;
+    uint64_t generacion;          // Primer diario que falta aplicar
+    int64_t conteo[3];
+    int64_t reservas;
+    int64_t nombres;
+    int64_t bytes_nombres;
+} CabeceraInstantanea;
+
+// Lo que hace falta para escribir una instantánea fuera de los cerrojos.
+// Los registros de reserva y los textos no se mueven ni cambian una vez
+// escritos; solo se copian las tablas que los ubican.
+typedef struct {
+    Diario* d;
+    uint64_t generacion;
+    long conteo[3];
+    int reservas;
+    Reserva** bloques;
+    int nombres;
+    const char** textos;
+    int* largos;
+} CopiaInstantanea;
+
+static void ruta_diario(const Diario* d, uint64_t generacion, char ruta[PATH_MAX]){
+    snprintf(ruta, PATH_MAX, "%s.diario.%llu", d->prefijo, (unsigned long long)generacion);
+}
+
+static ConfiguracionDiario configuracion(const Agenda* ag){
+    return (ConfiguracionDiario){ ag->apertura, ag->minutos, ag->franjas, ag->capacidad, ag->visita };
+}
+
+// Verificación de un registro: mezcla sus campos con el hash del nombre
+// (nombres_hash, que la agenda ya calculó fuera del cerrojo)
+static uint32_t sumar_registro(const RegistroDiario* r, uint32_t hash_nombre){
+    uint64_t h = hash_nombre ^ ((uint64_t)r->tipo << 32 | (uint64_t)r->contador << 40 | (uint64_t)r->largo << 48);
+    h = (h ^ (uint32_t)r->franja) * 0x9E3779B97F4A7C15ull;
+    h = (h ^ (uint32_t)r->personas) * 0xC2B2AE3D27D4EB4Full;
+    return (uint32_t)(h >> 32);
+}
+
+// write() completo. 0 si ok, -1 si falló.
+static int escribir_todo(int fd, const char* datos, size_t largo){
+    while(largo > 0){
+        ssize_t n = write(fd, datos, largo);
+        if(n == -1){
+            if(errno == EINTR) continue;
+            return -1;
+        }
+        datos += n;
+        largo -= n;
+    }
+    return 0;
+}
+
+// fsync del directorio del prefijo: crear, renombrar y borrar quedan firmes
+static void sincronizar_directorio(const char* prefijo){
+    char directorio[PATH_MAX];
+    const char* barra = strrchr(prefijo, '/');
+    if(barra == NULL) strcpy(directorio, ".");
+    else snprintf(directorio, sizeof(directorio), "%.*s", barra == prefijo ? 1 : (int)(barra - prefijo), prefijo);
+
+    int fd = open(directorio, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(fd == -1) return;
+    fsync(fd);
+    close(fd);
+}
+
+// Crea el archivo de la generación con su cabecera. Descriptor, o -1.
+static int crear_diario(Diario* d, uint64_t generacion){
+    char ruta[PATH_MAX];
+    ruta_diario(d, generacion, ruta);
+    int fd = open(ruta, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if(fd == -1){
+        perror("Error al crear el diario");
+        return -1;
+    }
+    CabeceraDiario cabecera = { {'D', 'I', 'A', '1'}, configuracion(d->agenda), generacion };
+    if(escribir_todo(fd, (const char*)&cabecera, sizeof(cabecera)) == -1 || fdatasync(fd) == -1){
+        perror("Error al escribir el diario");
+        close(fd);
+        return -1;
+    }
+    sincronizar_directorio(d->prefijo);
+    return fd;
+}
+
+// Borra los diarios anteriores a 'generacion' (seguidos, hacia atrás)
+static void borrar_diarios(Diario* d, uint64_t generacion){
+    char ruta[PATH_MAX];
+    while(generacion-- > 0){
+        ruta_diario(d, generacion, ruta);
+        if(unlink(ruta) == -1) break;
+    }
+}
+
+// Escribe la instantánea en un temporal, la sincroniza y la renombra: en
+// disco siempre hay una instantánea completa. Después borra los diarios
+// que ya contiene. 0 si ok, -1 si falló.
+static int escribir_instantanea(CopiaInstantanea* c){
+    Diario* d = c->d;
+    char ruta[PATH_MAX], temporal[PATH_MAX];
+    snprintf(ruta, sizeof(ruta), "%s.instantanea", d->prefijo);
+    snprintf(temporal, sizeof(temporal), "%s.instantanea.tmp", d->prefijo);
+
+    CabeceraInstantanea cabecera = { {'I', 'N', 'S', '2'}, configuracion(d->agenda), c->generacion,
+                                     { c->conteo[0], c->conteo[1], c->conteo[2] }, c->reservas, c->nombres, 0 };
+    for(int i=0; i<c->nombres; i++) cabecera.bytes_nombres += sizeof(uint16_t) + c->largos[i];
+
+    FILE* archivo = fopen(temporal, "we");
+    if(archivo == NULL){
+        perror("Error al crear la instantánea");
+        return -1;
+    }
+    setvbuf(archivo, NULL, _IOFBF, 1 << 20);
+    fwrite(&cabecera, sizeof(cabecera), 1, archivo);
+    for(int k=0; k<c->reservas; k+=RESERVAS_POR_BLOQUE){
+        int cantidad = c->reservas - k < RESERVAS_POR_BLOQUE ? c->reservas - k : RESERVAS_POR_BLOQUE;
+        fwrite(c->bloques[k / RESERVAS_POR_BLOQUE], sizeof(Reserva), cantidad, archivo);
+    }
+    for(int i=0; i<c->nombres; i++){
+        uint16_t largo = c->largos[i];
+        fwrite(&largo, sizeof(largo), 1, archivo);
+        fwrite(c->textos[i], largo, 1, archivo);
+    }
+
+    int error = fflush(archivo) != 0 || ferror(archivo) || fsync(fileno(archivo)) == -1;
+    if(fclose(archivo) != 0) error = 1;
+    if(error || rename(temporal, ruta) == -1){
+        perror("Error al escribir la instantánea");
+        unlink(temporal);
+        return -1;
+    }
+    sincronizar_directorio(d->prefijo);
+    borrar_diarios(d, c->generacion);
+    return 0;
+}
+
+// Copia las tablas de la agenda (llamar con su cerrojo tomado, o sin
+// reservas en curso). NULL sin memoria.
+static CopiaInstantanea* copiar_agenda(Diario* d, uint64_t generacion, const long conteo[3]){
+    Agenda* ag = d->agenda;
+    CopiaInstantanea* c = malloc(sizeof(CopiaInstantanea));
+    if(c == NULL) return NULL;
+    int bloques = (ag->num_reservas + RESERVAS_POR_BLOQUE - 1) / RESERVAS_POR_BLOQUE;
+    *c = (CopiaInstantanea){ d, generacion, { conteo[0], conteo[1], conteo[2] }, ag->num_reservas,
+                             malloc((bloques > 0 ? bloques : 1) * sizeof(Reserva*)), ag->nombres.cantidad,
+                             malloc((ag->nombres.cantidad > 0 ? ag->nombres.cantidad : 1) * sizeof(char*)),
+                             malloc((ag->nombres.cantidad > 0 ? ag->nombres.cantidad : 1) * sizeof(int)) };
+    if(c->bloques == NULL || c->textos == NULL || c->largos == NULL){
+        free(c->bloques);
+        free(c->textos);
+        free(c->largos);
+        free(c);
+        return NULL;
+    }
+    memcpy(c->bloques, ag->bloques, bloques * sizeof(Reserva*));
+    memcpy(c->textos, ag->nombres.textos, c->nombres * sizeof(char*));
+    memcpy(c->largos, ag->nombres.largos, c->nombres * sizeof(int));
+    return c;
+}
+
+static void liberar_copia(CopiaInstantanea* c){
+    free(c->bloques);
+    free(c->textos);
+    free(c->largos);
+    free(c);
+}
+
+static void* hilo_instantanea(void* parametros){
+    CopiaInstantanea* c = parametros;
+    escribir_instantanea(c);
+    liberar_copia(c);
+    return NULL;
+}
+
+// Mapea un archivo entero para leerlo de corrido. NULL si no existe o está vacío.
+static const char* mapear(const char* ruta, size_t* tam){
+    int fd = open(ruta, O_RDONLY | O_CLOEXEC);
+    if(fd == -1) return NULL;
+    struct stat datos;
+    if(fstat(fd, &datos) == -1 || datos.st_size == 0){
+        close(fd);
+        return NULL;
+    }
+    void* base = mmap(NULL, datos.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) return NULL;
+    madvise(base, datos.st_size, MADV_SEQUENTIAL);
+    *tam = datos.st_size;
+    return base;
+}
+
+// Carga la instantánea: nombres (recuperan sus mismos IDs) y reservas.
+// 1 si había una, 0 si no, -1 si no corresponde o está dañada.
+static int cargar_instantanea(Diario* d, Agenda* ag, uint64_t* generacion, Recuperacion* rec){
+    char ruta[PATH_MAX];
+    snprintf(ruta, sizeof(ruta), "%s.instantanea", d->prefijo);
+    size_t tam;
+    const char* base = mapear(ruta, &tam);
+    if(base == NULL) return 0;
+
+    CabeceraInstantanea cabecera;
+    ConfiguracionDiario propia = configuracion(ag);
+    if(tam >= sizeof(cabecera)) memcpy(&cabecera, base, sizeof(cabecera));
+    if(tam < sizeof(cabecera) || memcmp(cabecera.magia, "INS2", 4) != 0 ||
+       memcmp(&cabecera.configuracion, &propia, sizeof(propia)) != 0 || cabecera.reservas < 0 ||
+       cabecera.nombres < 0 || cabecera.bytes_nombres < 0 ||
+       tam != sizeof(cabecera) + cabecera.reservas * sizeof(Reserva) + cabecera.bytes_nombres){
+        fprintf(stderr, "La instantánea %s es de otra configuración del parque o está dañada\n", ruta);
+        munmap((void*)base, tam);
+        return -1;
+    }
+
+    const Reserva* reservas = (const Reserva*)(base + sizeof(cabecera));
+    const char* texto = (const char*)(reservas + cabecera.reservas);
+    const char* fin = base + tam;
+    int estado = 1;
+    for(int64_t i=0; i<cabecera.nombres && estado == 1; i++){
+        uint16_t largo;
+        if(fin - texto < (long)sizeof(largo)){
+            estado = -1;
+            break;
+        }
+        memcpy(&largo, texto, sizeof(largo));
+        texto += sizeof(largo);
+        if(fin - texto < largo ||
+           nombres_internar(&ag->nombres, texto, largo, nombres_hash(texto, largo)) != i) estado = -1;
+        else texto += largo;
+    }
+    for(int64_t k=0; k<cabecera.reservas && estado == 1; k++){
+        if(agenda_restaurar(ag, reservas[k].inicio, reservas[k].personas, reservas[k].nombre) == -1) estado = -1;
+    }
+    munmap((void*)base, tam);
+    if(estado == -1){
+        fprintf(stderr, "La instantánea %s está dañada (o falta memoria)\n", ruta);
+        return -1;
+    }
+
+    *generacion = cabecera.generacion;
+    rec->reservas_instantanea = cabecera.reservas;
+    for(int t=0; t<3; t++) rec->conteo[t] = cabecera.conteo[t];
+    return 1;
+}
+
+// Aplica un diario. 1 si existía, 0 si no, -1 si no corresponde. Termina en
+// el primer registro cortado o que no verifica (lo último antes de la caída).
+static int aplicar_diario(Diario* d, Agenda* ag, uint64_t generacion, Recuperacion* rec){
+    char ruta[PATH_MAX];
+    ruta_diario(d, generacion, ruta);
+    if(access(ruta, F_OK) == -1) return 0;
+    size_t tam;
+    const char* base = mapear(ruta, &tam);
+    if(base == NULL) return 1;                          // Vacío: caída al crearlo
+
+    CabeceraDiario cabecera;
+    ConfiguracionDiario propia = configuracion(ag);
+    if(tam < sizeof(cabecera)){                         // Cabecera a medio escribir: igual de vacío
+        munmap((void*)base, tam);
+        return 1;
+    }
+    memcpy(&cabecera, base, sizeof(cabecera));
+    if(memcmp(cabecera.magia, "DIA1", 4) != 0 || cabecera.generacion != generacion ||
+       memcmp(&cabecera.configuracion, &propia, sizeof(propia)) != 0){
+        fprintf(stderr, "El diario %s es de otra configuración del parque o está dañado\n", ruta);
+        munmap((void*)base, tam);
+        return -1;
+    }
+
+    size_t posicion = sizeof(cabecera);
+    int estado = 1;
+    while(posicion + sizeof(RegistroDiario) <= tam){
+        RegistroDiario r;
+        memcpy(&r, base + posicion, sizeof(r));
+        const char* nombre = base + posicion + sizeof(r);
+        if(posicion + sizeof(r) + r.largo > tam) break;
+        uint32_t hash = nombres_hash(nombre, r.largo);
+        if(sumar_registro(&r, hash) != r.suma || r.contador > 2 || r.personas <= 0 ||
+           (r.tipo != DIARIO_RESERVA && r.tipo != DIARIO_DENEGADA)){
+            break;
+        }
+        if(r.tipo == DIARIO_RESERVA){
+            int id = nombres_internar(&ag->nombres, nombre, r.largo, hash);
+            if(id == -1 || agenda_restaurar(ag, r.franja, r.personas, id) == -1){
+                fprintf(stderr, "El diario %s tiene una reserva que no cabe en la agenda\n", ruta);
+                estado = -1;
+                break;
+            }
+        }
+        rec->conteo[r.contador] += r.tipo == DIARIO_DENEGADA ? r.personas : 1;
+        rec->registros_diario++;
+        posicion += sizeof(r) + r.largo;
+    }
+    if(estado == 1 && posicion < tam){
+        fprintf(stderr, "Diario %s: se descartan %zu bytes finales incompletos\n", ruta, tam - posicion);
+    }
+    munmap((void*)base, tam);
+    return estado;
+}
+
+// Saca el buffer activo (con el cerrojo del diario tomado). Devuelve los bytes.
+static size_t sacar_tanda(Diario* d, char** tanda){
+    size_t largo = d->usados;
+    *tanda = d->buffers[d->activo];
+    d->activo ^= 1;
+    d->usados = 0;
+    pthread_cond_broadcast(&d->hay_lugar);
+    return largo;
+}
+
+// Escribe y sincroniza una tanda en el diario en curso
+static void escribir_tanda(Diario* d, const char* tanda, size_t largo){
+    if(largo == 0) return;
+    if(escribir_todo(d->descriptor, tanda, largo) == -1 || fdatasync(d->descriptor) == -1){
+        perror("Error al escribir el diario");
+    }
+}
+
+// Corta el diario y lanza la instantánea de lo anotado hasta el corte.
+// El corte toma los dos cerrojos: ninguna reserva queda a medio anotar.
+static void cortar(Diario* d){
+    Agenda* ag = d->agenda;
+    if(d->instantanea_en_curso){
+        pthread_join(d->hilo_instantanea, NULL);
+        d->instantanea_en_curso = 0;
+    }
+
+    // Quien tiene el cerrojo de la agenda puede estar esperando lugar en el
+    // buffer: mientras no se consigue, se sigue vaciando
+    while(pthread_mutex_trylock(&ag->bloqueo) != 0){
+        char* tanda;
+        pthread_mutex_lock(&d->bloqueo);
+        size_t largo = sacar_tanda(d, &tanda);
+        pthread_mutex_unlock(&d->bloqueo);
+        escribir_tanda(d, tanda, largo);
+        if(largo == 0) sched_yield();
+    }
+    pthread_mutex_lock(&d->bloqueo);
+    char* tanda;
+    size_t largo = sacar_tanda(d, &tanda);
+    CopiaInstantanea* copia = copiar_agenda(d, d->generacion + 1, d->conteo);
+    d->registros = 0;
+    d->umbral = ag->num_reservas > INSTANTANEA_MINIMA ? ag->num_reservas : INSTANTANEA_MINIMA;
+    pthread_mutex_unlock(&d->bloqueo);
+    pthread_mutex_unlock(&ag->bloqueo);
+
+    // Cerrar la generación actual; lo anotado desde el corte va a la nueva
+    escribir_tanda(d, tanda, largo);
+    int nuevo = crear_diario(d, d->generacion + 1);
+    if(copia == NULL || nuevo == -1){
+        if(copia != NULL) liberar_copia(copia);
+        else fprintf(stderr, "Sin memoria para la instantánea; se sigue con el diario\n");
+        if(nuevo != -1) close(nuevo);
+        return;
+    }
+    close(d->descriptor);
+    d->descriptor = nuevo;
+    d->generacion++;
+
+    if(pthread_create(&d->hilo_instantanea, NULL, hilo_instantanea, copia) != 0){
+        liberar_copia(copia);
+        return;
+    }
+    d->instantanea_en_curso = 1;
+}
+
+static void* escribir(void* parametros){
+    Diario* d = (Diario*)parametros;
+
+    pthread_mutex_lock(&d->bloqueo);
+    while(1){
+        // Juntar una tanda: hasta INTERVALO_DIARIO_MS o medio buffer
+        if(!d->terminar && d->usados < BUFFER_DIARIO / 2){
+            struct timespec hasta;
+            clock_gettime(CLOCK_MONOTONIC, &hasta);
+            hasta.tv_nsec += INTERVALO_DIARIO_MS * 1000000L;
+            if(hasta.tv_nsec >= 1000000000L){
+                hasta.tv_sec++;
+                hasta.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&d->hay_datos, &d->bloqueo, &hasta);
+        }
+        int terminar = d->terminar;
+        int instantanea = d->registros >= d->umbral;
+        char* tanda;
+        size_t largo = sacar_tanda(d, &tanda);
+        pthread_mutex_unlock(&d->bloqueo);
+
+        escribir_tanda(d, tanda, largo);                // Un solo fdatasync para toda la tanda
+        if(terminar) break;
+        if(instantanea) cortar(d);
+
+        pthread_mutex_lock(&d->bloqueo);
+    }
+    return NULL;
+}
+
+int diario_abrir(Diario* d, const char* prefijo, Agenda* ag, Recuperacion* rec){
+    memset(d, 0, sizeof(*d));
+    memset(rec, 0, sizeof(*rec));
+    d->prefijo = prefijo;
+    d->agenda = ag;
+    d->descriptor = -1;
+
+    struct timespec antes, despues;
+    clock_gettime(CLOCK_MONOTONIC, &antes);
+
+    // Instantánea y, a continuación, la cola del diario
+    uint64_t desde = 1;
+    if(cargar_instantanea(d, ag, &desde, rec) == -1) return -1;
+    uint64_t generacion = desde;
+    int estado;
+    while((estado = aplicar_diario(d, ag, generacion, rec)) == 1) generacion++;
+    if(estado == -1) return -1;
+
+    clock_gettime(CLOCK_MONOTONIC, &despues);
+    rec->segundos = (despues.tv_sec - antes.tv_sec) + (despues.tv_nsec - antes.tv_nsec) / 1e9;
+
+    // Compactar lo recuperado en una instantánea nueva y empezar otro diario
+    d->generacion = generacion;
+    for(int t=0; t<3; t++) d->conteo[t] = rec->conteo[t];
+    d->umbral = ag->num_reservas > INSTANTANEA_MINIMA ? ag->num_reservas : INSTANTANEA_MINIMA;
+    CopiaInstantanea* copia = copiar_agenda(d, generacion, d->conteo);
+    if(copia == NULL){
+        fprintf(stderr, "Sin memoria para la instantánea inicial\n");
+        return -1;
+    }
+    estado = escribir_instantanea(copia);
+    liberar_copia(copia);
+    if(estado == -1 || (d->descriptor = crear_diario(d, generacion)) == -1) return -1;
+
+    d->buffers[0] = malloc(BUFFER_DIARIO);
+    d->buffers[1] = malloc(BUFFER_DIARIO);
+    pthread_mutex_init(&d->bloqueo, NULL);
+    pthread_condattr_t atributos;                       // Pausas con reloj monotónico
+    pthread_condattr_init(&atributos);
+    pthread_condattr_setclock(&atributos, CLOCK_MONOTONIC);
+    pthread_cond_init(&d->hay_datos, &atributos);
+    pthread_condattr_destroy(&atributos);
+    pthread_cond_init(&d->hay_lugar, NULL);
+
+    if(d->buffers[0] == NULL || d->buffers[1] == NULL || pthread_create(&d->escritor, NULL, escribir, d) != 0){
+        fprintf(stderr, "No se pudo arrancar el escritor del diario\n");
+        free(d->buffers[0]);
+        free(d->buffers[1]);
+        close(d->descriptor);
+        return -1;
+    }
+    ag->diario = d;
+    return 0;
+}
+
+// Copia el registro y el nombre al buffer activo
+static void anotar(Diario* d, const RegistroDiario* r, const char* nombre, int cantidad){
+    size_t tam = sizeof(*r) + r->largo;
+
+    pthread_mutex_lock(&d->bloqueo);
+    while(d->usados + tam > BUFFER_DIARIO){             // El disco no da abasto: esperar
+        pthread_cond_signal(&d->hay_datos);
+        pthread_cond_wait(&d->hay_lugar, &d->bloqueo);
+    }
+    char* destino = d->buffers[d->activo] + d->usados;
+    memcpy(destino, r, sizeof(*r));
+    if(r->largo > 0) memcpy(destino + sizeof(*r), nombre, r->largo);
+    d->usados += tam;
+    d->conteo[r->contador] += cantidad;
+    d->registros++;
+    if(d->usados >= BUFFER_DIARIO / 2 && d->usados - tam < BUFFER_DIARIO / 2){
+        pthread_cond_signal(&d->hay_datos);             // Medio buffer: no esperar al intervalo
+    }
+    pthread_mutex_unlock(&d->bloqueo);
+}
+
+void diario_anotar_reserva(Diario* d, int contador, int franja, int personas,
+                           const char* nombre, int largo, uint32_t hash){
+    RegistroDiario r = { 0, DIARIO_RESERVA, contador, largo, franja, personas };
+    r.suma = sumar_registro(&r, hash);
+    anotar(d, &r, nombre, 1);
+}
+
+void diario_anotar_denegadas(Diario* d, int cantidad){
+    RegistroDiario r = { 0, DIARIO_DENEGADA, 2, 0, -1, cantidad };
+    r.suma = sumar_registro(&r, nombres_hash(NULL, 0));
+    anotar(d, &r, NULL, cantidad);
+}
+
+void diario_cerrar(Diario* d, int borrar){
+    agenda_aplicar(d->agenda);                  // Lo de la vía rápida también va al diario
+    pthread_mutex_lock(&d->bloqueo);
+    d->terminar = 1;
+    pthread_cond_signal(&d->hay_datos);
+    pthread_mutex_unlock(&d->bloqueo);
+    pthread_join(d->escritor, NULL);
+    if(d->instantanea_en_curso) pthread_join(d->hilo_instantanea, NULL);
+    d->agenda->diario = NULL;
+    close(d->descriptor);
+
+    if(borrar){
+        char ruta[PATH_MAX];
+        snprintf(ruta, sizeof(ruta), "%s.instantanea", d->prefijo);
+        unlink(ruta);
+        borrar_diarios(d, d->generacion + 1);
+        sincronizar_directorio(d->prefijo);
+    }
+
+    free(d->buffers[0]);
+    free(d->buffers[1]);
+    pthread_mutex_destroy(&d->bloqueo);
+    pthread_cond_destroy(&d->hay_datos);
+    pthread_cond_destroy(&d->hay_lugar);
+}
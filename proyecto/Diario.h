@@ -0,0 +1,89 @@
+#ifndef DIARIO_H
+#define DIARIO_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "Agenda.h"
+
+// Diario de decisiones para recuperar la agenda tras una caída.
+//  - Cada reserva admitida (y cada denegación, para los contadores) se
+//    copia a un buffer en memoria; la agenda lo hace dentro de su cerrojo.
+//  - Un hilo escribe lo acumulado y hace un solo fdatasync por tanda
+//    ("group commit"), cada INTERVALO_DIARIO_MS o antes si el buffer llega
+//    a la mitad. Las respuestas no esperan al disco: una caída pierde a lo
+//    sumo la última tanda.
+//  - Instantáneas compactas (reservas + nombres, sin repetirlos) cada vez
+//    que el diario crece tanto como la instantánea anterior. Al tomarla se
+//    corta el diario: lo siguiente va a un archivo de generación nueva y,
+//    escrita la instantánea, se borra el anterior.
+//  - Al arrancar se mapea la instantánea con mmap y se aplica la cola del
+//    diario; un registro cortado o corrupto marca el final.
+// Archivos: <prefijo>.instantanea y <prefijo>.diario.<generación>.
+
+#define BUFFER_DIARIO (4 << 20)       // Bytes por buffer (hay dos)
+#define INTERVALO_DIARIO_MS 5         // Máximo entre tandas
+#define INSTANTANEA_MINIMA (1 << 20)  // Registros antes de la primera instantánea
+
+typedef enum {
+    DIARIO_RESERVA = 1,           // Reserva admitida (lleva franja, personas y grupo)
+    DIARIO_DENEGADA               // Solo cuenta: 'personas' = solicitudes denegadas
+} TipoDiario;
+
+// Registro del diario; le siguen 'largo' bytes con el nombre del grupo
+typedef struct {
+    uint32_t suma;                // Verificación del resto del registro y del nombre
+    uint8_t tipo;
+    uint8_t contador;             // 0 confirmada, 1 reprogramada, 2 denegada
+    uint16_t largo;
+    int32_t franja;               // Franja de ingreso (-1 en denegadas)
+    int32_t personas;
+} RegistroDiario;
+
+// Lo que se recuperó al abrir
+typedef struct {
+    int reservas_instantanea;     // Reservas leídas de la instantánea
+    long registros_diario;        // Registros aplicados de la cola del diario
+    long conteo[3];               // Confirmadas / reprogramadas / denegadas
+    double segundos;
+} Recuperacion;
+
+typedef struct Diario {
+    const char* prefijo;
+    Agenda* agenda;
+    int descriptor;               // Archivo de la generación en curso
+    uint64_t generacion;
+    pthread_mutex_t bloqueo;      // Buffer activo, contadores y corte
+    pthread_cond_t hay_datos;     // Despierta al escritor antes de tiempo
+    pthread_cond_t hay_lugar;     // Buffer lleno: quien anota espera
+    char* buffers[2];
+    int activo;                   // Buffer donde se anota
+    size_t usados;                // Bytes anotados en el buffer activo
+    long conteo[3];               // Decisiones anotadas desde el comienzo del día
+    long registros;               // Anotados desde la última instantánea
+    long umbral;                  // Registros que disparan la próxima
+    int terminar;
+    pthread_t escritor;
+    pthread_t hilo_instantanea;   // Escribe la instantánea sin frenar al escritor
+    int instantanea_en_curso;
+} Diario;
+
+// Recupera lo que haya con este prefijo sobre la agenda 'ag' (recién creada,
+// antes de atender solicitudes), escribe una instantánea inicial y arranca el
+// escritor. Desde ahí la agenda anota sus reservas. 0 si ok; -1 si los
+// archivos son de otra configuración del parque o hubo un error (avisa por stderr).
+int diario_abrir(Diario* d, const char* prefijo, Agenda* ag, Recuperacion* rec);
+
+// Anota una reserva admitida ('contador' 0 confirmada, 1 reprogramada;
+// 'hash' = nombres_hash del grupo). Espera si el escritor no da abasto:
+// nunca descarta.
+void diario_anotar_reserva(Diario* d, int contador, int franja, int personas,
+                           const char* nombre, int largo, uint32_t hash);
+
+// Anota 'cantidad' solicitudes denegadas en un solo registro
+void diario_anotar_denegadas(Diario* d, int cantidad);
+
+// Escribe y sincroniza lo pendiente y detiene los hilos. 'borrar': eliminar
+// los archivos (el día terminó bien y no hay nada que recuperar).
+void diario_cerrar(Diario* d, int borrar);
+
+#endif
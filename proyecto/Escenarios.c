@@ -0,0 +1,398 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "Protocolo.h"
+#include "Parques.h"
+#include "Clientes.h"
+#include "Lector.h"
+#include "Traza.h"
+#include "Admision.h"
+#include "Reloj.h"
+#include "Franjas.h"
+#include "Reparto.h"
+
+// Planificador de escenarios ("¿y si la capacidad fuera X, o el horario Y?"):
+// corre las mismas solicitudes del día contra cada combinación de una
+// grilla de parámetros, con el núcleo de admisión del controlador en
+// memoria, y compara confirmadas, reprogramadas, denegadas y el pico de
+// ocupación de cada una. Los escenarios son independientes: se reparten
+// entre los hilos con robo de trabajo (Reparto.h), cada uno con su parque.
+//  - Solicitudes de archivos (-a, como el agente): todas conocidas a la
+//    apertura, por turnos de a una por archivo (como el modo plan).
+//  - Solicitudes de una traza (-r, grabada o de carga -T): cada una a la
+//    hora en que llegó; los lotes se deciden solicitud por solicitud.
+//  - Grilla: cada eje es una lista "a,b,c" y/o tramos "desde:hasta:paso".
+//    Las combinaciones imposibles (franja que no divide a la hora o a la
+//    visita) se omiten.
+// La tabla va por stdout y, con -o, también como CSV.
+//
+// Uso: ./escenarios (-a archivo ... | -r traza) -t capacidades [-H horarios] [-d visitas]
+//                   [-m minutos] [-h hilos] [-o salida.csv]
+// Ej.: ./escenarios -a solicitudes_alpha.csv -t 10:100:10 -H 7-19,8-18 -d 1,2 -m 30,60
+
+#define MAX_ARCHIVOS 64           // Archivos de solicitudes
+#define MAX_VALORES 1024          // Valores por eje de la grilla
+#define CLIENTES_INICIAL 16
+
+// Una solicitud del día
+typedef struct {
+    int64_t ms;                   // Llegada (-1: a la apertura del escenario)
+    uint32_t agente;
+    int hora, personas;
+    int nombre, largo;            // Tramo en 'nombres'
+} Pedido;
+
+typedef struct {
+    int capacidad, apertura, cierre, minutos, minutos_visita;
+    int totales[3];               // Confirmadas / Reprogramadas / Denegadas
+    int pico;                     // Mayor ocupación de una franja
+    int minuto_pico;              // Inicio de la primera franja con el pico
+    int estado;                   // 0 si ok, -1 sin memoria
+} Escenario;
+
+typedef struct {
+    Pedido* pedidos;
+    int cantidad, capacidad;
+    char* nombres;
+    int usados, reservados;
+    Escenario* escenarios;
+    TablaClientes* clientes;      // Una por hilo (nadie se registra: solo para la admisión)
+} Barrido;
+
+static double segundos_ahora(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// Agrega una solicitud copiando su nombre. 0 si ok, -1 sin memoria.
+static int agregar(Barrido* b, int64_t ms, uint32_t agente, int hora, int personas, const char* nombre, int largo){
+    if(b->cantidad == b->capacidad){
+        int capacidad = b->capacidad > 0 ? b->capacidad * 2 : 1024;
+        Pedido* mayor = realloc(b->pedidos, capacidad * sizeof(Pedido));
+        if(mayor == NULL) return -1;
+        b->pedidos = mayor;
+        b->capacidad = capacidad;
+    }
+    if(b->usados + largo > b->reservados){
+        int reservados = b->reservados > 0 ? b->reservados * 2 : 16384;
+        while(reservados < b->usados + largo) reservados *= 2;
+        char* mayor = realloc(b->nombres, reservados);
+        if(mayor == NULL) return -1;
+        b->nombres = mayor;
+        b->reservados = reservados;
+    }
+    memcpy(b->nombres + b->usados, nombre, largo);
+    b->pedidos[b->cantidad++] = (Pedido){ ms, agente, hora, personas, b->usados, largo };
+    b->usados += largo;
+    return 0;
+}
+
+// Solicitudes de los archivos, una de cada uno por turno. 0 si ok, -1 si no.
+static int leer_archivos(Barrido* b, char* archivos[], int num_archivos){
+    LectorCsv lectores[num_archivos];
+    int activos[num_archivos];
+    int abiertos = 0, estado = 0;
+
+    for(; abiertos<num_archivos; abiertos++){
+        if(lector_abrir(&lectores[abiertos], archivos[abiertos]) == -1){
+            printf("Error: No se pudo abrir %s.\n", archivos[abiertos]);
+            estado = -1;
+            goto salir;
+        }
+        activos[abiertos] = 1;
+    }
+    for(int quedan = num_archivos; quedan > 0; ){
+        for(int k=0; k<num_archivos; k++){
+            if(!activos[k]) continue;
+            RegistroCsv registro;
+            int leido = lector_siguiente(&lectores[k], &registro);
+            if(leido == 0){
+                activos[k] = 0;
+                quedan--;
+                continue;
+            }
+            if(leido == -1){
+                fprintf(stderr, "%s:%d: %s (se omite)\n", archivos[k], lectores[k].linea, lectores[k].error);
+                continue;
+            }
+            if(agregar(b, -1, k + 1, registro.hora, registro.personas, registro.nombre, registro.largo) == -1){
+                printf("Error: Sin memoria para las solicitudes.\n");
+                estado = -1;
+                goto salir;
+            }
+        }
+    }
+salir:
+    for(int k=0; k<abiertos; k++) lector_cerrar(&lectores[k]);
+    return estado;
+}
+
+// Solicitudes de la traza, con su hora de llegada. 0 si ok, -1 si no.
+static int leer_traza(Barrido* b, const char* ruta){
+    Traza traza;
+    if(traza_abrir(&traza, ruta) == -1){
+        printf("Error: %s no es una traza o no se puede leer.\n", ruta);
+        return -1;
+    }
+    int64_t ms;
+    CabeceraMarco cab;
+    static char datos[MAX_CARGA];
+    int estado = 0, sin_memoria = 0;
+    while(!sin_memoria && (estado = traza_siguiente(&traza, &ms, &cab, datos)) == 1){
+        if(cab.tipo == MSG_SOLICITUD){
+            sin_memoria = agregar(b, ms, cab.agente, cab.hora, cab.personas, datos, cab.largo_nombre) == -1;
+        } else if(cab.tipo == MSG_LOTE){
+            SolicitudLote solicitud;
+            const char* nombre;
+            int posicion = 0;
+            while(!sin_memoria && lote_siguiente(datos, cab.largo_nombre, &posicion, &solicitud, &nombre) == 1){
+                sin_memoria = agregar(b, ms, cab.agente, solicitud.hora, solicitud.personas, nombre,
+                                      solicitud.largo_nombre) == -1;
+            }
+        }
+    }
+    traza_cerrar(&traza);
+    if(sin_memoria) printf("Error: Sin memoria para las solicitudes.\n");
+    else if(estado == -1) fprintf(stderr, "Traza cortada o inválida: se usa lo leído\n");
+    return sin_memoria ? -1 : 0;
+}
+
+// Valores de un eje: "a,b,c" y/o "desde:hasta:paso". Devuelve cuántos, o -1 si es inválido.
+static int leer_valores(const char* texto, double valores[]){
+    int cantidad = 0;
+    while(*texto != '\0'){
+        char* fin;
+        double desde = strtod(texto, &fin), hasta = desde, paso = 1;
+        if(fin == texto) return -1;
+        if(*fin == ':'){
+            hasta = strtod(fin + 1, &fin);
+            if(*fin != ':') return -1;
+            paso = strtod(fin + 1, &fin);
+            if(paso <= 0 || hasta < desde) return -1;
+        }
+        for(double v = desde; v <= hasta + paso / 1000; v += paso){
+            if(cantidad == MAX_VALORES) return -1;
+            valores[cantidad++] = v;
+        }
+        if(*fin == ',') fin++;
+        else if(*fin != '\0') return -1;
+        texto = fin;
+    }
+    return cantidad;
+}
+
+// Horarios "7-19,8-18". Devuelve cuántos, o -1 si es inválido.
+static int leer_horarios(const char* texto, int aperturas[], int cierres[]){
+    int cantidad = 0;
+    while(*texto != '\0'){
+        char* fin;
+        int apertura = (int)strtol(texto, &fin, 10);
+        if(fin == texto || *fin != '-' || cantidad == MAX_VALORES) return -1;
+        int cierre = (int)strtol(fin + 1, &fin, 10);
+        if(apertura < 0 || cierre > 24 || apertura >= cierre) return -1;
+        aperturas[cantidad] = apertura;
+        cierres[cantidad++] = cierre;
+        if(*fin == ',') fin++;
+        else if(*fin != '\0') return -1;
+        texto = fin;
+    }
+    return cantidad;
+}
+
+// Corre todas las solicitudes contra un parque con los parámetros del escenario
+static void evaluar(int tarea, int hilo, void* contexto){
+    Barrido* b = (Barrido*)contexto;
+    Escenario* e = &b->escenarios[tarea];
+    ConfigParque config = { 0, e->capacidad, e->apertura, e->cierre, e->minutos, e->minutos_visita };
+    Parques parques;
+    if(parques_crear(&parques, &config, 1, e->apertura, e->cierre) == -1){
+        e->estado = -1;
+        return;
+    }
+    Admision admision;
+    admision_iniciar(&admision, &parques, &b->clientes[hilo], NULL);
+
+    int64_t apertura = e->apertura * MS_POR_HORA;
+    CabeceraMarco respuesta;
+    for(int i=0; i<b->cantidad; i++){
+        const Pedido* p = &b->pedidos[i];
+        CabeceraMarco cab = { .tipo = MSG_SOLICITUD, .agente = p->agente, .hora = p->hora, .personas = p->personas,
+                              .secuencia = i + 1, .largo_nombre = p->largo };
+        admision_solicitud(&admision, &cab, b->nombres + p->nombre, p->ms < 0 ? apertura : p->ms, &respuesta);
+    }
+    admision_totales(&admision, e->totales);
+
+    // Pico de ocupación (copia de la agenda, que es atómica)
+    Agenda* agenda = &parques.lista[0].agenda;
+    int* ocupacion = malloc(agenda->franjas * sizeof(int));
+    if(ocupacion == NULL){
+        e->estado = -1;
+    } else {
+        for(int i=0; i<agenda->franjas; i++){
+            ocupacion[i] = atomic_load_explicit(&agenda->ocupacion[i], memory_order_relaxed);
+        }
+        int minimo;
+        franjas_extremos(ocupacion, agenda->franjas, &minimo, &e->pico);
+        e->minuto_pico = agenda_minuto(agenda, franjas_siguiente(ocupacion, agenda->franjas, 0, e->pico));
+        free(ocupacion);
+    }
+    parques_destruir(&parques);
+}
+
+int main(int argc, char* argv[]){
+    char* archivos[MAX_ARCHIVOS];
+    int num_archivos = 0;
+    char* ruta_traza = NULL;
+    char *texto_capacidades = NULL, *texto_horarios = "7-19", *texto_visitas = "2", *texto_minutos = "60";
+    int hilos = sysconf(_SC_NPROCESSORS_ONLN);   // Por defecto, uno por núcleo
+    char* salida = NULL;
+
+    for(int i=1; i+1<argc; i++){
+        if(*argv[i] == '-'){
+            switch (*(argv[i++]+1)) {
+                case 'a':                                         // Archivo de solicitudes (se repite)
+                    if(num_archivos < MAX_ARCHIVOS) archivos[num_archivos++] = argv[i];
+                    break;
+                case 'r': ruta_traza = argv[i]; break;            // Traza con las solicitudes
+                case 't': texto_capacidades = argv[i]; break;     // Capacidades
+                case 'H': texto_horarios = argv[i]; break;        // Horarios "apertura-cierre"
+                case 'd': texto_visitas = argv[i]; break;         // Horas por visita
+                case 'm': texto_minutos = argv[i]; break;         // Minutos por franja
+                case 'h': hilos = atoi(argv[i]); break;           // Hilos
+                case 'o': salida = argv[i]; break;                // Tabla en CSV
+            }
+        }
+    }
+
+    static double capacidades[MAX_VALORES], visitas[MAX_VALORES], minutos[MAX_VALORES];
+    static int aperturas[MAX_VALORES], cierres[MAX_VALORES];
+    int num_capacidades = texto_capacidades != NULL ? leer_valores(texto_capacidades, capacidades) : -1;
+    int num_horarios = leer_horarios(texto_horarios, aperturas, cierres);
+    int num_visitas = leer_valores(texto_visitas, visitas);
+    int num_minutos = leer_valores(texto_minutos, minutos);
+    if((num_archivos > 0) == (ruta_traza != NULL) || num_capacidades <= 0 || num_horarios <= 0 ||
+       num_visitas <= 0 || num_minutos <= 0 || hilos < 1){
+        printf("Uso: %s (-a archivo ... | -r traza) -t capacidades [-H horarios] [-d visitas] [-m minutos]\n"
+               "       [-h hilos] [-o salida.csv]\n"
+               "(ejes: \"a,b,c\" y/o \"desde:hasta:paso\"; horarios: \"7-19,8-18\")\n", argv[0]);
+        return 1;
+    }
+
+    // Grilla: todas las combinaciones posibles
+    long combinaciones = (long)num_capacidades * num_horarios * num_visitas * num_minutos;
+    Barrido barrido = { 0 };
+    barrido.escenarios = calloc(combinaciones, sizeof(Escenario));
+    if(barrido.escenarios == NULL){
+        printf("Error: Sin memoria para %ld escenarios.\n", combinaciones);
+        return 1;
+    }
+    int escenarios = 0;
+    for(int h=0; h<num_horarios; h++){
+        for(int m=0; m<num_minutos; m++){
+            for(int d=0; d<num_visitas; d++){
+                for(int c=0; c<num_capacidades; c++){
+                    int franja = (int)(minutos[m] + 0.5), visita = (int)(visitas[d] * 60 + 0.5);
+                    int capacidad = (int)(capacidades[c] + 0.5);
+                    if(franja <= 0 || 60 % franja != 0 || visita <= 0 || visita % franja != 0 || capacidad <= 0){
+                        continue;
+                    }
+                    barrido.escenarios[escenarios++] = (Escenario){ .capacidad = capacidad, .apertura = aperturas[h],
+                                                                   .cierre = cierres[h], .minutos = franja,
+                                                                   .minutos_visita = visita };
+                }
+            }
+        }
+    }
+    if(escenarios == 0){
+        printf("Error: Ninguna combinación de la grilla es posible (la franja debe dividir a la hora y a la visita).\n");
+        return 1;
+    }
+
+    if((ruta_traza != NULL ? leer_traza(&barrido, ruta_traza) : leer_archivos(&barrido, archivos, num_archivos)) == -1){
+        return 1;
+    }
+    barrido.clientes = malloc(hilos * sizeof(TablaClientes));
+    for(int i=0; barrido.clientes != NULL && i<hilos; i++){
+        if(clientes_crear(&barrido.clientes[i], CLIENTES_INICIAL) == -1){
+            printf("Error: Sin memoria para los hilos.\n");
+            return 1;
+        }
+    }
+    if(barrido.clientes == NULL){
+        printf("Error: Sin memoria para los hilos.\n");
+        return 1;
+    }
+
+    // Evaluación en paralelo
+    long robos;
+    double t0 = segundos_ahora();
+    if(reparto_ejecutar(escenarios, hilos, evaluar, &barrido, &robos) == -1){
+        printf("Error: No se pudieron repartir los escenarios.\n");
+        return 1;
+    }
+    double segundos = segundos_ahora() - t0;
+
+    printf("\n╔════════════════════════════════════════╗\n");
+    printf("║        ESCENARIOS (QUE PASARIA SI)     ║\n");
+    printf("╚════════════════════════════════════════╝\n\n");
+    printf("📂 %d solicitudes de %s; %d escenarios", barrido.cantidad,
+           ruta_traza != NULL ? ruta_traza : "los archivos", escenarios);
+    if(escenarios < combinaciones) printf(" (%ld combinaciones imposibles omitidas)", combinaciones - escenarios);
+    printf("\n\n   %9s %7s %6s %6s  %11s %13s %9s  %14s\n", "capacidad", "horario", "visita", "franja",
+           "confirmadas", "reprogramadas", "denegadas", "pico");
+
+    FILE* csv = NULL;
+    if(salida != NULL && (csv = fopen(salida, "w")) == NULL) perror("Error al escribir la tabla");
+    if(csv != NULL){
+        fprintf(csv, "capacidad,apertura,cierre,visita_min,franja_min,confirmadas,reprogramadas,denegadas,pico,hora_pico\n");
+    }
+
+    int mejor = -1, fallidos = 0;
+    for(int i=0; i<escenarios; i++){
+        Escenario* e = &barrido.escenarios[i];
+        if(e->estado == -1){
+            fallidos++;
+            continue;
+        }
+        char horario[16];
+        snprintf(horario, sizeof(horario), "%d-%d", e->apertura, e->cierre);
+        printf("   %9d %7s %4.1f h %2d min  %11d %13d %9d  %5d (%3.0f %%)\n", e->capacidad, horario,
+               e->minutos_visita / 60.0, e->minutos, e->totales[0], e->totales[1], e->totales[2], e->pico,
+               100.0 * e->pico / e->capacidad);
+        if(csv != NULL){
+            fprintf(csv, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d:%02d\n", e->capacidad, e->apertura, e->cierre, e->minutos_visita,
+                    e->minutos, e->totales[0], e->totales[1], e->totales[2], e->pico, e->minuto_pico / 60,
+                    e->minuto_pico % 60);
+        }
+        // Mejor: más admitidas; a igualdad, menos capacidad
+        if(mejor == -1 || e->totales[0] + e->totales[1] > barrido.escenarios[mejor].totales[0] +
+                                                         barrido.escenarios[mejor].totales[1] ||
+           (e->totales[0] + e->totales[1] == barrido.escenarios[mejor].totales[0] +
+                                              barrido.escenarios[mejor].totales[1] &&
+            e->capacidad < barrido.escenarios[mejor].capacidad)){
+            mejor = i;
+        }
+    }
+    if(csv != NULL) fclose(csv);
+
+    if(mejor != -1){
+        Escenario* e = &barrido.escenarios[mejor];
+        printf("\n🏆 Más admitidas: capacidad %d, %d:00 a %d:00, visita %.1f h, franjas de %d min → %d admitidas\n",
+               e->capacidad, e->apertura, e->cierre, e->minutos_visita / 60.0, e->minutos, e->totales[0] + e->totales[1]);
+    }
+    if(fallidos > 0) printf("⚠️  %d escenarios sin memoria (no figuran)\n", fallidos);
+    printf("   %d escenarios x %d solicitudes en %.2f s con %d hilos (%ld robos)  →  %.0f decisiones/s\n",
+           escenarios, barrido.cantidad, segundos, hilos, robos,
+           segundos > 0 ? (double)escenarios * barrido.cantidad / segundos : 0);
+    printf("\n════════════════════════════════════════\n");
+
+    for(int i=0; i<hilos; i++) clientes_destruir(&barrido.clientes[i]);
+    free(barrido.clientes);
+    free(barrido.escenarios);
+    free(barrido.pedidos);
+    free(barrido.nombres);
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "Estadisticas.h"
+
+#define MAX_EVENTOS_ESTADISTICAS 4
+
+// Socket en escucha en s->ruta, o -1 (el controlador sigue sin él)
+static int abrir_socket(ServidorEstadisticas* s, const char* tubo){
+    struct sockaddr_un direccion = { .sun_family = AF_UNIX };
+    _Static_assert(sizeof(s->ruta) <= sizeof(direccion.sun_path), "La ruta debe caber en sun_path");
+
+    if(snprintf(s->ruta, sizeof(s->ruta), "%s.estadisticas", tubo) >= (int)sizeof(s->ruta)){
+        fprintf(stderr, "Ruta demasiado larga para el socket de estadísticas\n");
+        s->ruta[0] = '\0';
+        return -1;
+    }
+    strcpy(direccion.sun_path, s->ruta);
+
+    int escucha = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(escucha == -1){
+        perror("Error al crear el socket de estadísticas");
+        return -1;
+    }
+    unlink(s->ruta);                                    // Socket de una ejecución anterior
+    if(bind(escucha, (struct sockaddr*)&direccion, sizeof(direccion)) == -1 || listen(escucha, 8) == -1){
+        perror("Error al abrir el socket de estadísticas");
+        close(escucha);
+        return -1;
+    }
+    return escucha;
+}
+
+// Arma el volcado en memoria y lo envía por la conexión
+static void responder(ServidorEstadisticas* s, int conexion){
+    char* texto = NULL;
+    size_t largo = 0;
+    FILE* salida = open_memstream(&texto, &largo);
+    if(salida == NULL) return;
+    s->volcar(salida, s->contexto);
+    fclose(salida);
+
+    // Un lector lento no puede trabar el hilo más de un segundo
+    struct timeval limite = { 1, 0 };
+    setsockopt(conexion, SOL_SOCKET, SO_SNDTIMEO, &limite, sizeof(limite));
+    for(size_t enviados = 0; enviados < largo; ){
+        ssize_t n = send(conexion, texto + enviados, largo - enviados, MSG_NOSIGNAL);
+        if(n <= 0) break;                               // El lector se fue
+        enviados += n;
+    }
+    free(texto);
+}
+
+static void* atender(void* parametros){
+    ServidorEstadisticas* s = (ServidorEstadisticas*)parametros;
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(epoll_fd == -1){
+        perror("Error al crear epoll de estadísticas");
+        return NULL;
+    }
+    struct epoll_event evento = { .events = EPOLLIN };
+    int descriptores[] = { s->escucha, s->senales, s->evento_fin };
+    for(int i=0; i<3; i++){
+        if(descriptores[i] == -1) continue;
+        evento.data.fd = descriptores[i];
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, descriptores[i], &evento);
+    }
+
+    int activo = 1;
+    while(activo){
+        struct epoll_event listos[MAX_EVENTOS_ESTADISTICAS];
+        int n = epoll_wait(epoll_fd, listos, MAX_EVENTOS_ESTADISTICAS, -1);
+        if(n == -1){
+            if(errno == EINTR) continue;
+            perror("Error en epoll_wait de estadísticas");
+            break;
+        }
+        for(int i=0; i<n; i++){
+            if(listos[i].data.fd == s->senales){
+                struct signalfd_siginfo senal;
+                if(read(s->senales, &senal, sizeof(senal)) == sizeof(senal)){
+                    s->volcar(stderr, s->contexto);
+                }
+            } else if(listos[i].data.fd == s->escucha){
+                int conexion = accept(s->escucha, NULL, NULL);
+                if(conexion == -1) continue;
+                responder(s, conexion);
+                close(conexion);
+            } else {
+                activo = 0;                             // Fin de la simulación (no se consume el eventfd)
+            }
+        }
+    }
+
+    close(epoll_fd);
+    return NULL;
+}
+
+int estadisticas_iniciar(ServidorEstadisticas* s, const char* tubo, int evento_fin,
+                         VolcadoEstadisticas volcar, void* contexto){
+    s->evento_fin = evento_fin;
+    s->volcar = volcar;
+    s->contexto = contexto;
+
+    // SIGUSR1 solo llega por el signalfd: ningún hilo la recibe de forma asíncrona
+    sigset_t usr1;
+    sigemptyset(&usr1);
+    sigaddset(&usr1, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &usr1, NULL);
+    s->senales = signalfd(-1, &usr1, SFD_NONBLOCK | SFD_CLOEXEC);
+    if(s->senales == -1) perror("Error al crear signalfd");
+
+    s->escucha = abrir_socket(s, tubo);
+
+    if(pthread_create(&s->hilo, NULL, atender, s) != 0){
+        if(s->senales != -1) close(s->senales);
+        if(s->escucha != -1){
+            close(s->escucha);
+            unlink(s->ruta);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+void estadisticas_terminar(ServidorEstadisticas* s){
+    pthread_join(s->hilo, NULL);
+    if(s->senales != -1) close(s->senales);
+    if(s->escucha != -1){
+        close(s->escucha);
+        unlink(s->ruta);
+    }
+}
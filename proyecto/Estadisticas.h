@@ -0,0 +1,36 @@
+#ifndef ESTADISTICAS_H
+#define ESTADISTICAS_H
+
+#include <stdio.h>
+#include <pthread.h>
+
+// Publicación de estadísticas mientras el controlador corre. Un hilo aparte
+// (fuera del camino de las solicitudes) espera en epoll:
+//  - Conexiones al socket UNIX "<tubo>.estadisticas": cada una recibe un
+//    volcado y se cierra (p. ej. socat - UNIX-CONNECT:tuboP.estadisticas).
+//  - SIGUSR1, recibida por signalfd: el volcado va a stderr.
+//  - El eventfd de fin de simulación, que lo hace terminar.
+// El contenido del volcado lo arma quien llama, con 'volcar'.
+
+typedef void (*VolcadoEstadisticas)(FILE* salida, void* contexto);
+
+typedef struct {
+    int escucha;                  // Socket en escucha (-1 si no se pudo crear)
+    int senales;                  // signalfd de SIGUSR1 (-1 si no se pudo crear)
+    int evento_fin;
+    char ruta[108];               // Ruta del socket (cabe en sun_path)
+    VolcadoEstadisticas volcar;
+    void* contexto;
+    pthread_t hilo;
+} ServidorEstadisticas;
+
+// Bloquea SIGUSR1 en el hilo que llama (llamar antes de crear los demás
+// hilos, que heredan la máscara), abre el socket y arranca el hilo.
+// 0 si ok; -1 si no se pudo crear el hilo (sin socket ni señal solo avisa).
+int estadisticas_iniciar(ServidorEstadisticas* s, const char* tubo, int evento_fin,
+                         VolcadoEstadisticas volcar, void* contexto);
+
+// Espera al hilo (termina con el eventfd de fin) y borra el socket
+void estadisticas_terminar(ServidorEstadisticas* s);
+
+#endif
@@ -0,0 +1,435 @@
+#include <stdatomic.h>
+#include "Franjas.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CON_AVX2 1
+#endif
+
+// Nivel en uso (-1: sin detectar todavía)
+static _Atomic int nivel_actual = -1;
+
+static NivelSimd nivel_maximo(void){
+#if defined(CON_AVX2)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+#endif
+#if defined(__SSE2__)
+    return SIMD_SSE2;
+#else
+    return SIMD_ESCALAR;
+#endif
+}
+
+NivelSimd franjas_nivel(void){
+    int nivel = atomic_load_explicit(&nivel_actual, memory_order_relaxed);
+    if(nivel < 0){
+        nivel = nivel_maximo();
+        atomic_store_explicit(&nivel_actual, nivel, memory_order_relaxed);
+    }
+    return nivel;
+}
+
+NivelSimd franjas_forzar(NivelSimd nivel){
+    NivelSimd maximo = nivel_maximo();
+    if(nivel > maximo) nivel = maximo;
+    atomic_store_explicit(&nivel_actual, nivel, memory_order_relaxed);
+    return nivel;
+}
+
+const char* franjas_nombre_nivel(NivelSimd nivel){
+    switch(nivel){
+        case SIMD_AVX2: return "avx2";
+        case SIMD_SSE2: return "sse2";
+        default: return "escalar";
+    }
+}
+
+// Umbrales del histograma: v cae en la cubeta c o más si v >= umbral[c]
+static void umbrales(int capacidad, int cubetas, int umbral[]){
+    for(int c=1; c<cubetas; c++){
+        umbral[c] = (int)(((long)c * capacidad + cubetas - 1) / cubetas);
+    }
+}
+
+// ---- Escalar (referencia, y las colas de los vectoriales) ----
+
+static void extremos_escalar(const int* v, int n, int* minimo, int* maximo){
+    int menor = v[0], mayor = v[0];
+    for(int i=1; i<n; i++){
+        if(v[i] < menor) menor = v[i];
+        if(v[i] > mayor) mayor = v[i];
+    }
+    *minimo = menor;
+    *maximo = mayor;
+}
+
+static int siguiente_escalar(const int* v, int n, int desde, int valor){
+    for(int i=desde; i<n; i++){
+        if(v[i] == valor) return i;
+    }
+    return -1;
+}
+
+static int cupo_escalar(const int* libre, int largo, int personas){
+    for(int i=0; i<largo; i++){
+        if(libre[i] < personas) return 0;
+    }
+    return 1;
+}
+
+static void sumar_escalar(int* v, int n, int delta){
+    for(int i=0; i<n; i++) v[i] += delta;
+}
+
+// v[i] = min(v[i], v[i+d]) para i en [0, n), en orden (d > 0: se lee antes de pisar)
+static void minimo_desplazado_escalar(int* v, int n, int d){
+    for(int i=0; i<n; i++){
+        if(v[i + d] < v[i]) v[i] = v[i + d];
+    }
+}
+
+static long histograma_escalar(const int* v, int n, int capacidad, int cubetas, int cuenta[]){
+    long suma = 0;
+    for(int i=0; i<n; i++){
+        long c = (long)v[i] * cubetas / capacidad;
+        cuenta[c < cubetas ? c : cubetas - 1]++;
+        suma += v[i];
+    }
+    return suma;
+}
+
+// ---- SSE2: 4 enteros por instrucción (sin mínimo de enteros: comparar y mezclar) ----
+
+#if defined(__SSE2__)
+
+static inline __m128i menor_sse2(__m128i a, __m128i b){
+    __m128i mayor_a = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(mayor_a, b), _mm_andnot_si128(mayor_a, a));
+}
+
+static inline __m128i mayor_sse2(__m128i a, __m128i b){
+    __m128i mayor_a = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(mayor_a, a), _mm_andnot_si128(mayor_a, b));
+}
+
+static void extremos_sse2(const int* v, int n, int* minimo, int* maximo){
+    if(n < 4){
+        extremos_escalar(v, n, minimo, maximo);
+        return;
+    }
+    __m128i menor = _mm_loadu_si128((const __m128i*)v), mayor = menor;
+    int i = 4;
+    for(; i+4<=n; i+=4){
+        __m128i x = _mm_loadu_si128((const __m128i*)(v + i));
+        menor = menor_sse2(menor, x);
+        mayor = mayor_sse2(mayor, x);
+    }
+    int a[4], b[4];
+    _mm_storeu_si128((__m128i*)a, menor);
+    _mm_storeu_si128((__m128i*)b, mayor);
+    for(int k=1; k<4; k++){
+        if(a[k] < a[0]) a[0] = a[k];
+        if(b[k] > b[0]) b[0] = b[k];
+    }
+    for(; i<n; i++){
+        if(v[i] < a[0]) a[0] = v[i];
+        if(v[i] > b[0]) b[0] = v[i];
+    }
+    *minimo = a[0];
+    *maximo = b[0];
+}
+
+static int siguiente_sse2(const int* v, int n, int desde, int valor){
+    __m128i buscado = _mm_set1_epi32(valor);
+    int i = desde;
+    for(; i+4<=n; i+=4){
+        int iguales = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(v + i)), buscado)));
+        if(iguales) return i + __builtin_ctz(iguales);
+    }
+    return siguiente_escalar(v, n, i, valor);
+}
+
+static int cupo_sse2(const int* libre, int largo, int personas){
+    __m128i minimo = _mm_set1_epi32(personas);
+    int i = 0;
+    for(; i+4<=largo; i+=4){
+        // Alguna franja con menos libre que 'personas'
+        if(_mm_movemask_epi8(_mm_cmpgt_epi32(minimo, _mm_loadu_si128((const __m128i*)(libre + i))))) return 0;
+    }
+    return cupo_escalar(libre + i, largo - i, personas);
+}
+
+static void sumar_sse2(int* v, int n, int delta){
+    __m128i d = _mm_set1_epi32(delta);
+    int i = 0;
+    for(; i+4<=n; i+=4){
+        __m128i* p = (__m128i*)(v + i);
+        _mm_storeu_si128(p, _mm_add_epi32(_mm_loadu_si128(p), d));
+    }
+    sumar_escalar(v + i, n - i, delta);
+}
+
+static void minimo_desplazado_sse2(int* v, int n, int d){
+    int i = 0;
+    for(; i+4<=n; i+=4){
+        __m128i a = _mm_loadu_si128((const __m128i*)(v + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(v + i + d));
+        _mm_storeu_si128((__m128i*)(v + i), menor_sse2(a, b));
+    }
+    minimo_desplazado_escalar(v + i, n - i, d);
+}
+
+// Cuenta, para cada umbral, cuántas franjas lo alcanzan: una comparación
+// por umbral y ningún acceso indirecto
+static long histograma_sse2(const int* v, int n, int capacidad, int cubetas, int cuenta[]){
+    int umbral[cubetas];
+    umbrales(capacidad, cubetas, umbral);
+    __m128i limite[cubetas], alcanzan[cubetas];
+    for(int c=1; c<cubetas; c++){
+        limite[c] = _mm_set1_epi32(umbral[c] - 1);
+        alcanzan[c] = _mm_setzero_si128();
+    }
+    __m128i suma = _mm_setzero_si128(), cero = _mm_setzero_si128();
+    int i = 0;
+    for(; i+4<=n; i+=4){
+        __m128i x = _mm_loadu_si128((const __m128i*)(v + i));
+        for(int c=1; c<cubetas; c++){
+            alcanzan[c] = _mm_sub_epi32(alcanzan[c], _mm_cmpgt_epi32(x, limite[c]));   // -1 por cada una
+        }
+        suma = _mm_add_epi64(suma, _mm_add_epi64(_mm_unpacklo_epi32(x, cero), _mm_unpackhi_epi32(x, cero)));
+    }
+
+    int desde_c[cubetas + 1];
+    desde_c[0] = i;
+    desde_c[cubetas] = 0;
+    for(int c=1; c<cubetas; c++){
+        int a[4];
+        _mm_storeu_si128((__m128i*)a, alcanzan[c]);
+        desde_c[c] = a[0] + a[1] + a[2] + a[3];
+    }
+    for(int c=0; c<cubetas; c++) cuenta[c] += desde_c[c] - desde_c[c + 1];
+
+    long partes[2];
+    _mm_storeu_si128((__m128i*)partes, suma);
+    return partes[0] + partes[1] + histograma_escalar(v + i, n - i, capacidad, cubetas, cuenta);
+}
+
+#endif
+
+// ---- AVX2: 8 enteros por instrucción ----
+
+#if defined(CON_AVX2)
+
+__attribute__((target("avx2")))
+static void extremos_avx2(const int* v, int n, int* minimo, int* maximo){
+    if(n < 8){
+        extremos_escalar(v, n, minimo, maximo);
+        return;
+    }
+    __m256i menor = _mm256_loadu_si256((const __m256i*)v), mayor = menor;
+    int i = 8;
+    for(; i+8<=n; i+=8){
+        __m256i x = _mm256_loadu_si256((const __m256i*)(v + i));
+        menor = _mm256_min_epi32(menor, x);
+        mayor = _mm256_max_epi32(mayor, x);
+    }
+    // Última vuelta solapada con la anterior: no hace falta cola escalar
+    if(i < n){
+        __m256i x = _mm256_loadu_si256((const __m256i*)(v + n - 8));
+        menor = _mm256_min_epi32(menor, x);
+        mayor = _mm256_max_epi32(mayor, x);
+    }
+    __m128i m = _mm_min_epi32(_mm256_castsi256_si128(menor), _mm256_extracti128_si256(menor, 1));
+    __m128i M = _mm_max_epi32(_mm256_castsi256_si128(mayor), _mm256_extracti128_si256(mayor, 1));
+    m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+    M = _mm_max_epi32(M, _mm_shuffle_epi32(M, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+    M = _mm_max_epi32(M, _mm_shuffle_epi32(M, _MM_SHUFFLE(2, 3, 0, 1)));
+    *minimo = _mm_cvtsi128_si32(m);
+    *maximo = _mm_cvtsi128_si32(M);
+}
+
+__attribute__((target("avx2")))
+static int siguiente_avx2(const int* v, int n, int desde, int valor){
+    __m256i buscado = _mm256_set1_epi32(valor);
+    int i = desde;
+    for(; i+8<=n; i+=8){
+        __m256i iguales = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(v + i)), buscado);
+        int mascara = _mm256_movemask_ps(_mm256_castsi256_ps(iguales));
+        if(mascara) return i + __builtin_ctz(mascara);
+    }
+    return siguiente_escalar(v, n, i, valor);
+}
+
+__attribute__((target("avx2")))
+static int cupo_avx2(const int* libre, int largo, int personas){
+    __m256i minimo = _mm256_set1_epi32(personas);
+    int i = 0;
+    for(; i+8<=largo; i+=8){
+        __m256i faltan = _mm256_cmpgt_epi32(minimo, _mm256_loadu_si256((const __m256i*)(libre + i)));
+        if(!_mm256_testz_si256(faltan, faltan)) return 0;
+    }
+    return cupo_escalar(libre + i, largo - i, personas);
+}
+
+__attribute__((target("avx2")))
+static void sumar_avx2(int* v, int n, int delta){
+    __m256i d = _mm256_set1_epi32(delta);
+    int i = 0;
+    for(; i+8<=n; i+=8){
+        __m256i* p = (__m256i*)(v + i);
+        _mm256_storeu_si256(p, _mm256_add_epi32(_mm256_loadu_si256(p), d));
+    }
+    sumar_escalar(v + i, n - i, delta);
+}
+
+__attribute__((target("avx2")))
+static void minimo_desplazado_avx2(int* v, int n, int d){
+    int i = 0;
+    for(; i+8<=n; i+=8){
+        __m256i a = _mm256_loadu_si256((const __m256i*)(v + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(v + i + d));
+        _mm256_storeu_si256((__m256i*)(v + i), _mm256_min_epi32(a, b));
+    }
+    minimo_desplazado_escalar(v + i, n - i, d);
+}
+
+__attribute__((target("avx2")))
+static long histograma_avx2(const int* v, int n, int capacidad, int cubetas, int cuenta[]){
+    int umbral[cubetas];
+    umbrales(capacidad, cubetas, umbral);
+    __m256i limite[cubetas], alcanzan[cubetas];
+    for(int c=1; c<cubetas; c++){
+        limite[c] = _mm256_set1_epi32(umbral[c] - 1);
+        alcanzan[c] = _mm256_setzero_si256();
+    }
+    __m256i suma = _mm256_setzero_si256();
+    int i = 0;
+    for(; i+8<=n; i+=8){
+        __m256i x = _mm256_loadu_si256((const __m256i*)(v + i));
+        for(int c=1; c<cubetas; c++){
+            alcanzan[c] = _mm256_sub_epi32(alcanzan[c], _mm256_cmpgt_epi32(x, limite[c]));
+        }
+        suma = _mm256_add_epi64(suma, _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(x)),
+                                                        _mm256_cvtepu32_epi64(_mm256_extracti128_si256(x, 1))));
+    }
+
+    int desde_c[cubetas + 1];
+    desde_c[0] = i;
+    desde_c[cubetas] = 0;
+    for(int c=1; c<cubetas; c++){
+        int a[8];
+        _mm256_storeu_si256((__m256i*)a, alcanzan[c]);
+        desde_c[c] = a[0] + a[1] + a[2] + a[3] + a[4] + a[5] + a[6] + a[7];
+    }
+    for(int c=0; c<cubetas; c++) cuenta[c] += desde_c[c] - desde_c[c + 1];
+
+    long partes[4];
+    _mm256_storeu_si256((__m256i*)partes, suma);
+    return partes[0] + partes[1] + partes[2] + partes[3] + histograma_escalar(v + i, n - i, capacidad, cubetas, cuenta);
+}
+
+#endif
+
+// ---- Despacho según el nivel ----
+
+void franjas_extremos(const int* v, int n, int* minimo, int* maximo){
+    if(n <= 0){
+        *minimo = *maximo = 0;
+        return;
+    }
+    switch(franjas_nivel()){
+#if defined(CON_AVX2)
+        case SIMD_AVX2: extremos_avx2(v, n, minimo, maximo); return;
+#endif
+#if defined(__SSE2__)
+        case SIMD_SSE2: extremos_sse2(v, n, minimo, maximo); return;
+#endif
+        default: extremos_escalar(v, n, minimo, maximo);
+    }
+}
+
+int franjas_siguiente(const int* v, int n, int desde, int valor){
+    if(desde < 0) desde = 0;
+    switch(franjas_nivel()){
+#if defined(CON_AVX2)
+        case SIMD_AVX2: return siguiente_avx2(v, n, desde, valor);
+#endif
+#if defined(__SSE2__)
+        case SIMD_SSE2: return siguiente_sse2(v, n, desde, valor);
+#endif
+        default: return siguiente_escalar(v, n, desde, valor);
+    }
+}
+
+int franjas_cupo(const int* libre, int desde, int largo, int personas){
+    switch(franjas_nivel()){
+#if defined(CON_AVX2)
+        case SIMD_AVX2: return cupo_avx2(libre + desde, largo, personas);
+#endif
+#if defined(__SSE2__)
+        case SIMD_SSE2: return cupo_sse2(libre + desde, largo, personas);
+#endif
+        default: return cupo_escalar(libre + desde, largo, personas);
+    }
+}
+
+void franjas_sumar(int* v, int n, int delta){
+    switch(franjas_nivel()){
+#if defined(CON_AVX2)
+        case SIMD_AVX2: sumar_avx2(v, n, delta); return;
+#endif
+#if defined(__SSE2__)
+        case SIMD_SSE2: sumar_sse2(v, n, delta); return;
+#endif
+        default: sumar_escalar(v, n, delta);
+    }
+}
+
+static void minimo_desplazado(NivelSimd nivel, int* v, int n, int d){
+    switch(nivel){
+#if defined(CON_AVX2)
+        case SIMD_AVX2: minimo_desplazado_avx2(v, n, d); return;
+#endif
+#if defined(__SSE2__)
+        case SIMD_SSE2: minimo_desplazado_sse2(v, n, d); return;
+#endif
+        default: minimo_desplazado_escalar(v, n, d);
+    }
+}
+
+void franjas_minimos(int* v, int n, int largo){
+    if(largo <= 1 || n < largo) return;
+    NivelSimd nivel = franjas_nivel();
+
+    // Ventanas de 1, 2, 4 ... hasta la mayor potencia de 2 que no pasa 'largo'
+    int ancho = 1, validas = n;
+    while(2 * ancho <= largo){
+        validas -= ancho;
+        minimo_desplazado(nivel, v, validas, ancho);
+        ancho *= 2;
+    }
+    // Dos ventanas de 'ancho' solapadas cubren una de 'largo'
+    if(largo > ancho) minimo_desplazado(nivel, v, n - largo + 1, largo - ancho);
+}
+
+long franjas_histograma(const int* v, int n, int capacidad, int cubetas, int cuenta[]){
+    for(int c=0; c<cubetas; c++) cuenta[c] = 0;
+    if(n <= 0 || cubetas <= 0) return 0;
+    if(capacidad <= 0){
+        capacidad = 1;
+    }
+    switch(franjas_nivel()){
+#if defined(CON_AVX2)
+        case SIMD_AVX2: return histograma_avx2(v, n, capacidad, cubetas, cuenta);
+#endif
+#if defined(__SSE2__)
+        case SIMD_SSE2: return histograma_sse2(v, n, capacidad, cubetas, cuenta);
+#endif
+        default: return histograma_escalar(v, n, capacidad, cubetas, cuenta);
+    }
+}
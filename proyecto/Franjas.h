@@ -0,0 +1,52 @@
+#ifndef FRANJAS_H
+#define FRANJAS_H
+
+// Operaciones vectoriales sobre arreglos de franjas (ocupación o cupo libre
+// por franja). Con franjas de un minuto un día son 1440 franjas y una visita
+// de 2 horas 120: los informes y el recálculo del índice recorren tramos
+// largos, y de a 4 u 8 enteros por instrucción rinden mucho más.
+//  - AVX2 (8 enteros) si el procesador lo tiene, detectado al primer uso.
+//  - SSE2 (4 enteros): siempre está en x86-64.
+//  - Escalar en cualquier otra arquitectura.
+// Todas dan exactamente el mismo resultado; franjas_forzar permite bajar de
+// nivel para compararlas (./benchmark simd).
+
+typedef enum {
+    SIMD_ESCALAR = 0,
+    SIMD_SSE2,
+    SIMD_AVX2
+} NivelSimd;
+
+// Nivel en uso
+NivelSimd franjas_nivel(void);
+
+// Usa a lo sumo 'nivel' (si el procesador no llega, el máximo que tenga).
+// Devuelve el nivel que queda en uso.
+NivelSimd franjas_forzar(NivelSimd nivel);
+
+const char* franjas_nombre_nivel(NivelSimd nivel);
+
+// Mínimo y máximo de v[0..n). Con n = 0 ambos quedan en 0.
+void franjas_extremos(const int* v, int n, int* minimo, int* maximo);
+
+// Primera posición i >= desde con v[i] == valor, o -1
+int franjas_siguiente(const int* v, int n, int desde, int valor);
+
+// 1 si las 'largo' franjas desde 'desde' tienen todas al menos 'personas' libres
+int franjas_cupo(const int* libre, int desde, int largo, int personas);
+
+// v[0..n) += delta (reservar o liberar una ventana)
+void franjas_sumar(int* v, int n, int delta);
+
+// Mínimo de cada ventana de 'largo' franjas, en el lugar: al volver, v[i]
+// es el mínimo de v[i..i+largo) para i = 0 .. n-largo (el resto queda con
+// valores intermedios). Por duplicación: log2(largo) pasadas sobre v.
+void franjas_minimos(int* v, int n, int largo);
+
+// Resumen de ocupación de v[0..n) (valores no negativos) con 'cubetas'
+// niveles de igual ancho sobre 'capacidad': cuenta[c] = franjas con
+// v en [c, c+1) * capacidad / cubetas; lo que llega a la capacidad (o la
+// pasa) va a la última. Devuelve la suma de v.
+long franjas_histograma(const int* v, int n, int capacidad, int cubetas, int cuenta[]);
+
+#endif
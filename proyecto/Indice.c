@@ -0,0 +1,117 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "Indice.h"
+#include "Franjas.h"
+
+#define NINGUNA INT_MIN   // Hojas de relleno: ninguna visita cabe
+
+static int mayor(int a, int b){ return a > b ? a : b; }
+
+int indice_crear(IndiceCapacidad* ind, int franjas, int visita, int capacidad){
+    return indice_crear_en(ind, franjas, visita, capacidad, NULL);
+}
+
+int indice_crear_en(IndiceCapacidad* ind, int franjas, int visita, int capacidad, int* libre){
+    ind->franjas = franjas;
+    ind->visita = visita;
+    ind->ventanas = franjas - visita + 1;
+    ind->hojas = 1;
+    while(ind->hojas < ind->ventanas) ind->hojas *= 2;
+
+    ind->libre_ajeno = libre != NULL;
+    ind->libre = ind->libre_ajeno ? libre : malloc(franjas * sizeof(int));
+    ind->mejor = malloc(2 * ind->hojas * sizeof(int));
+    ind->tramo = malloc(franjas * sizeof(int));
+    if(ind->libre == NULL || ind->mejor == NULL || ind->tramo == NULL){
+        indice_destruir(ind);
+        return -1;
+    }
+
+    for(int i=0; i<franjas; i++) ind->libre[i] = capacidad;
+    for(int i=0; i<ind->hojas; i++){
+        ind->mejor[ind->hojas + i] = (i < ind->ventanas) ? capacidad : NINGUNA;
+    }
+    for(int n=ind->hojas-1; n>=1; n--){
+        ind->mejor[n] = mayor(ind->mejor[2*n], ind->mejor[2*n+1]);
+    }
+    return 0;
+}
+
+void indice_destruir(IndiceCapacidad* ind){
+    if(!ind->libre_ajeno) free(ind->libre);
+    free(ind->mejor);
+    free(ind->tramo);
+    ind->libre = NULL;
+    ind->mejor = NULL;
+    ind->tramo = NULL;
+}
+
+// Primer inicio >= desde cuya ventana tiene cupo >= personas, o -1
+static int primera_ventana(const IndiceCapacidad* ind, int n, int l, int r, int desde, int personas){
+    if(r < desde || ind->mejor[n] < personas) return -1;
+    if(l == r) return l;
+    int medio = (l + r) / 2;
+    int encontrada = primera_ventana(ind, 2*n, l, medio, desde, personas);
+    if(encontrada != -1) return encontrada;
+    return primera_ventana(ind, 2*n+1, medio+1, r, desde, personas);
+}
+
+int indice_buscar(const IndiceCapacidad* ind, int desde, int personas){
+    if(ind->ventanas <= 0) return -1;
+    if(desde < 0) desde = 0;
+    if(desde >= ind->ventanas) return -1;
+    return primera_ventana(ind, 1, 0, ind->hojas-1, desde, personas);
+}
+
+// Recalcula las ventanas que empiezan en [primera, ultima] y sus ancestros
+static void recalcular(IndiceCapacidad* ind, int primera, int ultima){
+    int L = ind->visita;
+
+    // Mínimo de cada ventana, sobre una copia del tramo de franjas que las cubre
+    int largo = ultima + L - primera;
+    memcpy(ind->tramo, ind->libre + primera, largo * sizeof(int));
+    franjas_minimos(ind->tramo, largo, L);
+    memcpy(ind->mejor + ind->hojas + primera, ind->tramo, (ultima - primera + 1) * sizeof(int));
+
+    // Recalcular los ancestros del tramo de hojas, nivel por nivel
+    int a = (ind->hojas + primera) / 2;
+    int b = (ind->hojas + ultima) / 2;
+    while(a >= 1){
+        for(int n=a; n<=b; n++){
+            ind->mejor[n] = mayor(ind->mejor[2*n], ind->mejor[2*n+1]);
+        }
+        a /= 2;
+        b /= 2;
+    }
+}
+
+// Ventanas afectadas por un cambio en [desde, desde+L): las que empiezan en [desde-L+1, desde+L-1]
+static int primera_afectada(const IndiceCapacidad* ind, int desde){
+    return desde - ind->visita + 1 < 0 ? 0 : desde - ind->visita + 1;
+}
+
+static int ultima_afectada(const IndiceCapacidad* ind, int desde){
+    return desde + ind->visita - 1 >= ind->ventanas ? ind->ventanas - 1 : desde + ind->visita - 1;
+}
+
+void indice_sumar(IndiceCapacidad* ind, int desde, int delta){
+    franjas_sumar(ind->libre + desde, ind->visita, delta);
+    recalcular(ind, primera_afectada(ind, desde), ultima_afectada(ind, desde));
+}
+
+void indice_sumar_varios(IndiceCapacidad* ind, const int desde[], const int delta[], int n){
+    if(n <= 0) return;
+    int primera = ind->ventanas, ultima = -1;
+    for(int k=0; k<n; k++){
+        franjas_sumar(ind->libre + desde[k], ind->visita, delta[k]);
+        int a = primera_afectada(ind, desde[k]), b = ultima_afectada(ind, desde[k]);
+        if(a < primera) primera = a;
+        if(b > ultima) ultima = b;
+    }
+    recalcular(ind, primera, ultima);
+}
+
+int indice_libre(const IndiceCapacidad* ind, int franja){
+    return ind->libre[franja];
+}
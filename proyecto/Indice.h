@@ -0,0 +1,46 @@
+#ifndef INDICE_H
+#define INDICE_H
+
+// Índice de capacidad libre por franja para visitas de largo fijo L.
+// Para cada franja de inicio p se guarda el cupo de la ventana [p, p+L),
+// es decir el mínimo libre de esas L franjas, en un árbol de segmentos
+// de máximos. "Primera ventana >= h con cupo para N" es un solo descenso
+// por el árbol: O(log n). Reservar recalcula las ventanas que tocan la
+// reserva con mínimos por duplicación (Franjas.h, de a 8 franjas por
+// instrucción): O(L log L / 8 + log n). Varias reservas juntas recalculan
+// una sola vez el tramo que cubren entre todas.
+typedef struct {
+    int franjas;        // Nº de franjas
+    int visita;         // Largo L de cada visita, en franjas
+    int ventanas;       // Inicios posibles: franjas - visita + 1
+    int hojas;          // Potencia de 2 >= ventanas
+    int* libre;         // Cupo libre por franja
+    int libre_ajeno;    // 1 si 'libre' es de quien creó el índice (no se libera acá)
+    int* mejor;         // Árbol: máximo cupo de ventana por rango de inicios
+    int* tramo;         // Copia de las franjas a recalcular (hasta todas)
+} IndiceCapacidad;
+
+// Crea el índice con todas las franjas en 'capacidad' libres. 0 si ok, -1 sin memoria.
+int indice_crear(IndiceCapacidad* ind, int franjas, int visita, int capacidad);
+void indice_destruir(IndiceCapacidad* ind);
+
+// Igual que indice_crear, con el cupo libre en 'libre' ('franjas' enteros
+// de quien llama, que los libera después de indice_destruir): así vive
+// junto al resto del estado por franja
+int indice_crear_en(IndiceCapacidad* ind, int franjas, int visita, int capacidad, int* libre);
+
+// Primera franja p >= desde tal que [p, p+visita) tiene cupo para 'personas'.
+// Devuelve -1 si ninguna ventana dentro del índice sirve.
+int indice_buscar(const IndiceCapacidad* ind, int desde, int personas);
+
+// Suma delta al cupo libre de [desde, desde+visita). Reservar = delta negativo.
+void indice_sumar(IndiceCapacidad* ind, int desde, int delta);
+
+// Igual que indice_sumar para n ventanas (delta[k] a [desde[k], desde[k]+visita)),
+// recalculando el árbol una sola vez
+void indice_sumar_varios(IndiceCapacidad* ind, const int desde[], const int delta[], int n);
+
+// Cupo libre de una franja
+int indice_libre(const IndiceCapacidad* ind, int franja);
+
+#endif
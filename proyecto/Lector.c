@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "Lector.h"
+#include "Protocolo.h"
+
+int lector_abrir(LectorCsv* lector, const char* ruta){
+    memset(lector, 0, sizeof(*lector));
+
+    int fd = open(ruta, O_RDONLY);
+    if(fd == -1) return -1;
+
+    struct stat info;
+    if(fstat(fd, &info) == -1){
+        close(fd);
+        return -1;
+    }
+    lector->tam = info.st_size;
+
+    // mmap no acepta largo 0: un archivo vacío no tiene registros
+    if(lector->tam > 0){
+        void* datos = mmap(NULL, lector->tam, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(datos == MAP_FAILED){
+            close(fd);
+            return -1;
+        }
+        madvise(datos, lector->tam, MADV_SEQUENTIAL);   // Lectura de corrido
+        lector->datos = datos;
+    }
+    close(fd);          // El mapeo sigue vivo sin el descriptor
+    return 0;
+}
+
+void lector_cerrar(LectorCsv* lector){
+    if(lector->datos != NULL) munmap((void*)lector->datos, lector->tam);
+    lector->datos = NULL;
+}
+
+// Primer ',' o '\n' en [p, fin), o fin si no hay
+static const char* buscar_separador(const char* p, const char* fin){
+#ifdef __SSE2__
+    const __m128i coma = _mm_set1_epi8(',');
+    const __m128i salto = _mm_set1_epi8('\n');
+    while(fin - p >= 16){
+        __m128i bloque = _mm_loadu_si128((const __m128i*)p);
+        int mascara = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bloque, coma),
+                                                     _mm_cmpeq_epi8(bloque, salto)));
+        if(mascara != 0) return p + __builtin_ctz(mascara);
+        p += 16;
+    }
+#endif
+    while(p < fin && *p != ',' && *p != '\n') p++;
+    return p;
+}
+
+// Próximo '\n' en [p, fin), o fin si no hay
+static const char* buscar_salto(const char* p, const char* fin){
+    const char* salto = memchr(p, '\n', fin - p);
+    return salto != NULL ? salto : fin;
+}
+
+// Entero no negativo en [p, fin), admitiendo espacios alrededor. 0 si ok.
+static int leer_entero(const char* p, const char* fin, int* valor){
+    while(p < fin && (*p == ' ' || *p == '\t')) p++;
+    while(fin > p && (fin[-1] == ' ' || fin[-1] == '\t' || fin[-1] == '\r')) fin--;
+    if(p == fin || fin - p > 9) return -1;
+
+    int numero = 0;
+    for(; p < fin; p++){
+        if(*p < '0' || *p > '9') return -1;
+        numero = numero * 10 + (*p - '0');
+    }
+    *valor = numero;
+    return 0;
+}
+
+// Marca la línea inválida y avanza a la siguiente
+static int rechazar(LectorCsv* lector, const char* fin_linea, const char* motivo){
+    snprintf(lector->error, sizeof(lector->error), "línea %d: %s", lector->linea, motivo);
+    lector->posicion = fin_linea - lector->datos + 1;
+    return -1;
+}
+
+int lector_siguiente(LectorCsv* lector, RegistroCsv* registro){
+    const char* fin = lector->datos + lector->tam;
+
+    while(lector->posicion < lector->tam){
+        const char* p = lector->datos + lector->posicion;
+        lector->linea++;
+
+        // Nombre: hasta la primera coma
+        const char* coma = buscar_separador(p, fin);
+        if(coma == fin || *coma == '\n'){
+            // Línea sin comas: vacía (se salta) o inválida
+            const char* q = p;
+            while(q < coma && (*q == ' ' || *q == '\t' || *q == '\r')) q++;
+            if(q == coma){
+                lector->posicion = coma - lector->datos + 1;
+                continue;
+            }
+            return rechazar(lector, coma, "faltan campos (se espera grupo,hora,personas)");
+        }
+        if(coma == p) return rechazar(lector, buscar_salto(coma, fin), "nombre de grupo vacío");
+        if(coma - p > MAX_NOMBRE) return rechazar(lector, buscar_salto(coma, fin), "nombre de grupo demasiado largo");
+
+        // Hora: hasta la segunda coma
+        const char* coma2 = buscar_separador(coma + 1, fin);
+        if(coma2 == fin || *coma2 == '\n') return rechazar(lector, coma2, "falta la cantidad de personas");
+
+        // Personas: hasta el fin de línea (una coma más es un campo de sobra)
+        const char* fin_linea = buscar_separador(coma2 + 1, fin);
+        if(fin_linea < fin && *fin_linea == ',') return rechazar(lector, buscar_salto(fin_linea, fin), "campos de sobra");
+
+        if(leer_entero(coma + 1, coma2, &registro->hora) == -1){
+            return rechazar(lector, fin_linea, "hora no numérica");
+        }
+        if(leer_entero(coma2 + 1, fin_linea, &registro->personas) == -1){
+            return rechazar(lector, fin_linea, "cantidad de personas no numérica");
+        }
+
+        registro->nombre = p;
+        registro->largo = coma - p;
+        registro->linea = lector->linea;
+        lector->posicion = fin_linea - lector->datos + 1;
+
+        // Centinela de fin de archivo
+        if(registro->largo == 3 && memcmp(p, "Fin", 3) == 0 && registro->hora == 0 && registro->personas == 0){
+            lector->posicion = lector->tam;
+            return 0;
+        }
+        return 1;
+    }
+    return 0;
+}
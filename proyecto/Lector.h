@@ -0,0 +1,37 @@
+#ifndef LECTOR_H
+#define LECTOR_H
+
+#include <stddef.h>
+
+// Lector de archivos de solicitudes "grupo,hora,personas" sobre mmap.
+// Los registros se analizan en el lugar: el nombre es un tramo dentro del
+// archivo mapeado (sin copiar y sin límite de 50 bytes), válido hasta
+// lector_cerrar. Los separadores se buscan de a 16 bytes con SSE2 cuando
+// está disponible. La línea "Fin,0,0" marca el final del archivo.
+
+typedef struct {
+    const char* nombre;           // Tramo del nombre (sin '\0')
+    int largo;
+    int hora;
+    int personas;
+    int linea;                    // Nº de línea en el archivo (desde 1)
+} RegistroCsv;
+
+typedef struct {
+    const char* datos;            // Archivo mapeado
+    size_t tam;
+    size_t posicion;              // Inicio de la próxima línea
+    int linea;                    // Líneas consumidas
+    char error[160];              // Descripción del último error
+} LectorCsv;
+
+// 0 si ok, -1 con errno si no se pudo abrir o mapear
+int lector_abrir(LectorCsv* lector, const char* ruta);
+void lector_cerrar(LectorCsv* lector);
+
+// Siguiente registro. Devuelve 1 si hay registro, 0 al final (fin del archivo
+// o "Fin,0,0") y -1 si la línea es inválida: 'error' dice por qué y la
+// lectura puede seguir con la línea siguiente. Las líneas vacías se saltan.
+int lector_siguiente(LectorCsv* lector, RegistroCsv* registro);
+
+#endif
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Metricas.h"
+
+_Thread_local MetricasHilo* metricas_hilo = NULL;
+
+static int64_t monotonico_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int metricas_crear(Metricas* m, int hilos){
+    m->maximo = hilos > 0 ? hilos : 0;
+    m->hilos = calloc(m->maximo > 0 ? m->maximo : 1, sizeof(MetricasHilo*));
+    atomic_init(&m->cantidad, 0);
+    if(m->hilos == NULL) return -1;
+    if(pthread_mutex_init(&m->bloqueo, NULL) != 0){
+        free(m->hilos);
+        return -1;
+    }
+
+    // Ticks por ns: contar ticks durante 20 ms de reloj monotónico
+    int64_t ns_antes = monotonico_ns();
+    uint64_t ticks_antes = metricas_ahora();
+    struct timespec pausa = { 0, 20000000 };
+    nanosleep(&pausa, NULL);
+    int64_t ns = monotonico_ns() - ns_antes;
+    uint64_t ticks = metricas_ahora() - ticks_antes;
+    m->ticks_por_ns = (ns > 0 && ticks > 0) ? (double)ticks / ns : 1.0;
+    return 0;
+}
+
+void metricas_destruir(Metricas* m){
+    int cantidad = atomic_load(&m->cantidad);
+    for(int i=0; i<cantidad; i++) free(m->hilos[i]);
+    free(m->hilos);
+    m->hilos = NULL;
+    pthread_mutex_destroy(&m->bloqueo);
+}
+
+int metricas_registrar(Metricas* m, const char* nombre){
+    MetricasHilo* propias = calloc(1, sizeof(MetricasHilo));
+    if(propias == NULL) return -1;
+    snprintf(propias->nombre, sizeof(propias->nombre), "%s", nombre);
+
+    pthread_mutex_lock(&m->bloqueo);
+    int cantidad = atomic_load_explicit(&m->cantidad, memory_order_relaxed);
+    if(cantidad == m->maximo){
+        pthread_mutex_unlock(&m->bloqueo);
+        free(propias);
+        return -1;
+    }
+    m->hilos[cantidad] = propias;
+    atomic_store_explicit(&m->cantidad, cantidad + 1, memory_order_release);  // Publicar ya armado
+    pthread_mutex_unlock(&m->bloqueo);
+
+    metricas_hilo = propias;
+    return 0;
+}
+
+// Valor representativo de una cubeta: el punto medio de su rango
+static uint64_t valor_cubeta(int cubeta){
+    if(cubeta < SUBCUBETAS) return cubeta;
+    int corrimiento = cubeta / SUBCUBETAS - 1;
+    uint64_t inferior = (uint64_t)(SUBCUBETAS + cubeta % SUBCUBETAS) << corrimiento;
+    return inferior + ((1ULL << corrimiento) >> 1);
+}
+
+// Primer valor que deja por debajo al menos 'fraccion' de las muestras
+static uint64_t percentil(const uint64_t cuentas[], uint64_t total, double fraccion){
+    uint64_t objetivo = (uint64_t)(fraccion * total + 0.5), acumulado = 0;
+    if(objetivo == 0) objetivo = 1;
+    for(int i=0; i<CUBETAS; i++){
+        acumulado += cuentas[i];
+        if(acumulado >= objetivo) return valor_cubeta(i);
+    }
+    return valor_cubeta(CUBETAS - 1);
+}
+
+void metricas_imprimir(Metricas* m, FILE* salida){
+    static const char* nombres[NUM_ETAPAS] = { "decodificar", "espera_cerrojo", "admision", "respuesta" };
+    int cantidad = atomic_load_explicit(&m->cantidad, memory_order_acquire);
+    double us = 1000.0 * m->ticks_por_ns;              // Ticks por µs
+    uint64_t* cuentas = malloc(CUBETAS * sizeof(uint64_t));
+    if(cuentas == NULL) return;
+
+    fprintf(salida, "latencia por etapa (se mide 1 de cada %d operaciones; espera_cerrojo: todas)\n",
+            METRICAS_MUESTREO);
+    fprintf(salida, "%-16s %12s %10s %10s %10s %10s\n", "etapa", "muestras", "p50(us)", "p99(us)", "p99.9(us)", "max(us)");
+    for(int e=0; e<NUM_ETAPAS; e++){
+        // Suma de los histogramas de todos los hilos (lecturas sin cerrojo)
+        memset(cuentas, 0, CUBETAS * sizeof(uint64_t));
+        uint64_t total = 0, maximo = 0;
+        for(int h=0; h<cantidad; h++){
+            Histograma* histograma = &m->hilos[h]->etapas[e];
+            for(int i=0; i<CUBETAS; i++){
+                uint64_t cuenta = atomic_load_explicit(&histograma->cuentas[i], memory_order_relaxed);
+                cuentas[i] += cuenta;
+                total += cuenta;
+            }
+            uint64_t max_hilo = atomic_load_explicit(&histograma->maximo, memory_order_relaxed);
+            if(max_hilo > maximo) maximo = max_hilo;
+        }
+        if(total == 0){
+            fprintf(salida, "%-16s %12d %10s %10s %10s %10s\n", nombres[e], 0, "-", "-", "-", "-");
+            continue;
+        }
+        fprintf(salida, "%-16s %12llu %10.2f %10.2f %10.2f %10.2f\n", nombres[e], (unsigned long long)total,
+                percentil(cuentas, total, 0.50) / us, percentil(cuentas, total, 0.99) / us,
+                percentil(cuentas, total, 0.999) / us, maximo / us);
+    }
+    uint64_t sin_cerrojo = 0;
+    for(int h=0; h<cantidad; h++){
+        sin_cerrojo += atomic_load_explicit(&m->hilos[h]->sin_cerrojo, memory_order_relaxed);
+    }
+    fprintf(salida, "%-16s %12llu (reservas de la vía rápida, fuera de espera_cerrojo)\n", "sin_cerrojo",
+            (unsigned long long)sin_cerrojo);
+    free(cuentas);
+}
@@ -0,0 +1,97 @@
+#include <stdlib.h>
+#include <string.h>
+#include "Nombres.h"
+
+#define CELDAS_INICIAL 1024
+
+int nombres_crear(Nombres* nombres, Arena* arena){
+    memset(nombres, 0, sizeof(*nombres));
+    nombres->arena = arena;
+    nombres->celdas = malloc(CELDAS_INICIAL * sizeof(int));
+    if(nombres->celdas == NULL) return -1;
+    memset(nombres->celdas, -1, CELDAS_INICIAL * sizeof(int));
+    nombres->capacidad = CELDAS_INICIAL;
+    return 0;
+}
+
+void nombres_destruir(Nombres* nombres){
+    free(nombres->textos);
+    free(nombres->hashes);
+    free(nombres->largos);
+    free(nombres->celdas);
+    memset(nombres, 0, sizeof(*nombres));
+}
+
+// FNV-1a de 32 bits
+uint32_t nombres_hash(const char* texto, int largo){
+    uint32_t h = 2166136261u;
+    for(int i=0; i<largo; i++){
+        h ^= (unsigned char)texto[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Duplica las celdas y reubica los IDs con sus hashes guardados
+static int crecer_celdas(Nombres* nombres){
+    int capacidad = nombres->capacidad * 2;
+    int* celdas = malloc(capacidad * sizeof(int));
+    if(celdas == NULL) return -1;
+    memset(celdas, -1, capacidad * sizeof(int));
+
+    for(int id=0; id<nombres->cantidad; id++){
+        int i = nombres->hashes[id] & (capacidad - 1);
+        while(celdas[i] != -1) i = (i + 1) & (capacidad - 1);
+        celdas[i] = id;
+    }
+    free(nombres->celdas);
+    nombres->celdas = celdas;
+    nombres->capacidad = capacidad;
+    return 0;
+}
+
+// Agranda los arreglos indexados por ID
+static int crecer_ids(Nombres* nombres){
+    int capacidad = nombres->capacidad_ids ? nombres->capacidad_ids * 2 : 256;
+    const char** textos = realloc(nombres->textos, capacidad * sizeof(char*));
+    if(textos == NULL) return -1;
+    nombres->textos = textos;
+    uint32_t* hashes = realloc(nombres->hashes, capacidad * sizeof(uint32_t));
+    if(hashes == NULL) return -1;
+    nombres->hashes = hashes;
+    int* largos = realloc(nombres->largos, capacidad * sizeof(int));
+    if(largos == NULL) return -1;
+    nombres->largos = largos;
+    nombres->capacidad_ids = capacidad;
+    return 0;
+}
+
+int nombres_internar(Nombres* nombres, const char* texto, int largo, uint32_t hash){
+    // Mantener la ocupación por debajo de 1/2 (el sondeo siempre termina)
+    if((nombres->cantidad + 1) * 2 > nombres->capacidad && crecer_celdas(nombres) == -1) return -1;
+
+    int mascara = nombres->capacidad - 1;
+    int i = hash & mascara;
+    while(nombres->celdas[i] != -1){
+        int id = nombres->celdas[i];
+        if(nombres->hashes[id] == hash && nombres->largos[id] == largo &&
+           memcmp(nombres->textos[id], texto, largo) == 0){
+            return id;                                  // Ya estaba
+        }
+        i = (i + 1) & mascara;
+    }
+
+    // Nombre nuevo: copiarlo una sola vez a la arena
+    if(nombres->cantidad == nombres->capacidad_ids && crecer_ids(nombres) == -1) return -1;
+    char* copia = arena_reservar(nombres->arena, largo + 1);
+    if(copia == NULL) return -1;
+    memcpy(copia, texto, largo);
+    copia[largo] = '\0';
+
+    int id = nombres->cantidad++;
+    nombres->textos[id] = copia;
+    nombres->hashes[id] = hash;
+    nombres->largos[id] = largo;
+    nombres->celdas[i] = id;
+    return id;
+}
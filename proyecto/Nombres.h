@@ -0,0 +1,42 @@
+#ifndef NOMBRES_H
+#define NOMBRES_H
+
+#include <stdint.h>
+#include "Arena.h"
+
+// Tabla de nombres internados: cada nombre distinto se guarda una sola vez
+// (en la arena, terminado en '\0') y se identifica por un entero. Un grupo
+// que reserva muchas veces ocupa lo mismo que uno que reserva una.
+// Los nombres llegan con su largo y pueden traer '\0' adentro: se comparan
+// por largo y bytes, nunca como cadenas.
+// Sin cerrojo propio: la protege quien la use (la agenda).
+typedef struct {
+    Arena* arena;                 // Donde viven los textos
+    const char** textos;          // ID -> texto
+    uint32_t* hashes;             // ID -> hash (evita recalcular al crecer)
+    int* largos;                  // ID -> largo del texto
+    int cantidad;                 // Nombres distintos
+    int capacidad_ids;            // Tamaño de textos/hashes/largos
+    int* celdas;                  // Hash abierto de IDs (-1 = vacía)
+    int capacidad;                // Celdas, siempre potencia de 2
+} Nombres;
+
+// 0 si ok, -1 sin memoria
+int nombres_crear(Nombres* nombres, Arena* arena);
+void nombres_destruir(Nombres* nombres);
+
+// Hash del nombre; se puede calcular fuera del cerrojo
+uint32_t nombres_hash(const char* texto, int largo);
+
+// ID del nombre, agregándolo si es nuevo. -1 sin memoria.
+int nombres_internar(Nombres* nombres, const char* texto, int largo, uint32_t hash);
+
+static inline const char* nombres_texto(const Nombres* nombres, int id){
+    return nombres->textos[id];
+}
+
+static inline int nombres_largo(const Nombres* nombres, int id){
+    return nombres->largos[id];
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Parques.h"
+
+// Valida un parque leído; devuelve el motivo si es inválido, o NULL
+static const char* config_invalida(const ConfigParque* c, const ConfigParque configs[], int cantidad){
+    if(c->id < 0 || c->id >= MAX_PARQUES) return "ID fuera de rango";
+    for(int i=0; i<cantidad; i++){
+        if(configs[i].id == c->id) return "ID repetido";
+    }
+    if(c->capacidad <= 0) return "capacidad inválida";
+    if(c->apertura < 0 || c->cierre > 24 || c->apertura >= c->cierre) return "horario inválido";
+    if(c->minutos <= 0 || 60 % c->minutos != 0) return "las franjas deben dividir la hora";
+    if(c->minutos_visita <= 0 || c->minutos_visita % c->minutos != 0) return "la visita debe ocupar franjas enteras";
+    return NULL;
+}
+
+int parques_leer(const char* ruta, ConfigParque** configs){
+    FILE* archivo = fopen(ruta, "r");
+    if(archivo == NULL){
+        perror("Error al abrir la configuración de parques");
+        return -1;
+    }
+
+    ConfigParque* lista = NULL;
+    int cantidad = 0, capacidad = 0, numero = 0;
+    char linea[256];
+    while(fgets(linea, sizeof(linea), archivo) != NULL){
+        numero++;
+        char* comentario = strchr(linea, '#');
+        if(comentario != NULL) *comentario = '\0';
+        if(strspn(linea, " \t\r\n") == strlen(linea)) continue;     // Línea vacía
+
+        ConfigParque c;
+        float visita;
+        if(sscanf(linea, "%d,%d,%d,%d,%d,%f", &c.id, &c.capacidad, &c.apertura, &c.cierre, &c.minutos, &visita) != 6){
+            fprintf(stderr, "%s:%d: se esperaba id,capacidad,apertura,cierre,minutos,visita\n", ruta, numero);
+            goto error;
+        }
+        c.minutos_visita = (int)(visita * 60 + 0.5f);
+        const char* motivo = config_invalida(&c, lista, cantidad);
+        if(motivo != NULL){
+            fprintf(stderr, "%s:%d: parque %d: %s\n", ruta, numero, c.id, motivo);
+            goto error;
+        }
+
+        if(cantidad == capacidad){
+            capacidad = capacidad > 0 ? capacidad * 2 : 8;
+            ConfigParque* mayor = realloc(lista, capacidad * sizeof(ConfigParque));
+            if(mayor == NULL){
+                fprintf(stderr, "Sin memoria para la configuración de parques\n");
+                goto error;
+            }
+            lista = mayor;
+        }
+        lista[cantidad++] = c;
+    }
+    fclose(archivo);
+
+    if(cantidad == 0){
+        fprintf(stderr, "%s: no hay parques configurados\n", ruta);
+        free(lista);
+        return -1;
+    }
+    *configs = lista;
+    return cantidad;
+
+error:
+    fclose(archivo);
+    free(lista);
+    return -1;
+}
+
+int parques_crear(Parques* p, const ConfigParque* configs, int cantidad, int inicio, int fin){
+    p->cantidad = 0;
+    for(int id=0; id<MAX_PARQUES; id++) p->posicion[id] = -1;
+    p->lista = aligned_alloc(_Alignof(Parque), cantidad * sizeof(Parque));
+    if(p->lista == NULL) return -1;
+
+    for(int i=0; i<cantidad; i++){
+        const ConfigParque* c = &configs[i];
+        Parque* parque = &p->lista[i];
+        memset(parque, 0, sizeof(Parque));
+
+        // Horario real: el del parque dentro del de la simulación
+        parque->id = c->id;
+        parque->apertura = (inicio <= c->apertura) ? c->apertura : inicio;
+        parque->cierre = (fin <= c->cierre) ? fin : c->cierre;
+        int horas = (fin == parque->apertura) ? 1 : parque->cierre - parque->apertura;
+        if(horas < 1) horas = 1;                    // Cerrado durante la simulación: una franja sin uso
+
+        if(agenda_crear(&parque->agenda, parque->apertura, c->minutos, horas * 60 / c->minutos, c->capacidad,
+                        c->minutos_visita / c->minutos) == -1){
+            parques_destruir(p);
+            return -1;
+        }
+        for(int t=0; t<3; t++) atomic_init(&parque->estadisticas[t], 0);
+        p->posicion[c->id] = i;
+        p->cantidad++;
+    }
+    return 0;
+}
+
+void parques_destruir(Parques* p){
+    for(int i=0; i<p->cantidad; i++){
+        agenda_destruir(&p->lista[i].agenda);
+        free(p->lista[i].prefijo_diario);
+    }
+    free(p->lista);
+    p->lista = NULL;
+    p->cantidad = 0;
+}
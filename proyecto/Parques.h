@@ -0,0 +1,61 @@
+#ifndef PARQUES_H
+#define PARQUES_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "Agenda.h"
+#include "Diario.h"
+
+// Varios parques (sedes) atendidos por un mismo controlador. Cada uno tiene
+// su capacidad, su horario y su largo de franja, y su propia agenda: el
+// estado de admisión está partido por parque. Cada parque tiene un dueño,
+// el trabajador posicion % hilos, que es el único que decide sus reservas,
+// así que dos parques nunca compiten por un cerrojo.
+// Configuración (-P): un parque por línea "id,capacidad,apertura,cierre,minutos,visita"
+// (visita en horas, admite fracción); '#' comenta el resto de la línea.
+
+#define MAX_PARQUES 1024              // IDs de parque válidos: 0 .. MAX_PARQUES - 1
+
+// Un parque tal como se configura (horario del parque, no de la simulación)
+typedef struct {
+    int id;
+    int capacidad;
+    int apertura, cierre;         // Horas
+    int minutos;                  // Minutos por franja (divide a 60)
+    int minutos_visita;           // Múltiplo de 'minutos'
+} ConfigParque;
+
+typedef struct {
+    int id;
+    int apertura, cierre;         // Horario real (recortado al de la simulación)
+    Agenda agenda;                // Ocupación, índice y grupos de este parque
+    Diario diario;
+    int con_diario;               // 1 si 'diario' está abierto
+    char* prefijo_diario;         // Prefijo de sus archivos (propio si hay varios parques)
+    // Solo los escribe el trabajador dueño; en línea propia para no
+    // compartirla con los contadores de otro parque
+    _Alignas(64) _Atomic int estadisticas[3];   // Confirmadas / Reprogramadas / Denegadas
+} Parque;
+
+typedef struct {
+    Parque* lista;                // En el orden de la configuración
+    int cantidad;
+    int16_t posicion[MAX_PARQUES];   // ID -> posición en 'lista', -1 si no existe
+} Parques;
+
+// Lee la configuración de 'ruta'. Devuelve la cantidad de parques (con
+// *configs en malloc), o -1 si no se pudo leer o es inválida (avisa por stderr).
+int parques_leer(const char* ruta, ConfigParque** configs);
+
+// Crea la agenda de cada parque con su horario recortado a [inicio, fin].
+// 0 si ok, -1 sin memoria.
+int parques_crear(Parques* p, const ConfigParque* configs, int cantidad, int inicio, int fin);
+void parques_destruir(Parques* p);
+
+// Parque con ese ID, o NULL si no está configurado
+static inline Parque* parques_buscar(const Parques* p, uint32_t id){
+    if(id >= MAX_PARQUES || p->posicion[id] < 0) return NULL;
+    return &p->lista[p->posicion[id]];
+}
+
+#endif
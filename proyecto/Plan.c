@@ -0,0 +1,387 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "Plan.h"
+
+#define MUESTRA_PLAN 64               // Pedidos que se desarman y rearman por intento
+
+int plan_crear(ProblemaPlan* p, int franjas, int visita, int capacidad, ObjetivoPlan objetivo){
+    memset(p, 0, sizeof(*p));
+    p->franjas = franjas;
+    p->visita = visita;
+    p->capacidad = capacidad;
+    p->objetivo = objetivo;
+    p->reservados = 1024;
+    p->pedidos = malloc(p->reservados * sizeof(PedidoPlan));
+    return p->pedidos == NULL ? -1 : 0;
+}
+
+void plan_destruir(ProblemaPlan* p){
+    free(p->pedidos);
+    p->pedidos = NULL;
+}
+
+int plan_agregar(ProblemaPlan* p, PedidoPlan pedido){
+    if(p->cantidad == p->reservados){
+        PedidoPlan* mayor = realloc(p->pedidos, 2 * p->reservados * sizeof(PedidoPlan));
+        if(mayor == NULL) return -1;
+        p->pedidos = mayor;
+        p->reservados *= 2;
+    }
+    p->pedidos[p->cantidad++] = pedido;
+    return 0;
+}
+
+int solucion_crear(SolucionPlan* s, const ProblemaPlan* p){
+    memset(s, 0, sizeof(*s));
+    s->inicio = malloc((p->cantidad > 0 ? p->cantidad : 1) * sizeof(int));
+    return s->inicio == NULL ? -1 : 0;
+}
+
+void solucion_destruir(SolucionPlan* s){
+    free(s->inicio);
+    s->inicio = NULL;
+}
+
+// Lo que suma un pedido admitido al objetivo
+static inline long peso(const ProblemaPlan* p, int i){
+    return p->objetivo == OBJETIVO_PERSONAS ? p->pedidos[i].personas : 1;
+}
+
+// Valor comparable de una solución: peso admitido y, a igualdad, confirmadas
+static long valor(const ProblemaPlan* p, long grupos, long personas, long confirmadas){
+    long admitido = p->objetivo == OBJETIVO_PERSONAS ? personas : grupos;
+    return admitido * (p->cantidad + 1) + confirmadas;
+}
+
+// Un pedido que puede entrar en alguna ventana del día
+static inline int ubicable(const ProblemaPlan* p, int i){
+    int desde = p->pedidos[i].desde;
+    return desde >= 0 && desde <= p->franjas - p->visita && p->pedidos[i].personas <= p->capacidad;
+}
+
+int plan_voraz(const ProblemaPlan* p, SolucionPlan* s){
+    IndiceCapacidad indice;
+    if(indice_crear(&indice, p->franjas, p->visita, p->capacidad) == -1) return -1;
+
+    s->grupos = s->personas = s->confirmadas = 0;
+    for(int i=0; i<p->cantidad; i++){
+        const PedidoPlan* pedido = &p->pedidos[i];
+        s->inicio[i] = pedido->desde >= 0 ? indice_buscar(&indice, pedido->desde, pedido->personas) : -1;
+        if(s->inicio[i] == -1) continue;
+        indice_sumar(&indice, s->inicio[i], -pedido->personas);
+        s->grupos++;
+        s->personas += pedido->personas;
+        if(s->inicio[i] == pedido->pedida) s->confirmadas++;
+    }
+    indice_destruir(&indice);
+    return 0;
+}
+
+static int comparar_personas(const void* a, const void* b){
+    const PedidoPlan* x = a;
+    const PedidoPlan* y = b;
+    return (x->personas > y->personas) - (x->personas < y->personas);
+}
+
+long plan_cota(const ProblemaPlan* p){
+    // Los pedidos que empiezan en f o después solo usan las franjas [f, fin):
+    // admiten a lo sumo capacidad * (franjas - f) / visita personas. Para
+    // cada f, eso más todo lo que empieza antes es una cota; vale la menor.
+    int franjas = p->franjas;
+    PedidoPlan* orden = malloc((p->cantidad > 0 ? p->cantidad : 1) * sizeof(PedidoPlan));
+    long* demanda = calloc(franjas + 1, sizeof(long));    // Peso de los que empiezan en cada franja
+    if(orden == NULL || demanda == NULL){
+        free(orden);
+        free(demanda);
+        return -1;
+    }
+    int ubicables = 0;
+    for(int i=0; i<p->cantidad; i++){
+        if(!ubicable(p, i)) continue;
+        demanda[p->pedidos[i].desde] += peso(p, i);
+        orden[ubicables++] = p->pedidos[i];
+    }
+
+    // Para grupos: de los que empiezan en f o después entran primero los más chicos
+    if(p->objetivo == OBJETIVO_GRUPOS) qsort(orden, ubicables, sizeof(PedidoPlan), comparar_personas);
+
+    long antes = 0, cota = -1;
+    for(int f=0; f<=franjas; f++){
+        long cupo = (long)p->capacidad * (franjas - f) / p->visita;
+        long despues = 0;
+        if(p->objetivo == OBJETIVO_PERSONAS){
+            for(int g=f; g<franjas; g++) despues += demanda[g];
+            if(despues > cupo) despues = cupo;
+        } else {
+            long usado = 0;
+            for(int k=0; k<ubicables; k++){
+                const PedidoPlan* pedido = &orden[k];
+                if(pedido->desde < f) continue;
+                if(usado + pedido->personas > cupo) break;
+                usado += pedido->personas;
+                despues++;
+            }
+        }
+        if(cota == -1 || antes + despues < cota) cota = antes + despues;
+        if(f < franjas) antes += demanda[f];
+    }
+    free(orden);
+    free(demanda);
+    return cota;
+}
+
+// Estado de búsqueda de un hilo
+typedef struct {
+    const ProblemaPlan* p;
+    const int* por_desde;         // Pedidos ubicables ordenados por franja de inicio
+    const int* primero;           // Por franja: primera posición en por_desde
+    IndiceCapacidad indice;
+    int* inicio;
+    long grupos, personas, confirmadas;
+    unsigned semilla;
+    int* muestra;                 // Pedidos del intento
+    double* claves;               // Orden de reinserción
+    int* anterior;                // Inicio de cada pedido de la muestra antes del intento
+    unsigned* marca;              // Ronda de muestreo en que se eligió cada pedido
+    unsigned sello;
+} Busqueda;
+
+typedef struct {
+    Busqueda* busquedas;
+    int hilos, rondas;
+    long iteraciones;
+    pthread_barrier_t barrera;
+    int mejor;                    // Hilo con la mejor solución de la ronda
+} Coordinacion;
+
+typedef struct {
+    Coordinacion* coordinacion;
+    int numero;
+} ParametrosBusqueda;
+
+static void ubicar(Busqueda* b, int i, int franja){
+    const PedidoPlan* pedido = &b->p->pedidos[i];
+    b->inicio[i] = franja;
+    indice_sumar(&b->indice, franja, -pedido->personas);
+    b->grupos++;
+    b->personas += pedido->personas;
+    if(franja == pedido->pedida) b->confirmadas++;
+}
+
+static void quitar(Busqueda* b, int i){
+    const PedidoPlan* pedido = &b->p->pedidos[i];
+    indice_sumar(&b->indice, b->inicio[i], pedido->personas);
+    b->grupos--;
+    b->personas -= pedido->personas;
+    if(b->inicio[i] == pedido->pedida) b->confirmadas--;
+    b->inicio[i] = -1;
+}
+
+// Copia la solución de 'origen' (mismo problema)
+static void copiar_busqueda(Busqueda* destino, const Busqueda* origen){
+    int cantidad = origen->p->cantidad;
+    memcpy(destino->inicio, origen->inicio, cantidad * sizeof(int));
+    memcpy(destino->indice.libre, origen->indice.libre, origen->indice.franjas * sizeof(int));
+    memcpy(destino->indice.mejor, origen->indice.mejor, 2 * origen->indice.hojas * sizeof(int));
+    destino->grupos = origen->grupos;
+    destino->personas = origen->personas;
+    destino->confirmadas = origen->confirmadas;
+}
+
+static double azar(unsigned* semilla){
+    return rand_r(semilla) / ((double)RAND_MAX + 1);
+}
+
+// Un intento: desarmar lo que toca un tramo de franjas y rearmar con los
+// pedidos de la muestra, primero lo que más pesa (con ruido). Queda si no empeora.
+static void intentar(Busqueda* b){
+    const ProblemaPlan* p = b->p;
+    int visita = p->visita;
+    int a = rand_r(&b->semilla) % p->franjas;
+    int fin = a + 1 + rand_r(&b->semilla) % (2 * visita);
+    if(fin > p->franjas) fin = p->franjas;
+
+    // Pedidos que pueden empezar cerca del tramo
+    int desde = a - visita < 0 ? 0 : a - visita;
+    int primero = b->primero[desde], ultimo = b->primero[fin];
+    int disponibles = ultimo - primero;
+    if(disponibles == 0) return;
+
+    int cantidad = 0;
+    b->sello++;
+    if(disponibles <= MUESTRA_PLAN){
+        for(int k=primero; k<ultimo; k++) b->muestra[cantidad++] = b->por_desde[k];
+    } else {
+        for(int k=0; k<MUESTRA_PLAN; k++){
+            int i = b->por_desde[primero + rand_r(&b->semilla) % disponibles];
+            if(b->marca[i] == b->sello) continue;
+            b->marca[i] = b->sello;
+            b->muestra[cantidad++] = i;
+        }
+    }
+
+    long antes = valor(p, b->grupos, b->personas, b->confirmadas);
+
+    // Desarmar los admitidos de la muestra que se superponen con el tramo
+    // (a veces, no todos: así el vecindario cambia de forma)
+    double quitar_prob = 0.5 + 0.5 * azar(&b->semilla);
+    for(int k=0; k<cantidad; k++){
+        int i = b->muestra[k];
+        b->anterior[k] = b->inicio[i];
+        if(b->inicio[i] >= 0 && b->inicio[i] + visita > a && b->inicio[i] < fin && azar(&b->semilla) < quitar_prob){
+            quitar(b, i);
+        }
+    }
+
+    // Rearmar: los que quedaron afuera, la mitad de las veces por peso con
+    // ruido (los grupos chicos primero si se cuentan grupos) y la otra mitad
+    // al azar. Ordenamiento por inserción: la muestra es chica.
+    int afuera = 0, al_azar = rand_r(&b->semilla) & 1;
+    for(int k=0; k<cantidad; k++){
+        int i = b->muestra[k];
+        if(b->inicio[i] != -1) continue;
+        double ruido = azar(&b->semilla);
+        double clave = al_azar ? ruido : p->objetivo == OBJETIVO_PERSONAS ? p->pedidos[i].personas * (1.0 + 0.6 * ruido)
+                                                                           : (1.0 + 0.6 * ruido) / p->pedidos[i].personas;
+        int pos = afuera++;
+        while(pos > 0 && b->claves[pos-1] < clave){
+            b->claves[pos] = b->claves[pos-1];
+            b->muestra[cantidad + pos] = b->muestra[cantidad + pos - 1];
+            pos--;
+        }
+        b->claves[pos] = clave;
+        b->muestra[cantidad + pos] = i;
+    }
+    for(int k=0; k<afuera; k++){
+        int i = b->muestra[cantidad + k];
+        int franja = indice_buscar(&b->indice, p->pedidos[i].desde, p->pedidos[i].personas);
+        if(franja != -1) ubicar(b, i, franja);
+    }
+
+    if(valor(p, b->grupos, b->personas, b->confirmadas) >= antes) return;
+
+    // Empeoró: volver atrás (primero liberar todo, después reponer)
+    for(int k=0; k<cantidad; k++){
+        int i = b->muestra[k];
+        if(b->inicio[i] != -1) quitar(b, i);
+    }
+    for(int k=0; k<cantidad; k++){
+        if(b->anterior[k] != -1) ubicar(b, b->muestra[k], b->anterior[k]);
+    }
+}
+
+static void* buscar(void* argumento){
+    ParametrosBusqueda* parametros = argumento;
+    Coordinacion* c = parametros->coordinacion;
+    Busqueda* propia = &c->busquedas[parametros->numero];
+
+    for(int ronda=0; ronda<c->rondas; ronda++){
+        for(long n=0; n<c->iteraciones; n++) intentar(propia);
+
+        // Fin de ronda: uno elige la mejor y los demás siguen desde ella
+        if(pthread_barrier_wait(&c->barrera) == PTHREAD_BARRIER_SERIAL_THREAD){
+            int mejor = 0;
+            for(int h=1; h<c->hilos; h++){
+                Busqueda* b = &c->busquedas[h];
+                Busqueda* m = &c->busquedas[mejor];
+                if(valor(b->p, b->grupos, b->personas, b->confirmadas) >
+                   valor(m->p, m->grupos, m->personas, m->confirmadas)) mejor = h;
+            }
+            c->mejor = mejor;
+        }
+        pthread_barrier_wait(&c->barrera);
+        if(parametros->numero != c->mejor) copiar_busqueda(propia, &c->busquedas[c->mejor]);
+        pthread_barrier_wait(&c->barrera);
+    }
+    return NULL;
+}
+
+static void busqueda_destruir(Busqueda* b){
+    indice_destruir(&b->indice);
+    free(b->inicio);
+    free(b->muestra);
+    free(b->claves);
+    free(b->anterior);
+    free(b->marca);
+}
+
+int plan_mejorar(const ProblemaPlan* p, SolucionPlan* solucion, int hilos, int rondas, long iteraciones,
+                 unsigned semilla){
+    if(hilos < 1 || p->cantidad == 0) return p->cantidad == 0 ? 0 : -1;
+
+    // Pedidos ubicables agrupados por franja de inicio (conteo y acumulado)
+    int* primero = calloc(p->franjas + 2, sizeof(int));
+    int* por_desde = malloc(p->cantidad * sizeof(int));
+    Busqueda* busquedas = calloc(hilos, sizeof(Busqueda));
+    ParametrosBusqueda* parametros = malloc(hilos * sizeof(ParametrosBusqueda));
+    pthread_t* ids = malloc(hilos * sizeof(pthread_t));
+    int estado = -1, creados = 0;
+    if(primero == NULL || por_desde == NULL || busquedas == NULL || parametros == NULL || ids == NULL) goto salir;
+
+    for(int i=0; i<p->cantidad; i++){
+        if(ubicable(p, i)) primero[p->pedidos[i].desde + 1]++;
+    }
+    for(int f=0; f<=p->franjas; f++) primero[f+1] += primero[f];
+    int* siguiente = malloc((p->franjas + 1) * sizeof(int));
+    if(siguiente == NULL) goto salir;
+    memcpy(siguiente, primero, (p->franjas + 1) * sizeof(int));
+    for(int i=0; i<p->cantidad; i++){
+        if(ubicable(p, i)) por_desde[siguiente[p->pedidos[i].desde]++] = i;
+    }
+    free(siguiente);
+
+    // Cada hilo parte de la solución recibida
+    for(int h=0; h<hilos; h++){
+        Busqueda* b = &busquedas[h];
+        b->p = p;
+        b->por_desde = por_desde;
+        b->primero = primero;
+        b->semilla = semilla + 7919u * h;
+        b->inicio = malloc(p->cantidad * sizeof(int));
+        b->muestra = malloc(2 * MUESTRA_PLAN * sizeof(int));
+        b->claves = malloc(MUESTRA_PLAN * sizeof(double));
+        b->anterior = malloc(MUESTRA_PLAN * sizeof(int));
+        b->marca = calloc(p->cantidad, sizeof(unsigned));
+        if(indice_crear(&b->indice, p->franjas, p->visita, p->capacidad) == -1 || b->inicio == NULL ||
+           b->muestra == NULL || b->claves == NULL || b->anterior == NULL || b->marca == NULL) goto salir;
+        for(int i=0; i<p->cantidad; i++){
+            b->inicio[i] = -1;
+            if(solucion->inicio[i] >= 0) ubicar(b, i, solucion->inicio[i]);
+        }
+    }
+
+    Coordinacion coordinacion = { .busquedas = busquedas, .hilos = hilos, .rondas = rondas,
+                                  .iteraciones = iteraciones, .mejor = 0 };
+    if(pthread_barrier_init(&coordinacion.barrera, NULL, hilos) != 0) goto salir;
+    for(creados=0; creados<hilos; creados++){
+        parametros[creados] = (ParametrosBusqueda){ &coordinacion, creados };
+        if(pthread_create(&ids[creados], NULL, buscar, &parametros[creados]) != 0) break;
+    }
+    if(creados < hilos){
+        // No se pudieron crear todos: la barrera nunca se completaría
+        for(int h=0; h<creados; h++) pthread_cancel(ids[h]);
+        for(int h=0; h<creados; h++) pthread_join(ids[h], NULL);
+        pthread_barrier_destroy(&coordinacion.barrera);
+        goto salir;
+    }
+    for(int h=0; h<hilos; h++) pthread_join(ids[h], NULL);
+    pthread_barrier_destroy(&coordinacion.barrera);
+
+    // Al terminar la última ronda todos tienen la mejor
+    Busqueda* mejor = &busquedas[coordinacion.mejor];
+    memcpy(solucion->inicio, mejor->inicio, p->cantidad * sizeof(int));
+    solucion->grupos = mejor->grupos;
+    solucion->personas = mejor->personas;
+    solucion->confirmadas = mejor->confirmadas;
+    estado = 0;
+
+salir:
+    for(int h=0; busquedas != NULL && h<hilos; h++) busqueda_destruir(&busquedas[h]);
+    free(busquedas);
+    free(parametros);
+    free(ids);
+    free(por_desde);
+    free(primero);
+    return estado;
+}
@@ -0,0 +1,70 @@
+#ifndef PLAN_H
+#define PLAN_H
+
+#include "Indice.h"
+
+// Planificación offline de un día completo (modo plan del controlador).
+// La admisión en línea es voraz: cada solicitud toma la primera ventana con
+// cupo en orden de llegada, y un grupo grande que llega temprano puede dejar
+// afuera a varios chicos. Con todas las solicitudes del día a mano se puede
+// elegir a quién admitir para maximizar personas (o grupos) admitidos.
+//  - Se parte de la solución voraz (la misma que daría el controlador en línea).
+//  - Búsqueda local de vecindario grande: se desarma un tramo de franjas y
+//    se vuelve a armar con una muestra de lo que quedó afuera, a veces
+//    primero lo que más suma y a veces al azar; el cambio queda si no empeora. Cada solicitud sigue tomando la primera
+//    ventana con cupo desde su franja, como en línea.
+//  - Varios hilos buscan a la vez con semillas distintas; cada ronda todos
+//    siguen desde la mejor solución de la ronda anterior. Con las mismas
+//    semillas y rondas el resultado es siempre el mismo.
+// Objetivo lexicográfico: primero el peso admitido, luego las confirmadas.
+
+typedef enum {
+    OBJETIVO_PERSONAS = 0,        // Maximizar personas admitidas
+    OBJETIVO_GRUPOS               // Maximizar grupos admitidos
+} ObjetivoPlan;
+
+// Una solicitud ya traducida a franjas (desde = -1: inválida, se deniega)
+typedef struct {
+    int desde;                    // Primera franja de inicio posible
+    int pedida;                   // Franja que cuenta como confirmada (-1 si la hora ya pasó)
+    int personas;
+} PedidoPlan;
+
+typedef struct {
+    int franjas, visita, capacidad;
+    ObjetivoPlan objetivo;
+    PedidoPlan* pedidos;          // En orden de llegada
+    int cantidad, reservados;
+} ProblemaPlan;
+
+typedef struct {
+    int* inicio;                  // Franja asignada a cada pedido, o -1
+    long grupos;                  // Admitidos
+    long personas;
+    long confirmadas;             // Admitidos en la franja pedida
+} SolucionPlan;
+
+// 0 si ok, -1 sin memoria
+int plan_crear(ProblemaPlan* p, int franjas, int visita, int capacidad, ObjetivoPlan objetivo);
+void plan_destruir(ProblemaPlan* p);
+
+// Agrega un pedido al final. 0 si ok, -1 sin memoria.
+int plan_agregar(ProblemaPlan* p, PedidoPlan pedido);
+
+// 0 si ok, -1 sin memoria. La solución sirve para un problema de ese tamaño.
+int solucion_crear(SolucionPlan* s, const ProblemaPlan* p);
+void solucion_destruir(SolucionPlan* s);
+
+// Primera ventana con cupo, en orden de llegada (lo que hace el controlador en línea)
+int plan_voraz(const ProblemaPlan* p, SolucionPlan* s);
+
+// Mejora 'solucion' con 'hilos' hilos durante 'rondas' rondas de
+// 'iteraciones' intentos por hilo. 0 si ok, -1 sin memoria o sin hilos.
+int plan_mejorar(const ProblemaPlan* p, SolucionPlan* solucion, int hilos, int rondas, long iteraciones,
+                 unsigned semilla);
+
+// Cota superior del objetivo: ningún plan admite más (relajación por
+// capacidad total: cada grupo consume personas * visita del cupo del día)
+long plan_cota(const ProblemaPlan* p);
+
+#endif
@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include "Protocolo.h"
+
+_Static_assert(MAX_MARCO <= PIPE_BUF, "Un marco debe caber en una escritura atómica");
+_Static_assert(MAX_LOTE * (int)sizeof(ResultadoLote) <= MAX_CARGA, "La respuesta de un lote debe caber en un marco");
+
+int marco_carga_maxima(int tipo){
+    return (tipo == MSG_LOTE || tipo == MSG_RESPUESTA_LOTE) ? MAX_CARGA : MAX_NOMBRE;
+}
+
+int marco_valido(const CabeceraMarco* cab){
+    return cab->tipo >= MSG_REGISTRO && cab->tipo <= MSG_RESPUESTA_LOTE &&
+           cab->longitud == TAM_CABECERA + cab->largo_nombre &&
+           cab->largo_nombre <= marco_carga_maxima(cab->tipo);
+}
+
+int marco_entrante(const CabeceraMarco* cab){
+    return (cab->tipo == MSG_REGISTRO || cab->tipo == MSG_SOLICITUD || cab->tipo == MSG_LOTE ||
+            cab->tipo == MSG_CIERRE) && marco_valido(cab);
+}
+
+int marco_codificar(char* destino, int capacidad, CabeceraMarco cab, const char* nombre, int largo){
+    if(largo < 0 || largo > marco_carga_maxima(cab.tipo) || TAM_CABECERA + largo > capacidad){
+        return -1;
+    }
+    cab.longitud = TAM_CABECERA + largo;
+    cab.largo_nombre = largo;
+
+    memcpy(destino, &cab, TAM_CABECERA);
+    if(largo > 0) memcpy(destino + TAM_CABECERA, nombre, largo);
+    return cab.longitud;
+}
+
+int marco_enviar(int fd, CabeceraMarco cab, const char* nombre, int largo){
+    char marco[PIPE_BUF];
+    int total = marco_codificar(marco, sizeof(marco), cab, nombre, largo);
+    if(total == -1) return -1;
+
+    ssize_t escritos;
+    do {
+        escritos = write(fd, marco, total);
+    } while(escritos == -1 && errno == EINTR);
+
+    return (escritos == total) ? 0 : -1;
+}
+
+void decodificador_iniciar(Decodificador* d){
+    d->inicio = 0;
+    d->usados = 0;
+    d->descartados = 0;
+}
+
+ssize_t decodificador_leer(Decodificador* d, int fd){
+    // Mover al inicio el marco incompleto que haya quedado
+    if(d->inicio > 0){
+        memmove(d->datos, d->datos + d->inicio, d->usados - d->inicio);
+        d->usados -= d->inicio;
+        d->inicio = 0;
+    }
+
+    ssize_t leidos;
+    do {
+        leidos = read(fd, d->datos + d->usados, sizeof(d->datos) - d->usados);
+    } while(leidos == -1 && errno == EINTR);
+
+    if(leidos > 0) d->usados += leidos;
+    return leidos;
+}
+
+int decodificador_siguiente(Decodificador* d, CabeceraMarco* cab, const char** nombre){
+    int disponibles;
+    while(1){
+        disponibles = d->usados - d->inicio;
+        if(disponibles < TAM_CABECERA) return 0;
+
+        // Validar la cabecera antes de confiar en sus largos
+        memcpy(cab, d->datos + d->inicio, TAM_CABECERA);
+        if(marco_valido(cab)) break;
+        d->inicio++;
+        d->descartados++;
+    }
+    if(disponibles < cab->longitud) return 0;
+
+    *nombre = d->datos + d->inicio + TAM_CABECERA;
+    d->inicio += cab->longitud;
+    return 1;
+}
+
+int lote_agregar(char* carga, int* usados, SolicitudLote solicitud, const char* nombre){
+    int largo = solicitud.largo_nombre;
+    if(largo > MAX_NOMBRE || *usados + (int)sizeof(SolicitudLote) + largo > MAX_CARGA) return -1;
+
+    solicitud.relleno = 0;
+    memcpy(carga + *usados, &solicitud, sizeof(SolicitudLote));
+    memcpy(carga + *usados + sizeof(SolicitudLote), nombre, largo);
+    *usados += sizeof(SolicitudLote) + largo;
+    return 0;
+}
+
+int lote_siguiente(const char* carga, int largo, int* posicion, SolicitudLote* solicitud, const char** nombre){
+    if(*posicion >= largo) return 0;
+    if(largo - *posicion < (int)sizeof(SolicitudLote)) return -1;
+
+    // Las entradas no quedan alineadas: copiar la parte fija
+    memcpy(solicitud, carga + *posicion, sizeof(SolicitudLote));
+    int resto = largo - *posicion - (int)sizeof(SolicitudLote);
+    if(solicitud->largo_nombre > resto || solicitud->largo_nombre > MAX_NOMBRE) return -1;
+
+    *nombre = carga + *posicion + sizeof(SolicitudLote);
+    *posicion += sizeof(SolicitudLote) + solicitud->largo_nombre;
+    return 1;
+}
+
+void describir_resultado(Resultado resultado, int hora, int minuto, char* texto, int capacidad){
+    switch(resultado){
+        case RES_CONFIRMADO:
+            snprintf(texto, capacidad, "CONFIRMADO: Espacios asignados para %d:%02d", hora, minuto); break;
+        case RES_REPROGRAMADO:
+            snprintf(texto, capacidad, "REPROGRAMADO: Sin cupo - Nueva asignacion: %d:%02d", hora, minuto); break;
+        case RES_REPROGRAMADO_EXTEMPORANEO:
+            snprintf(texto, capacidad, "REPROGRAMADO: Hora extemporanea - Nueva asignacion: %d:%02d", hora, minuto); break;
+        case RES_DENEGADO_RANGO:
+            snprintf(texto, capacidad, "DENEGADO: Solicitud fuera de rango operativo"); break;
+        case RES_DENEGADO_EXTEMPORANEO:
+            snprintf(texto, capacidad, "DENEGADO: Hora extemporanea sin disponibilidad posterior"); break;
+        case RES_DENEGADO_CAPACIDAD:
+            snprintf(texto, capacidad, "DENEGADO: Capacidad insuficiente en todas las franjas"); break;
+        default:
+            snprintf(texto, capacidad, "DESCONOCIDO: Resultado %d", resultado); break;
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <stdint.h>
+#include <limits.h>
+#include <sys/types.h>
+
+// Protocolo binario agente <-> controlador.
+// Cada mensaje es un marco: cabecera fija + nombre de largo explícito (sin '\0').
+// Ambos extremos corren en la misma máquina, así que se usa el orden de bytes nativo.
+// Un marco nunca supera PIPE_BUF, por lo que cada write() al FIFO es atómico
+// aunque escriban varios agentes a la vez.
+// Un lote (MSG_LOTE) lleva varias solicitudes en un solo marco y recibe una
+// sola respuesta (MSG_RESPUESTA_LOTE) con el resultado de cada una. Sus
+// solicitudes llevan secuencias seguidas desde la de la cabecera: si el lote
+// llega mal armado se deniegan esas 'personas' secuencias.
+// Solicitudes y lotes indican el parque en la cabecera: un lote va entero a
+// un mismo parque.
+
+typedef enum {
+    MSG_REGISTRO = 1,   // Agente -> controlador: nombre = FIFO privado
+    MSG_SOLICITUD,      // Agente -> controlador: nombre = grupo, hora, personas
+    MSG_CIERRE,         // Agente -> controlador: el agente termina
+    MSG_HORA,           // Controlador -> agente: hora actual del sistema
+    MSG_RESPUESTA,      // Controlador -> agente: resultado + hora asignada
+    MSG_FIN,            // Controlador -> agente: fin de la simulación
+    MSG_LOTE,           // Agente -> controlador: datos = SolicitudLote + nombre, repetido
+    MSG_RESPUESTA_LOTE  // Controlador -> agente: datos = un ResultadoLote por solicitud
+} TipoMensaje;
+
+typedef enum {
+    RES_CONFIRMADO = 1,             // Asignado a la hora pedida
+    RES_REPROGRAMADO,               // Sin cupo, asignado más tarde
+    RES_REPROGRAMADO_EXTEMPORANEO,  // Hora ya pasada, asignado más tarde
+    RES_DENEGADO_RANGO,             // Fuera del rango operativo
+    RES_DENEGADO_EXTEMPORANEO,      // Hora ya pasada y sin cupo posterior
+    RES_DENEGADO_CAPACIDAD          // Sin cupo en ninguna franja
+} Resultado;
+
+typedef struct {
+    uint16_t longitud;      // Bytes totales del marco (cabecera + nombre)
+    uint8_t  tipo;          // TipoMensaje
+    uint8_t  resultado;     // Resultado (solo MSG_RESPUESTA)
+    uint16_t largo_nombre;  // Bytes que siguen a la cabecera (nombre o entradas del lote)
+    uint16_t minuto;        // Minuto de la hora asignada (solo MSG_RESPUESTA)
+    uint32_t agente;        // ID numérico del agente
+    int32_t  hora;          // Hora pedida / asignada / del sistema
+    int32_t  personas;      // Personas del grupo (en lotes: cantidad de solicitudes)
+    uint32_t secuencia;     // Nº de solicitud del agente; la respuesta lo repite
+    uint16_t parque;        // Parque al que va la solicitud o el lote (0 si hay uno solo)
+    uint16_t relleno;
+} CabeceraMarco;
+
+// Entrada de un lote: cabecera fija seguida de 'largo_nombre' bytes del grupo
+typedef struct {
+    uint32_t secuencia;     // Nº de solicitud del agente
+    int32_t  hora;          // Hora pedida
+    int32_t  personas;
+    uint16_t largo_nombre;
+    uint16_t relleno;
+} SolicitudLote;
+
+// Resultado de una entrada del lote, en el mismo orden
+typedef struct {
+    uint32_t secuencia;
+    uint8_t  resultado;     // Resultado
+    uint8_t  minuto;        // Minuto de la hora asignada
+    int16_t  hora;          // Hora asignada
+} ResultadoLote;
+
+#define TAM_CABECERA ((int)sizeof(CabeceraMarco))
+#define MAX_NOMBRE 255                          // Largo máximo de un nombre
+#define MAX_MARCO (TAM_CABECERA + MAX_NOMBRE)   // Marco simple, siempre <= PIPE_BUF
+#define MAX_CARGA (PIPE_BUF - TAM_CABECERA)     // Datos de un marco de lote
+#define MAX_LOTE (MAX_CARGA / ((int)sizeof(SolicitudLote) + 1))   // Entradas por lote (nombres de 1 byte)
+#define TAM_DECODIFICADOR 65536                 // Bytes leídos por llamada
+
+// Acumula lo leído de un descriptor y separa los marcos completos.
+// Soporta lecturas parciales y varios marcos en una misma lectura.
+typedef struct {
+    char datos[TAM_DECODIFICADOR];
+    int inicio;             // Primer byte sin consumir
+    int usados;             // Bytes válidos en datos
+    long descartados;       // Bytes saltados por no formar una cabecera válida
+} Decodificador;
+
+// Bytes de datos que admite un marco de tipo 'tipo' (MAX_NOMBRE, o MAX_CARGA en lotes)
+int marco_carga_maxima(int tipo);
+
+// 1 si la cabecera es coherente (tipo conocido y largos que cierran)
+int marco_valido(const CabeceraMarco* cab);
+
+// 1 si es un marco válido de agente a controlador (registro, solicitud,
+// lote o cierre): lo único que se acepta por el FIFO principal, el anillo
+// de peticiones y las trazas
+int marco_entrante(const CabeceraMarco* cab);
+
+// Serializa un marco en destino. Completa longitud y largo_nombre.
+// Devuelve los bytes escritos o -1 si no cabe o el nombre es muy largo
+// (los lotes admiten hasta MAX_CARGA bytes de datos).
+int marco_codificar(char* destino, int capacidad, CabeceraMarco cab, const char* nombre, int largo);
+
+// Codifica y envía un marco con un solo write(). Devuelve 0 si se envió completo.
+int marco_enviar(int fd, CabeceraMarco cab, const char* nombre, int largo);
+
+void decodificador_iniciar(Decodificador* d);
+
+// Lee del descriptor lo que quepa en el buffer.
+// Devuelve bytes leídos, 0 en EOF o -1 con errno (EAGAIN si no hay datos).
+ssize_t decodificador_leer(Decodificador* d, int fd);
+
+// Extrae el siguiente marco. nombre apunta dentro del buffer y es válido
+// hasta la próxima lectura. Devuelve 1 si hay marco y 0 si falta información.
+// Los datos que no empiezan con una cabecera válida se saltan de a un byte
+// hasta encontrar una (se suman en descartados): los marcos que vienen
+// detrás, de otros escritores del mismo FIFO, no se pierden.
+int decodificador_siguiente(Decodificador* d, CabeceraMarco* cab, const char** nombre);
+
+// Agrega una entrada al lote armado en 'carga' (usados = bytes ocupados).
+// 0 si ok, -1 si no entra en un marco.
+int lote_agregar(char* carga, int* usados, SolicitudLote solicitud, const char* nombre);
+
+// Lee la entrada en 'posicion' y avanza. nombre apunta dentro de 'carga'.
+// Devuelve 1 si hay entrada, 0 al final y -1 si la entrada está cortada.
+int lote_siguiente(const char* carga, int largo, int* posicion, SolicitudLote* solicitud, const char** nombre);
+
+// Texto legible para el resultado de una solicitud (hora:minuto asignados)
+void describir_resultado(Resultado resultado, int hora, int minuto, char* texto, int capacidad);
+
+#endif
@@ -0,0 +1,71 @@
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/timerfd.h>
+#include "Reloj.h"
+
+static int64_t monotonico_ns(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+int reloj_iniciar(Reloj* reloj, int inicio_horas, double segundos_por_hora, int virtual){
+    reloj->virtual = virtual;
+    reloj->inicio_ms = inicio_horas * MS_POR_HORA;
+    reloj->ns_por_ms = segundos_por_hora * 1e9 / MS_POR_HORA;
+    atomic_store(&reloj->actual_ms, reloj->inicio_ms);
+    reloj->temporizador = -1;
+    pthread_mutex_init(&reloj->bloqueo, NULL);
+    pthread_cond_init(&reloj->avanzo, NULL);
+
+    if(!virtual){
+        reloj->temporizador = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if(reloj->temporizador == -1) return -1;
+    }
+    reloj->inicio_ns = monotonico_ns();
+    return 0;
+}
+
+void reloj_destruir(Reloj* reloj){
+    if(reloj->temporizador != -1) close(reloj->temporizador);
+    pthread_mutex_destroy(&reloj->bloqueo);
+    pthread_cond_destroy(&reloj->avanzo);
+}
+
+int64_t reloj_ms(Reloj* reloj){
+    if(reloj->virtual) return atomic_load_explicit(&reloj->actual_ms, memory_order_acquire);
+    return reloj->inicio_ms + (int64_t)((monotonico_ns() - reloj->inicio_ns) / reloj->ns_por_ms);
+}
+
+void reloj_esperar_hasta(Reloj* reloj, int64_t objetivo_ms){
+    if(reloj->virtual){
+        pthread_mutex_lock(&reloj->bloqueo);
+        while(atomic_load(&reloj->actual_ms) < objetivo_ms){
+            pthread_cond_wait(&reloj->avanzo, &reloj->bloqueo);
+        }
+        pthread_mutex_unlock(&reloj->bloqueo);
+        return;
+    }
+
+    // Instante real exacto del objetivo (redondeado hacia arriba al ns)
+    double espera = (objetivo_ms - reloj->inicio_ms) * reloj->ns_por_ms;
+    int64_t destino = reloj->inicio_ns + (int64_t)espera + 1;
+    if(destino <= monotonico_ns()) return;
+
+    struct itimerspec alarma = { .it_value = { destino / 1000000000LL, destino % 1000000000LL } };
+    timerfd_settime(reloj->temporizador, TFD_TIMER_ABSTIME, &alarma, NULL);
+
+    uint64_t vencimientos;
+    while(read(reloj->temporizador, &vencimientos, sizeof(vencimientos)) == -1 && errno == EINTR);
+}
+
+void reloj_avanzar(Reloj* reloj, int64_t objetivo_ms){
+    pthread_mutex_lock(&reloj->bloqueo);
+    if(objetivo_ms > atomic_load(&reloj->actual_ms)){
+        atomic_store_explicit(&reloj->actual_ms, objetivo_ms, memory_order_release);
+        pthread_cond_broadcast(&reloj->avanzo);
+    }
+    pthread_mutex_unlock(&reloj->bloqueo);
+}
@@ -0,0 +1,49 @@
+#ifndef RELOJ_H
+#define RELOJ_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+// Reloj de la simulación. La hora simulada se maneja en punto fijo:
+// milisegundos simulados desde las 0:00 (int64), sin flotantes ni cerrojos
+// para leerla.
+//  - Real: escala CLOCK_MONOTONIC (ns) a 'segundos_por_hora'. Admite
+//    fracciones para acelerar (0.01 = un día de 12 h en 0.12 s). Esperar
+//    una franja arma un timerfd para el instante exacto del borde.
+//  - Virtual: el tiempo solo avanza con reloj_avanzar; quien espera se
+//    despierta por variable de condición. Una simulación larga corre tan
+//    rápido como el código que la conduce, y siempre igual.
+
+#define MS_POR_HORA 3600000LL
+
+typedef struct {
+    int virtual;                  // 1: tiempo virtual
+    int64_t inicio_ns;            // CLOCK_MONOTONIC al iniciar (modo real)
+    double ns_por_ms;             // ns reales por ms simulado (modo real)
+    int64_t inicio_ms;            // Hora simulada inicial
+    _Atomic int64_t actual_ms;    // Hora simulada (modo virtual)
+    int temporizador;             // timerfd del hilo que espera (modo real)
+    pthread_mutex_t bloqueo;      // Espera en modo virtual
+    pthread_cond_t avanzo;
+} Reloj;
+
+// Arranca en la hora simulada 'inicio_horas'. 0 si ok, -1 si no se pudo crear el timerfd.
+int reloj_iniciar(Reloj* reloj, int inicio_horas, double segundos_por_hora, int virtual);
+void reloj_destruir(Reloj* reloj);
+
+// Hora simulada actual en ms desde las 0:00 (sin cerrojo, desde cualquier hilo)
+int64_t reloj_ms(Reloj* reloj);
+
+// Hora simulada actual en horas (para comparar con horas pedidas)
+static inline float reloj_horas(Reloj* reloj){
+    return (float)((double)reloj_ms(reloj) / MS_POR_HORA);
+}
+
+// Bloquea hasta que la hora simulada llegue a 'objetivo_ms'. En modo real
+// usa el timerfd del reloj: la llama un solo hilo (el del reloj).
+void reloj_esperar_hasta(Reloj* reloj, int64_t objetivo_ms);
+
+// Modo virtual: lleva la hora a 'objetivo_ms' (nunca retrocede) y despierta a quien espere
+void reloj_avanzar(Reloj* reloj, int64_t objetivo_ms);
+
+#endif
@@ -0,0 +1,105 @@
+#include <stdlib.h>
+#include "Reparto.h"
+
+typedef struct {
+    TramoReparto* tramos;
+    int hilos;
+    FuncionReparto funcion;
+    void* contexto;
+} Reparto;
+
+typedef struct {
+    Reparto* reparto;
+    int hilo;
+} ParametrosReparto;
+
+// Siguiente tarea del tramo propio, o -1 si está vacío
+static int tomar(TramoReparto* tramo){
+    int tarea = -1;
+    pthread_mutex_lock(&tramo->bloqueo);
+    if(tramo->desde < tramo->hasta) tarea = tramo->desde++;
+    pthread_mutex_unlock(&tramo->bloqueo);
+    return tarea;
+}
+
+// Roba la mitad del final (al menos una tarea) del primer tramo con
+// trabajo, empezando por el vecino. 1 si consiguió algo.
+static int robar(Reparto* r, int hilo){
+    for(int k=1; k<r->hilos; k++){
+        TramoReparto* victima = &r->tramos[(hilo + k) % r->hilos];
+        int desde = 0, hasta = 0;
+        pthread_mutex_lock(&victima->bloqueo);
+        int quedan = victima->hasta - victima->desde;
+        if(quedan > 0){
+            hasta = victima->hasta;
+            desde = hasta - (quedan + 1) / 2;
+            victima->hasta = desde;
+        }
+        pthread_mutex_unlock(&victima->bloqueo);
+        if(hasta > desde){
+            TramoReparto* propio = &r->tramos[hilo];
+            pthread_mutex_lock(&propio->bloqueo);
+            propio->desde = desde;
+            propio->hasta = hasta;
+            propio->robos++;
+            pthread_mutex_unlock(&propio->bloqueo);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void* trabajar(void* parametros){
+    ParametrosReparto* p = (ParametrosReparto*)parametros;
+    Reparto* r = p->reparto;
+    TramoReparto* propio = &r->tramos[p->hilo];
+
+    // Las tareas robadas quedan en el tramo propio (y otro puede robarlas de ahí)
+    do {
+        for(int tarea; (tarea = tomar(propio)) != -1; ){
+            r->funcion(tarea, p->hilo, r->contexto);
+        }
+    } while(robar(r, p->hilo));
+    return NULL;
+}
+
+int reparto_ejecutar(int tareas, int hilos, FuncionReparto funcion, void* contexto, long* robos){
+    if(hilos < 1) return -1;
+    Reparto r = { aligned_alloc(64, hilos * sizeof(TramoReparto)), hilos, funcion, contexto };
+    pthread_t* ids = malloc(hilos * sizeof(pthread_t));
+    ParametrosReparto* parametros = malloc(hilos * sizeof(ParametrosReparto));
+    if(r.tramos == NULL || ids == NULL || parametros == NULL){
+        free(r.tramos);
+        free(ids);
+        free(parametros);
+        return -1;
+    }
+
+    // Tramos contiguos del mismo tamaño (±1)
+    for(int i=0; i<hilos; i++){
+        TramoReparto* tramo = &r.tramos[i];
+        pthread_mutex_init(&tramo->bloqueo, NULL);
+        tramo->desde = (int)((long)tareas * i / hilos);
+        tramo->hasta = (int)((long)tareas * (i + 1) / hilos);
+        tramo->robos = 0;
+        parametros[i] = (ParametrosReparto){ &r, i };
+    }
+
+    // El hilo que llama hace de hilo 0
+    // (si no se pudo crear alguno, su tramo se lo roban los demás)
+    int creados = 1;
+    while(creados < hilos && pthread_create(&ids[creados], NULL, trabajar, &parametros[creados]) == 0) creados++;
+    trabajar(&parametros[0]);
+    for(int i=1; i<creados; i++) pthread_join(ids[i], NULL);
+
+    long total = 0;
+    for(int i=0; i<hilos; i++){
+        total += r.tramos[i].robos;
+        pthread_mutex_destroy(&r.tramos[i].bloqueo);
+    }
+    if(robos != NULL) *robos = total;
+    free(r.tramos);
+    free(ids);
+    free(parametros);
+    return 0;
+}
@@ -0,0 +1,27 @@
+#ifndef REPARTO_H
+#define REPARTO_H
+
+#include <pthread.h>
+
+// Reparto de tareas independientes (numeradas 0..N-1) entre varios hilos,
+// con robo de trabajo. Cada hilo arranca con un tramo contiguo de tareas y
+// las toma de a una desde el principio del suyo; cuando se le acaba, le
+// roba la mitad del final del tramo a otro hilo que todavía tenga. Así las
+// tareas caras no dejan hilos ociosos mientras a otro le sobran, y cada
+// hilo trabaja casi siempre sobre tareas vecinas.
+// Cada tramo tiene su propio cerrojo: solo se compite al robar.
+
+typedef void (*FuncionReparto)(int tarea, int hilo, void* contexto);
+
+typedef struct {
+    _Alignas(64) pthread_mutex_t bloqueo;   // Cada tramo en su línea
+    int desde, hasta;             // Tareas pendientes [desde, hasta)
+    long robos;                   // Tramos robados por este hilo
+} TramoReparto;
+
+// Ejecuta 'funcion' una vez por tarea con 'hilos' hilos (el que llama es
+// uno de ellos: 'hilo' va de 0 a hilos - 1). Si 'robos' no es NULL, deja
+// ahí cuántos tramos se robaron en total. 0 si ok, -1 sin memoria o si hilos < 1.
+int reparto_ejecutar(int tareas, int hilos, FuncionReparto funcion, void* contexto, long* robos);
+
+#endif
@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "Protocolo.h"
+#include "Parques.h"
+#include "Clientes.h"
+#include "Metricas.h"
+#include "Bitacora.h"
+#include "Traza.h"
+#include "Admision.h"
+
+// Motor de repetición: corre una traza (grabada con controlador -g, o
+// sintética con carga -T) contra el mismo núcleo de admisión que el
+// controlador, sin procesos, tubos ni esperas: el reloj avanza con la hora
+// de cada registro. Con la misma configuración de parques las decisiones,
+// la bitácora y el informe final son los de la corrida en línea, y un día
+// entero se repite en lo que tarda el procesador en decidirlo.
+//  - Traza grabada: trae los bordes del reloj y se informan donde se dieron.
+//  - Traza sintética: los bordes se generan cada 'paso' minutos, antes del
+//    primer registro que los pasa, y al final hasta la hora de fin.
+// Al terminar informa por stderr cuántos registros corrió y en cuánto tiempo.
+//
+// Uso: ./repeticion -r traza [-i inicio] [-f fin] [-t capacidad] [-m minutos] [-d visita]
+//                   [-P parques] [-v nivel] [-l texto|json|binario] [-o salida]
+
+#define CLIENTES_INICIAL 64
+
+static double segundos_ahora(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]){
+    char* ruta_traza = NULL;
+    int inicio = 7, fin = 19, capacidad = 0, minutos = 60;
+    float visita = 2;
+    char* ruta_parques = NULL;
+    int nivel = NIVEL_EVENTOS;
+    char* formato = "texto";
+    char* salida = NULL;
+
+    for(int i=1; i+1<argc; i++){
+        if(*argv[i] == '-'){
+            switch (*(argv[i++]+1)) {
+                case 'r': ruta_traza = argv[i]; break;        // Traza a repetir
+                case 'i': inicio = atoi(argv[i]); break;      // Hora inicio simulación
+                case 'f': fin = atoi(argv[i]); break;         // Hora fin simulación
+                case 't': capacidad = atoi(argv[i]); break;   // Capacidad del parque
+                case 'm': minutos = atoi(argv[i]); break;     // Minutos por franja
+                case 'd': visita = atof(argv[i]); break;      // Horas por visita
+                case 'P': ruta_parques = argv[i]; break;      // Configuración de varios parques
+                case 'v': nivel = atoi(argv[i]); break;       // Nivel de la bitácora (0-3)
+                case 'l': formato = argv[i]; break;           // Bitácora: texto, json o binario
+                case 'o': salida = argv[i]; break;            // Archivo de la bitácora
+            }
+        }
+    }
+    FormatoBitacora formato_bitacora = strcmp(formato, "json") == 0 ? FORMATO_JSON :
+                                       strcmp(formato, "binario") == 0 ? FORMATO_BINARIO : FORMATO_TEXTO;
+    int minutos_visita = (int)(visita * 60 + 0.5f);
+    int un_parque = ruta_parques == NULL;
+    if(ruta_traza == NULL || inicio >= fin ||
+       (un_parque && (capacidad <= 0 || minutos <= 0 || 60 % minutos != 0 ||
+                      minutos_visita <= 0 || minutos_visita % minutos != 0)) ||
+       nivel < NIVEL_NADA || nivel > NIVEL_DETALLE || (formato_bitacora == FORMATO_TEXTO && strcmp(formato, "texto") != 0)){
+        printf("Uso: %s -r traza [-i inicio] [-f fin] [-t capacidad] [-m minutos] [-d visita]\n"
+               "       [-P parques] [-v nivel] [-l texto|json|binario] [-o salida]\n"
+               "(los parques como los del controlador que grabó la traza: -t, o -P)\n", argv[0]);
+        return 1;
+    }
+
+    // Parques: igual que el controlador
+    TablaClientes clientes;
+    Parques parques;
+    ConfigParque unico = { 0, capacidad, 7, 19, minutos, minutos_visita };
+    ConfigParque* configs = &unico;
+    int num_parques = 1;
+    if(!un_parque && (num_parques = parques_leer(ruta_parques, &configs)) == -1){
+        printf("Error: Configuración de parques inválida.\n");
+        return 1;
+    }
+    int creados = parques_crear(&parques, configs, num_parques, inicio, fin);
+    if(configs != &unico) free(configs);
+    if(creados == -1 || clientes_crear(&clientes, CLIENTES_INICIAL) == -1){
+        printf("Error: Sin memoria para los parques.\n");
+        return 1;
+    }
+
+    Traza traza;
+    if(traza_abrir(&traza, ruta_traza) == -1){
+        fprintf(stderr, "Error: %s no es una traza o no se puede leer.\n", ruta_traza);
+        return 1;
+    }
+
+    // Bitácora como la del controlador; un solo hilo anota, y espera lugar
+    // en vez de descartar
+    Metricas metricas;
+    Bitacora bitacora;
+    int fd_bitacora = STDOUT_FILENO;
+    if(salida != NULL && (fd_bitacora = open(salida, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) == -1){
+        perror("Error al abrir el archivo de la bitácora");
+        return 1;
+    }
+    if(metricas_crear(&metricas, 0) == -1 ||           // Solo para calibrar el reloj
+       bitacora_crear(&bitacora, fd_bitacora, formato_bitacora, nivel, metricas.ticks_por_ns, 1) == -1 ||
+       bitacora_registrar(&bitacora, 1) == -1){
+        printf("Error: No se pudo crear la bitácora.\n");
+        return 1;
+    }
+
+    Admision admision;
+    admision_iniciar(&admision, &parques, &clientes, NULL);
+    int paso = admision_paso(&parques);
+    int proximo = inicio * 60 / paso * paso;      // Siguiente borde a generar (traza sintética)
+
+    int64_t ms;
+    CabeceraMarco cab, respuesta;
+    static char datos[MAX_CARGA];
+    ResultadoLote resultados[MAX_LOTE];
+    Cliente cliente;
+    long registros = 0, solicitudes = 0;
+    int estado;
+    double t0 = segundos_ahora();
+
+    while((estado = traza_siguiente(&traza, &ms, &cab, datos)) == 1){
+        while(!traza.tics && proximo <= fin * 60 && proximo * 60000LL <= ms){
+            admision_tic(&admision, proximo);
+            proximo += paso;
+        }
+        registros++;
+        switch(cab.tipo){
+            case 0:                                     // Borde del reloj grabado
+                admision_tic(&admision, (int)(ms / 60000));
+                break;
+            case MSG_REGISTRO:                          // Sin tubos: el descriptor no se usa
+                if(cab.agente != 0) admision_registro(&admision, &cab, datos, ms, 0);
+                break;
+            case MSG_SOLICITUD:
+                admision_solicitud(&admision, &cab, datos, ms, &respuesta);
+                solicitudes++;
+                break;
+            case MSG_LOTE:
+                admision_lote(&admision, &cab, datos, ms, &respuesta, resultados);
+                solicitudes += cab.personas;
+                break;
+            case MSG_CIERRE:
+                admision_cierre(&admision, cab.agente, ms, &cliente);
+                break;
+        }
+    }
+    while(!traza.tics && proximo <= fin * 60){
+        admision_tic(&admision, proximo);
+        proximo += paso;
+    }
+    double segundos = segundos_ahora() - t0;
+    if(estado == -1) fprintf(stderr, "Traza cortada o inválida después de %ld registros\n", registros);
+
+    // Vaciar la bitácora antes del informe, como el controlador
+    bitacora_terminar(&bitacora);
+    if(fd_bitacora != STDOUT_FILENO) close(fd_bitacora);
+    admision_informe(&admision);
+
+    fprintf(stderr, "Repetidos %ld registros (%ld solicitudes) en %.3f s  →  %.0f solicitudes/s\n",
+            registros, solicitudes, segundos, segundos > 0 ? solicitudes / segundos : 0);
+
+    traza_cerrar(&traza);
+    metricas_destruir(&metricas);
+    clientes_destruir(&clientes);
+    parques_destruir(&parques);
+    return estado == -1 ? 1 : 0;
+}
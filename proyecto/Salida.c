@@ -0,0 +1,345 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <sys/resource.h>
+#include "Salida.h"
+
+#define MAX_EVENTOS_SALIDA 64
+#define MAX_DESCRIPTORES (1 << 20)    // Tope de la tabla de colas (por el límite de archivos)
+
+// Agrega bytes al final del anillo; crece hasta LIMITE_SALIDA.
+// 0 si ok, -1 si no entran.
+static int encolar(ColaSalida* c, const char* bytes, int largo){
+    if(c->cantidad + largo > LIMITE_SALIDA) return -1;
+    if(c->cantidad + largo > c->capacidad){
+        int capacidad = c->capacidad > 0 ? c->capacidad : 4096;
+        while(capacidad < c->cantidad + largo) capacidad *= 2;
+        char* mayor = malloc(capacidad);
+        if(mayor == NULL) return -1;
+        if(c->cantidad > 0){                    // Copiar en orden, desde el inicio
+            int primero = c->capacidad - c->inicio;
+            if(primero > c->cantidad) primero = c->cantidad;
+            memcpy(mayor, c->datos + c->inicio, primero);
+            memcpy(mayor + primero, c->datos, c->cantidad - primero);
+        }
+        free(c->datos);
+        c->datos = mayor;
+        c->capacidad = capacidad;
+        c->inicio = 0;
+    }
+    int fin = (c->inicio + c->cantidad) % c->capacidad;
+    int primero = c->capacidad - fin;
+    if(primero > largo) primero = largo;
+    memcpy(c->datos + fin, bytes, primero);
+    memcpy(c->datos, bytes + primero, largo - primero);
+    c->cantidad += largo;
+    return 0;
+}
+
+// Escribe sin bloquear en el FIFO o en el anillo de la cola, como writev()
+static ssize_t escribir_destino(Salida* s, ColaSalida* c, struct iovec partes[], int n){
+    if(s->compartida == NULL) return writev(c->descriptor, partes, n);
+    ssize_t total = 0;
+    for(int i=0; i<n; i++){
+        ssize_t escritos = compartida_escribir(s->compartida, c->descriptor, c->agente, partes[i].iov_base,
+                                               partes[i].iov_len);
+        if(escritos == -1) return total > 0 ? total : -1;
+        total += escritos;
+        if(escritos < (ssize_t)partes[i].iov_len) break;
+    }
+    return total;
+}
+
+// Escribe lo que acepte el FIFO o el anillo (con la cola tomada). 1 si quedó
+// vacía, 0 si se llenó y -1 si el agente ya no lee (EPIPE u otro error).
+static int vaciar(Salida* s, ColaSalida* c){
+    while(c->cantidad > 0){
+        struct iovec partes[2];
+        int primero = c->capacidad - c->inicio, n = 1;
+        partes[0] = (struct iovec){ c->datos + c->inicio, primero < c->cantidad ? primero : c->cantidad };
+        if(primero < c->cantidad){
+            partes[1] = (struct iovec){ c->datos, c->cantidad - primero };
+            n = 2;
+        }
+        ssize_t escritos = escribir_destino(s, c, partes, n);
+        if(escritos == -1){
+            if(errno == EINTR) continue;
+            return errno == EAGAIN ? 0 : -1;
+        }
+        atomic_fetch_add_explicit(&s->tandas, 1, memory_order_relaxed);
+        c->inicio = (c->inicio + escritos) % c->capacidad;
+        c->cantidad -= escritos;
+    }
+    c->inicio = 0;
+    return 1;
+}
+
+// Pasa la cola al escritor: avisará cuando el FIFO acepte más (o reintentará
+// el anillo, que además anuncia al agente que le queda algo por recibir)
+static void vigilar(Salida* s, ColaSalida* c){
+    if(c->vigilada) return;
+    if(s->compartida != NULL){
+        c->vigilada = 1;
+        compartida_pendiente(s->compartida, c->descriptor, 1);
+        if(atomic_fetch_add(&s->anillos_en_espera, 1) == 0){
+            uint64_t uno = 1;
+            write(s->aviso, &uno, sizeof(uno));     // Que el escritor empiece a reintentar
+        }
+        return;
+    }
+    struct epoll_event evento = { .events = EPOLLOUT, .data.ptr = c };
+    if(epoll_ctl(s->epoll, EPOLL_CTL_ADD, c->descriptor, &evento) == 0) c->vigilada = 1;
+}
+
+// La cola quedó vacía (o cortada): el escritor deja de atenderla
+static void dejar_de_vigilar(Salida* s, ColaSalida* c){
+    c->vigilada = 0;
+    if(s->compartida != NULL){
+        compartida_pendiente(s->compartida, c->descriptor, 0);
+        atomic_fetch_sub(&s->anillos_en_espera, 1);
+    } else {
+        epoll_ctl(s->epoll, EPOLL_CTL_DEL, c->descriptor, NULL);
+    }
+}
+
+static void liberar(Salida* s, ColaSalida* c){
+    s->colas[c->descriptor] = NULL;             // Antes de cerrar: el número se puede reusar
+    if(s->compartida == NULL){
+        close(c->descriptor);
+        atomic_fetch_sub(&s->abiertas, 1);
+    } else if(c->vigilada){
+        compartida_pendiente(s->compartida, c->descriptor, 0);
+    }
+    pthread_mutex_destroy(&c->bloqueo);
+    free(c->datos);
+    free(c);
+}
+
+// El FIFO de 'c' acepta más (o dio error): vaciar, y cerrar si corresponde
+static void atender(Salida* s, ColaSalida* c){
+    pthread_mutex_lock(&c->bloqueo);
+    if(!c->cortado && vaciar(s, c) == -1){
+        c->cantidad = 0;                        // El agente se fue: lo pendiente no tiene destino
+    }
+    if(c->vigilada && (c->cantidad == 0 || c->cortado)){
+        dejar_de_vigilar(s, c);
+        if(c->cerrar){
+            pthread_mutex_unlock(&c->bloqueo);
+            liberar(s, c);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&c->bloqueo);
+}
+
+static long ms_ahora(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000L + t.tv_nsec / 1000000;
+}
+
+static void* escribir(void* parametros){
+    Salida* s = (Salida*)parametros;
+    long limite = 0;
+
+    while(1){
+        int espera = atomic_load(&s->anillos_en_espera) > 0 ? ESPERA_ANILLOS_MS : -1;
+        if(atomic_load(&s->terminar)){
+            if(limite == 0) limite = ms_ahora() + s->espera_ms;
+            if((atomic_load(&s->abiertas) == 0 && atomic_load(&s->anillos_en_espera) == 0) ||
+               ms_ahora() >= limite) break;
+            if(espera == -1 || limite - ms_ahora() < espera) espera = (int)(limite - ms_ahora());
+        }
+
+        struct epoll_event listos[MAX_EVENTOS_SALIDA];
+        int n = epoll_wait(s->epoll, listos, MAX_EVENTOS_SALIDA, espera);
+        for(int i=0; i<n; i++){
+            if(listos[i].data.ptr == NULL){
+                uint64_t avisos;
+                read(s->aviso, &avisos, sizeof(avisos));
+            } else {
+                atender(s, listos[i].data.ptr);
+            }
+        }
+
+        // Anillos llenos: reintentar (son pocos, ANILLOS_RESPUESTA)
+        for(int d=0; s->compartida != NULL && atomic_load(&s->anillos_en_espera) > 0 && d<s->maximo; d++){
+            atender(s, s->colas[d]);
+        }
+
+        // Cierres de colas vacías (no están en el epoll: ningún evento las nombra)
+        pthread_mutex_lock(&s->bloqueo);
+        ColaSalida* lista = s->por_cerrar;
+        s->por_cerrar = NULL;
+        pthread_mutex_unlock(&s->bloqueo);
+        while(lista != NULL){
+            ColaSalida* siguiente = lista->siguiente;
+            liberar(s, lista);
+            lista = siguiente;
+        }
+    }
+
+    // Los que no leyeron a tiempo se cierran con lo que tengan pendiente
+    // (las colas de los anillos se liberan todas)
+    for(int d=0; d<s->maximo && (s->compartida != NULL || atomic_load(&s->abiertas) > 0); d++){
+        if(s->colas[d] != NULL) liberar(s, s->colas[d]);
+    }
+    return NULL;
+}
+
+static ColaSalida* nueva_cola(int descriptor, uint32_t agente){
+    ColaSalida* c = calloc(1, sizeof(ColaSalida));
+    if(c == NULL) return NULL;
+    pthread_mutex_init(&c->bloqueo, NULL);
+    c->descriptor = descriptor;
+    c->agente = agente;
+    return c;
+}
+
+int salida_crear(Salida* s, Compartida* compartida){
+    struct rlimit limite;
+    s->compartida = compartida;
+    s->maximo = MAX_DESCRIPTORES;
+    if(compartida != NULL) s->maximo = ANILLOS_RESPUESTA;
+    else if(getrlimit(RLIMIT_NOFILE, &limite) == 0 && limite.rlim_cur < MAX_DESCRIPTORES) s->maximo = limite.rlim_cur;
+    s->colas = calloc(s->maximo, sizeof(ColaSalida*));
+    s->epoll = epoll_create1(EPOLL_CLOEXEC);
+    s->aviso = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    s->por_cerrar = NULL;
+    s->espera_ms = 0;
+    atomic_init(&s->abiertas, 0);
+    atomic_init(&s->terminar, 0);
+    atomic_init(&s->directas, 0);
+    atomic_init(&s->diferidas, 0);
+    atomic_init(&s->tandas, 0);
+    atomic_init(&s->descartadas, 0);
+    atomic_init(&s->cortados, 0);
+    atomic_init(&s->anillos_en_espera, 0);
+    pthread_mutex_init(&s->bloqueo, NULL);
+
+    // Una cola fija por anillo: el escritor las recorre sin cerrojo de la tabla
+    for(int d=0; compartida != NULL && s->colas != NULL && d<s->maximo; d++){
+        if((s->colas[d] = nueva_cola(d, 0)) == NULL){
+            while(d-- > 0) liberar(s, s->colas[d]);
+            free(s->colas);
+            s->colas = NULL;
+        }
+    }
+
+    struct epoll_event evento = { .events = EPOLLIN, .data.ptr = NULL };
+    if(s->colas == NULL || s->epoll == -1 || s->aviso == -1 ||
+       epoll_ctl(s->epoll, EPOLL_CTL_ADD, s->aviso, &evento) == -1 ||
+       pthread_create(&s->escritor, NULL, escribir, s) != 0){
+        for(int d=0; compartida != NULL && s->colas != NULL && d<s->maximo; d++) liberar(s, s->colas[d]);
+        free(s->colas);
+        if(s->epoll != -1) close(s->epoll);
+        if(s->aviso != -1) close(s->aviso);
+        pthread_mutex_destroy(&s->bloqueo);
+        return -1;
+    }
+    return 0;
+}
+
+int salida_abrir(Salida* s, int descriptor, uint32_t agente){
+    if(descriptor < 0 || descriptor >= s->maximo) return -1;
+    if(s->compartida != NULL){
+        // El anillo cambió de dueño: lo pendiente era del anterior
+        ColaSalida* c = s->colas[descriptor];
+        pthread_mutex_lock(&c->bloqueo);
+        if(c->vigilada) dejar_de_vigilar(s, c);
+        c->agente = agente;
+        c->cantidad = c->inicio = 0;
+        c->cortado = 0;
+        pthread_mutex_unlock(&c->bloqueo);
+        return 0;
+    }
+    ColaSalida* c = nueva_cola(descriptor, agente);
+    if(c == NULL) return -1;
+    fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+    atomic_fetch_add(&s->abiertas, 1);
+    s->colas[descriptor] = c;
+    return 0;
+}
+
+int salida_enviar(Salida* s, int descriptor, CabeceraMarco cab, const char* datos, int largo){
+    char marco[PIPE_BUF];
+    int total = marco_codificar(marco, sizeof(marco), cab, datos, largo);
+    ColaSalida* c = (descriptor >= 0 && descriptor < s->maximo) ? s->colas[descriptor] : NULL;
+    if(total == -1 || c == NULL) return -1;
+
+    pthread_mutex_lock(&c->bloqueo);
+    int estado = 0;
+    if(c->cortado || c->agente != cab.agente){     // Otro dueño: era para uno que ya se fue
+        atomic_fetch_add_explicit(&s->descartadas, 1, memory_order_relaxed);
+        estado = -1;
+    } else {
+        // Cola vacía: directo al FIFO o al anillo
+        ssize_t escritos = 0;
+        if(c->cantidad == 0){
+            struct iovec parte = { marco, total };
+            do {
+                escritos = escribir_destino(s, c, &parte, 1);
+            } while(escritos == -1 && errno == EINTR);
+            if(escritos == -1 && errno != EAGAIN) estado = -1;   // El agente se fue
+            if(escritos == -1) escritos = 0;
+        }
+
+        if(estado == 0 && escritos == total){
+            atomic_fetch_add_explicit(&s->directas, 1, memory_order_relaxed);
+        } else if(estado == 0 && encolar(c, marco + escritos, total - escritos) == 0){
+            atomic_fetch_add_explicit(&s->diferidas, 1, memory_order_relaxed);
+            vigilar(s, c);
+        } else if(estado == 0){
+            // No lee hace LIMITE_SALIDA bytes: se corta y se libera lo pendiente
+            fprintf(stderr, "El agente %u no lee sus respuestas (%d bytes pendientes): se descartan las que siguen\n",
+                    cab.agente, c->cantidad);
+            c->cortado = 1;
+            c->cantidad = c->inicio = 0;
+            atomic_fetch_add_explicit(&s->cortados, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&s->descartadas, 1, memory_order_relaxed);
+            estado = -1;
+        }
+    }
+    pthread_mutex_unlock(&c->bloqueo);
+    return estado;
+}
+
+void salida_cerrar(Salida* s, int descriptor){
+    ColaSalida* c = (descriptor >= 0 && descriptor < s->maximo) ? s->colas[descriptor] : NULL;
+    if(c == NULL){
+        close(descriptor);
+        return;
+    }
+    pthread_mutex_lock(&c->bloqueo);
+    c->cerrar = 1;
+    int vigilada = c->vigilada;                 // Si lo está, la cierra el escritor al vaciarla
+    pthread_mutex_unlock(&c->bloqueo);
+    if(!vigilada){
+        pthread_mutex_lock(&s->bloqueo);
+        c->siguiente = s->por_cerrar;
+        s->por_cerrar = c;
+        pthread_mutex_unlock(&s->bloqueo);
+        uint64_t uno = 1;
+        write(s->aviso, &uno, sizeof(uno));
+    }
+}
+
+void salida_terminar(Salida* s, long espera_ms){
+    s->espera_ms = espera_ms;
+    atomic_store(&s->terminar, 1);
+    uint64_t uno = 1;
+    write(s->aviso, &uno, sizeof(uno));
+    pthread_join(s->escritor, NULL);
+
+    free(s->colas);
+    close(s->epoll);
+    close(s->aviso);
+    pthread_mutex_destroy(&s->bloqueo);
+}
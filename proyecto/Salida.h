@@ -0,0 +1,83 @@
+#ifndef SALIDA_H
+#define SALIDA_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "Protocolo.h"
+#include "Compartida.h"
+
+// Respuestas a los agentes por sus FIFOs privados (o sus anillos en memoria
+// compartida), sin que un agente lento frene a nadie. Los descriptores son
+// no bloqueantes y cada agente tiene su cola de salida (bytes ya codificados):
+//  - Si la cola está vacía, quien responde escribe directo (lo normal).
+//  - Si el FIFO está lleno (EAGAIN) o la escritura quedó a medias, el resto
+//    va a la cola y el descriptor pasa al hilo escritor, que espera
+//    EPOLLOUT y la vacía con writev (lo acumulado sale en una tanda).
+//    Un anillo no tiene descriptor que vigilar: mientras haya anillos con
+//    cola, el escritor los revisa cada ESPERA_ANILLOS_MS.
+//    Mientras la cola tenga datos, lo nuevo se encola detrás: el orden se
+//    mantiene.
+//  - Un agente que acumula más de LIMITE_SALIDA bytes sin leer queda
+//    cortado: lo que siga para él se descarta y se avisa una vez.
+// El cierre del descriptor también lo hace el escritor, después de vaciar
+// la cola: es el único que libera colas, así que un evento ya recibido
+// nunca apunta a una cola liberada. Las colas de los anillos duran todo el
+// día y se reinician cuando otro agente toma el anillo.
+
+#define LIMITE_SALIDA (1 << 20)       // Bytes pendientes por agente antes de cortarlo
+#define ESPERA_ANILLOS_MS 1           // Cada cuánto se reintentan los anillos llenos
+
+typedef struct ColaSalida {
+    pthread_mutex_t bloqueo;
+    int descriptor;               // FIFO privado, o número de anillo
+    uint32_t agente;              // Dueño: lo que vaya a otro agente se descarta
+    char* datos;                  // Anillo de bytes pendientes
+    int capacidad, inicio, cantidad;
+    int vigilada;                 // En el epoll del escritor (tiene datos, o está cortada)
+    int cerrar;                   // Cerrar el descriptor al vaciarse
+    int cortado;                  // Pasó el límite: se descarta lo que siga
+    struct ColaSalida* siguiente; // Lista de cierres pendientes del escritor
+} ColaSalida;
+
+typedef struct {
+    ColaSalida** colas;           // Por descriptor o anillo (NULL: no es de un agente)
+    int maximo;                   // Descriptores (o anillos) posibles
+    Compartida* compartida;       // NULL: respuestas por FIFO
+    _Atomic int anillos_en_espera;    // Anillos con cola, que el escritor reintenta
+    int epoll;
+    int aviso;                    // eventfd: hay cierres pendientes o hay que terminar
+    pthread_mutex_t bloqueo;      // Protege 'por_cerrar'
+    ColaSalida* por_cerrar;       // Colas vacías a cerrar (no están en el epoll)
+    pthread_t escritor;
+    _Atomic int abiertas;         // Colas todavía sin cerrar
+    _Atomic int terminar;
+    long espera_ms;               // Al terminar: cuánto esperar a los agentes lentos
+    _Atomic long directas;        // Respuestas escritas enteras por quien responde
+    _Atomic long diferidas;       // Respuestas que pasaron (todo o parte) por la cola
+    _Atomic long tandas;          // writev del escritor
+    _Atomic long descartadas;     // Respuestas de agentes cortados
+    _Atomic long cortados;        // Agentes cortados
+} Salida;
+
+// Arranca el hilo escritor. Con 'compartida' las respuestas van a los
+// anillos del segmento en lugar de a FIFOs. 0 si ok, -1 si no se pudo.
+int salida_crear(Salida* s, Compartida* compartida);
+
+// Da una cola al descriptor de 'agente' (FIFO privado ya abierto, que pasa
+// a no bloqueante, o el anillo que tomó, que descarta lo de su dueño
+// anterior). 0 si ok, -1 sin memoria o descriptor fuera de rango.
+int salida_abrir(Salida* s, int descriptor, uint32_t agente);
+
+// Envía un marco al agente de 'descriptor' sin bloquear. 0 si salió o
+// quedó en cola, -1 si se descartó (agente cortado, otro dueño o marco inválido).
+int salida_enviar(Salida* s, int descriptor, CabeceraMarco cab, const char* datos, int largo);
+
+// Cierra el descriptor cuando se vacíe su cola (nadie debe enviarle después).
+// Solo FIFOs: el anillo lo libera el agente.
+void salida_cerrar(Salida* s, int descriptor);
+
+// Espera hasta 'espera_ms' a que se vacíen las colas (los FIN del cierre),
+// cierra lo que quede y detiene al escritor
+void salida_terminar(Salida* s, long espera_ms);
+
+#endif
@@ -0,0 +1,74 @@
+#include <string.h>
+#include "Traza.h"
+
+int traza_crear(Traza* t, const char* ruta, int tics){
+    t->archivo = fopen(ruta, "wb");
+    if(t->archivo == NULL) return -1;
+    t->tics = tics;
+    pthread_mutex_init(&t->bloqueo, NULL);
+
+    CabeceraTraza cabecera = { MAGIA_TRAZA, (uint32_t)tics };
+    if(fwrite(&cabecera, sizeof(cabecera), 1, t->archivo) != 1){
+        traza_cerrar(t);
+        return -1;
+    }
+    return 0;
+}
+
+int traza_abrir(Traza* t, const char* ruta){
+    t->archivo = fopen(ruta, "rb");
+    if(t->archivo == NULL) return -1;
+    pthread_mutex_init(&t->bloqueo, NULL);
+
+    CabeceraTraza cabecera;
+    if(fread(&cabecera, sizeof(cabecera), 1, t->archivo) != 1 || cabecera.magia != MAGIA_TRAZA){
+        traza_cerrar(t);
+        return -1;
+    }
+    t->tics = cabecera.tics;
+    return 0;
+}
+
+void traza_cerrar(Traza* t){
+    if(t->archivo == NULL) return;
+    fclose(t->archivo);
+    t->archivo = NULL;
+    pthread_mutex_destroy(&t->bloqueo);
+}
+
+// Escribe el registro y el marco juntos, con el cerrojo tomado
+static void escribir(Traza* t, int64_t ms, const char* marco, int largo){
+    RegistroTraza registro = { ms, (uint32_t)largo, 0 };
+    pthread_mutex_lock(&t->bloqueo);
+    fwrite(&registro, sizeof(registro), 1, t->archivo);
+    if(largo > 0) fwrite(marco, largo, 1, t->archivo);
+    pthread_mutex_unlock(&t->bloqueo);
+}
+
+void traza_anotar(Traza* t, int64_t ms, CabeceraMarco cab, const char* datos, int largo){
+    char marco[PIPE_BUF];
+    int total = marco_codificar(marco, sizeof(marco), cab, datos, largo);
+    if(total > 0) escribir(t, ms, marco, total);
+}
+
+void traza_tic(Traza* t, int64_t ms){
+    escribir(t, ms, NULL, 0);
+}
+
+int traza_siguiente(Traza* t, int64_t* ms, CabeceraMarco* cab, char* datos){
+    RegistroTraza registro;
+    if(fread(&registro, sizeof(registro), 1, t->archivo) != 1) return feof(t->archivo) ? 0 : -1;
+    *ms = registro.ms;
+    if(registro.largo == 0){
+        memset(cab, 0, sizeof(*cab));
+        return 1;
+    }
+
+    // Validar la cabecera antes de confiar en sus largos
+    if(registro.largo < TAM_CABECERA || registro.largo > PIPE_BUF ||
+       fread(cab, TAM_CABECERA, 1, t->archivo) != 1 || !marco_entrante(cab) || cab->longitud != registro.largo){
+        return -1;
+    }
+    if(cab->largo_nombre > 0 && fread(datos, cab->largo_nombre, 1, t->archivo) != 1) return -1;
+    return 1;
+}
@@ -0,0 +1,58 @@
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "Protocolo.h"
+
+// Traza de lo que decidió el controlador: cada marco que llegó a la admisión
+// (registro, solicitud, lote, cierre) con la hora simulada en que se
+// decidió, y los bordes del reloj. Con la traza, ./repeticion vuelve a correr
+// la admisión sin procesos, tubos ni esperas y da las mismas decisiones.
+//  - Grabada: controlador -g archivo (un registro por marco, en el orden en
+//    que se decidieron; la escriben varios hilos, cada uno con el cerrojo).
+//  - Sintética: carga -T archivo (lo mismo que mandaría a un controlador).
+// Formato binario: CabeceraTraza y luego RegistroTraza + marco codificado
+// (largo 0: borde del reloj, sin marco).
+
+#define MAGIA_TRAZA 0x5a525431u      // "1TRZ"
+
+typedef struct {
+    uint32_t magia;
+    uint32_t tics;                // 1: trae los bordes del reloj (grabada en línea)
+} CabeceraTraza;
+
+typedef struct {
+    int64_t ms;                   // Hora simulada, ms desde las 0:00
+    uint32_t largo;               // Bytes del marco que sigue (0: borde del reloj)
+    uint32_t relleno;
+} RegistroTraza;
+
+typedef struct {
+    FILE* archivo;
+    pthread_mutex_t bloqueo;      // Escritura: un registro a la vez
+    int tics;                     // Lectura: valor de la cabecera
+} Traza;
+
+// Crea 'ruta' para escribir. 0 si ok, -1 si no se pudo (con errno).
+int traza_crear(Traza* t, const char* ruta, int tics);
+
+// Abre 'ruta' para leer y valida la cabecera. 0 si ok, -1 si no se pudo o no es una traza.
+int traza_abrir(Traza* t, const char* ruta);
+
+// Escribe lo pendiente y cierra
+void traza_cerrar(Traza* t);
+
+// Anota un marco decidido en 'ms' (desde cualquier hilo)
+void traza_anotar(Traza* t, int64_t ms, CabeceraMarco cab, const char* datos, int largo);
+
+// Anota un borde del reloj
+void traza_tic(Traza* t, int64_t ms);
+
+// Lee el siguiente registro. Un borde del reloj vuelve con cab->tipo = 0.
+// 'datos' recibe hasta MAX_CARGA bytes. 1 si hay registro, 0 al final y
+// -1 si la traza está cortada o el marco es inválido.
+int traza_siguiente(Traza* t, int64_t* ms, CabeceraMarco* cab, char* datos);
+
+#endif